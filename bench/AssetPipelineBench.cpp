@@ -0,0 +1,378 @@
+#include <WireframeEngine.hpp>
+#include <Assets/Asset.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Benchmark options
+struct BenchOptions {
+	size_t assetCount = 10000;
+	size_t minAssetSize = 256;
+	size_t maxAssetSize = 256 * 1024;
+	size_t dependencyDepth = 4;
+	size_t dependencyFanOut = 2;
+	size_t loadRuns = 3;
+	wfe::uint64_t seed = 1;
+	bool compressed = false;
+	bool keepCorpus = false;
+	std::string corpusDir;
+	std::string jsonPath;
+	std::string tracePath;
+	std::string csvPath;
+};
+
+// The maximum number of assets whose save latency is measured on their own
+static const size_t SAVE_LATENCY_SAMPLE_COUNT = 1000;
+
+// Per-asset latency recording
+static std::atomic<size_t> latencyCount{0};
+static std::vector<double> latencies;
+
+static void RecordLatency(double latency) {
+	// Save the latency, in microseconds
+	size_t index = latencyCount.fetch_add(1);
+	if(index < latencies.size())
+		latencies[index] = latency;
+}
+
+// The asset type used by the synthetic corpus, whose data is a payload of pseudo-random bytes
+class BenchAsset : public wfe::Asset {
+public:
+	BenchAsset(wfe::AssetManager* manager, wfe::bool8_t fromFile) : Asset(manager, fromFile) { }
+
+	void SetPayload(size_t size, wfe::uint64_t seed) {
+		// Fill the payload with bytes which compress about as well as typical binary asset data
+		payload.resize(size);
+		for(size_t i = 0; i != size; ++i) {
+			seed ^= seed << 13;
+			seed ^= seed >> 7;
+			seed ^= seed << 17;
+			payload[i] = (wfe::char_t)((seed & 0x3) ? (seed >> 32) & 0xf : seed >> 40);
+		}
+		MarkDirty();
+	}
+	void SetFilePath(const std::string& path) {
+		filePath = path.c_str();
+	}
+	void AddBenchDependency(wfe::uint64_t dependencyID) {
+		AddDependency(dependencyID);
+	}
+
+	size_t GetMemorySize() const override {
+		return payload.size();
+	}
+protected:
+	wfe::bool8_t LoadAsset(wfe::AssetInput& assetInput) override {
+		// Read the payload's size and contents
+		wfe::uint64_t size;
+		assetInput.ReadBuffer(sizeof(wfe::uint64_t), &size);
+		payload.resize((size_t)size);
+		if(size)
+			assetInput.ReadBuffer((size_t)size, payload.data());
+
+		return true;
+	}
+	void ImportAsset(wfe::FileInput& fileInput) override { }
+	void SaveAsset(wfe::AssetOutput& assetOutput) override {
+		// Write the payload's size and contents
+		wfe::uint64_t size = (wfe::uint64_t)payload.size();
+		assetOutput.WriteBuffer(sizeof(wfe::uint64_t), &size);
+		assetOutput.WriteBuffer(payload.size(), payload.data());
+	}
+private:
+	wfe::vector<wfe::char_t> payload;
+};
+
+WFE_ASSET_TYPE(BenchAsset, "wfebench", {})
+
+// Benchmark results
+struct PhaseResult {
+	size_t assetCount = 0;
+	wfe::uint64_t byteCount = 0;
+	double seconds = 0;
+	double lockWaitSeconds = 0;
+	double p50Latency = 0;
+	double p99Latency = 0;
+};
+
+// Helper functions
+static wfe::uint64_t NextRandom(wfe::uint64_t& state) {
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+static void StartLatencyRecording(size_t maxCount) {
+	latencies.assign(maxCount, 0.0);
+	latencyCount = 0;
+}
+static void FinishLatencyRecording(PhaseResult& result) {
+	// Sort the recorded latencies and pick the percentiles
+	size_t count = std::min(latencyCount.load(), latencies.size());
+	if(!count)
+		return;
+
+	std::sort(latencies.begin(), latencies.begin() + count);
+	result.p50Latency = latencies[(count - 1) / 2];
+	result.p99Latency = latencies[(count - 1) * 99 / 100];
+}
+static bool ParseOptions(int argc, char** args, BenchOptions& options) {
+	for(int i = 1; i < argc; ++i) {
+		std::string arg = args[i];
+
+		// Parse the flags without values
+		if(arg == "--quick") {
+			options.assetCount = 500;
+			options.maxAssetSize = 16 * 1024;
+			options.loadRuns = 1;
+			continue;
+		}
+		if(arg == "--compressed") {
+			options.compressed = true;
+			continue;
+		}
+		if(arg == "--keep") {
+			options.keepCorpus = true;
+			continue;
+		}
+
+		// Parse the options with values
+		if(i + 1 == argc) {
+			fprintf(stderr, "Missing value for option %s\n", arg.c_str());
+			return false;
+		}
+		const char* value = args[++i];
+
+		if(arg == "--count")
+			options.assetCount = strtoull(value, nullptr, 10);
+		else if(arg == "--min-size")
+			options.minAssetSize = strtoull(value, nullptr, 10);
+		else if(arg == "--max-size")
+			options.maxAssetSize = strtoull(value, nullptr, 10);
+		else if(arg == "--depth")
+			options.dependencyDepth = strtoull(value, nullptr, 10);
+		else if(arg == "--fan-out")
+			options.dependencyFanOut = strtoull(value, nullptr, 10);
+		else if(arg == "--runs")
+			options.loadRuns = strtoull(value, nullptr, 10);
+		else if(arg == "--seed")
+			options.seed = strtoull(value, nullptr, 10);
+		else if(arg == "--dir")
+			options.corpusDir = value;
+		else if(arg == "--json")
+			options.jsonPath = value;
+		else if(arg == "--trace")
+			options.tracePath = value;
+		else if(arg == "--csv")
+			options.csvPath = value;
+		else {
+			fprintf(stderr, "Unknown option %s\n", arg.c_str());
+			return false;
+		}
+	}
+
+	// Check if the options are valid
+	if(!options.assetCount || !options.minAssetSize || options.minAssetSize > options.maxAssetSize || !options.loadRuns) {
+		fprintf(stderr, "Invalid benchmark options\n");
+		return false;
+	}
+	if(!options.seed)
+		options.seed = 1;
+	if(options.corpusDir.empty())
+		options.corpusDir = (std::filesystem::temp_directory_path() / "wfe-asset-pipeline-bench").string();
+	if(options.corpusDir.back() != '/')
+		options.corpusDir.push_back('/');
+
+	return true;
+}
+
+static PhaseResult GenerateCorpus(const BenchOptions& options) {
+	// Create an empty corpus directory
+	std::filesystem::remove_all(options.corpusDir);
+	std::filesystem::create_directories(options.corpusDir + "main");
+
+	wfe::JobManager* jobManager = wfe::NewObject<wfe::JobManager>();
+	wfe::AssetManager* assetManager = wfe::NewObject<wfe::AssetManager>(options.corpusDir.c_str(), jobManager);
+
+	// Create the assets level by level, so that every asset depends on assets from the previous level
+	PhaseResult result;
+	result.assetCount = options.assetCount;
+
+	size_t levelCount = options.dependencyDepth + 1;
+	std::vector<wfe::uint64_t> ids(options.assetCount);
+	wfe::uint64_t random = options.seed;
+	double minSizeLog = std::log((double)options.minAssetSize);
+	double maxSizeLog = std::log((double)options.maxAssetSize);
+
+	std::vector<BenchAsset*> assets(options.assetCount);
+
+	for(size_t i = 0; i != options.assetCount; ++i) {
+		BenchAsset* asset = assetManager->CreateAsset<BenchAsset>(false);
+		assets[i] = asset;
+		ids[i] = asset->GetID();
+
+		// Pick a log-uniform payload size
+		double sizeFactor = (double)(NextRandom(random) >> 11) / (double)(1ull << 53);
+		size_t size = (size_t)std::exp(minSizeLog + (maxSizeLog - minSizeLog) * sizeFactor);
+		asset->SetPayload(size, NextRandom(random) | 1);
+		asset->SetFilePath(options.corpusDir + "main/asset" + std::to_string(i) + ".wfebench");
+		asset->SetCompressed(options.compressed);
+		result.byteCount += size;
+
+		// Add random dependencies from the previous level
+		size_t level = i * levelCount / options.assetCount;
+		if(!level)
+			continue;
+
+		size_t levelBegin = ((level - 1) * options.assetCount + levelCount - 1) / levelCount;
+		size_t levelEnd = (level * options.assetCount + levelCount - 1) / levelCount;
+		for(size_t j = 0; j != options.dependencyFanOut && levelBegin != levelEnd; ++j)
+			asset->AddBenchDependency(ids[levelBegin + NextRandom(random) % (levelEnd - levelBegin)]);
+	}
+
+	// Save every asset, measuring the save throughput
+	wfe::uint64_t lockWaitStart = assetManager->GetLockWaitTime();
+
+	auto start = std::chrono::steady_clock::now();
+	assetManager->SaveAssets();
+	auto end = std::chrono::steady_clock::now();
+
+	result.seconds = std::chrono::duration<double>(end - start).count();
+	result.lockWaitSeconds = (double)(assetManager->GetLockWaitTime() - lockWaitStart) * 1e-9;
+
+	// Measure the save latency of evenly spaced assets by saving each of them on its own, timing the whole SaveAssets call, which includes serializing, compressing, writing and closing the asset's file
+	size_t sampleCount = std::min(options.assetCount, SAVE_LATENCY_SAMPLE_COUNT);
+	StartLatencyRecording(sampleCount);
+
+	for(size_t i = 0; i != sampleCount; ++i) {
+		assets[i * options.assetCount / sampleCount]->MarkDirty();
+
+		auto saveStart = std::chrono::steady_clock::now();
+		assetManager->SaveAssets();
+		RecordLatency(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - saveStart).count());
+	}
+
+	FinishLatencyRecording(result);
+
+	wfe::DestroyObject(assetManager);
+	wfe::DestroyObject(jobManager);
+
+	return result;
+}
+static PhaseResult LoadCorpus(const BenchOptions& options, wfe::uint64_t byteCount) {
+	PhaseResult result;
+	StartLatencyRecording(options.assetCount * options.loadRuns);
+
+	wfe::JobManager* jobManager = wfe::NewObject<wfe::JobManager>();
+
+	for(size_t run = 0; run != options.loadRuns; ++run) {
+		// Load the corpus with a new asset manager, measuring the load throughput
+		auto start = std::chrono::steady_clock::now();
+
+		wfe::AssetManager* assetManager = wfe::NewObject<wfe::AssetManager>(options.corpusDir.c_str(), jobManager);
+		assetManager->LoadAssets("main/");
+
+		auto end = std::chrono::steady_clock::now();
+
+		result.assetCount += assetManager->GetAssetCount<BenchAsset>();
+		result.byteCount += byteCount;
+		result.seconds += std::chrono::duration<double>(end - start).count();
+		result.lockWaitSeconds += (double)assetManager->GetLockWaitTime() * 1e-9;
+
+		// Record every loaded asset's latency from its load record, from the moment its dependencies were ready to the end of its parse
+		for(const wfe::AssetLoadRecord& record : assetManager->GetTelemetry().GetRecords())
+			if(record.loaded)
+				RecordLatency((double)(record.queueTime + record.openTime + record.readTime + record.parseTime) * 1e-3);
+
+		// Export the last run's load telemetry, if requested
+		if(run == options.loadRuns - 1) {
+			if(!options.tracePath.empty() && !assetManager->GetTelemetry().ExportChromeTrace(options.tracePath))
+				fprintf(stderr, "Failed to write %s\n", options.tracePath.c_str());
+			if(!options.csvPath.empty() && !assetManager->GetTelemetry().ExportCSV(options.csvPath))
+				fprintf(stderr, "Failed to write %s\n", options.csvPath.c_str());
+		}
+
+		wfe::DestroyObject(assetManager);
+	}
+
+	wfe::DestroyObject(jobManager);
+
+	FinishLatencyRecording(result);
+	return result;
+}
+
+static void WritePhaseJSON(FILE* file, const char* name, const PhaseResult& result, bool last) {
+	fprintf(file, "\t\"%s\": {\n", name);
+	fprintf(file, "\t\t\"assets\": %zu,\n", result.assetCount);
+	fprintf(file, "\t\t\"bytes\": %llu,\n", (unsigned long long)result.byteCount);
+	fprintf(file, "\t\t\"seconds\": %.6f,\n", result.seconds);
+	fprintf(file, "\t\t\"assets_per_second\": %.1f,\n", result.assetCount / result.seconds);
+	fprintf(file, "\t\t\"mb_per_second\": %.2f,\n", (double)result.byteCount / (1024.0 * 1024.0) / result.seconds);
+	fprintf(file, "\t\t\"latency_p50_us\": %.2f,\n", result.p50Latency);
+	fprintf(file, "\t\t\"latency_p99_us\": %.2f,\n", result.p99Latency);
+	fprintf(file, "\t\t\"lock_wait_ms\": %.3f\n", result.lockWaitSeconds * 1e3);
+	fprintf(file, "\t}%s\n", last ? "" : ",");
+}
+static void WriteJSON(FILE* file, const BenchOptions& options, const PhaseResult& saveResult, const PhaseResult& loadResult) {
+	fprintf(file, "{\n");
+	fprintf(file, "\t\"config\": {\n");
+	fprintf(file, "\t\t\"asset_count\": %zu,\n", options.assetCount);
+	fprintf(file, "\t\t\"min_asset_size\": %zu,\n", options.minAssetSize);
+	fprintf(file, "\t\t\"max_asset_size\": %zu,\n", options.maxAssetSize);
+	fprintf(file, "\t\t\"dependency_depth\": %zu,\n", options.dependencyDepth);
+	fprintf(file, "\t\t\"dependency_fan_out\": %zu,\n", options.dependencyFanOut);
+	fprintf(file, "\t\t\"load_runs\": %zu,\n", options.loadRuns);
+	fprintf(file, "\t\t\"seed\": %llu,\n", (unsigned long long)options.seed);
+	fprintf(file, "\t\t\"compressed\": %s\n", options.compressed ? "true" : "false");
+	fprintf(file, "\t},\n");
+	WritePhaseJSON(file, "save", saveResult, false);
+	WritePhaseJSON(file, "load", loadResult, true);
+	fprintf(file, "}\n");
+}
+
+int main(int argc, char** args) {
+	// Parse the benchmark's options
+	BenchOptions options;
+	if(!ParseOptions(argc, args, options)) {
+		fprintf(stderr, "Usage: %s [--quick] [--count N] [--min-size BYTES] [--max-size BYTES] [--depth N] [--fan-out N] [--runs N] [--seed N] [--compressed] [--dir PATH] [--keep] [--json PATH] [--trace PATH] [--csv PATH]\n", args[0]);
+		return 1;
+	}
+
+	// Generate and save the corpus, then load it
+	PhaseResult saveResult = GenerateCorpus(options);
+	PhaseResult loadResult = LoadCorpus(options, saveResult.byteCount);
+
+	// Check if every asset was loaded on every run
+	int returnCode = 0;
+	if(loadResult.assetCount != options.assetCount * options.loadRuns) {
+		fprintf(stderr, "Loaded %zu out of %zu assets\n", loadResult.assetCount, options.assetCount * options.loadRuns);
+		returnCode = 1;
+	}
+
+	// Write the results as JSON, to stdout and to the requested file
+	WriteJSON(stdout, options, saveResult, loadResult);
+	if(!options.jsonPath.empty()) {
+		FILE* file = fopen(options.jsonPath.c_str(), "w");
+		if(file) {
+			WriteJSON(file, options, saveResult, loadResult);
+			fclose(file);
+		} else {
+			fprintf(stderr, "Failed to open %s\n", options.jsonPath.c_str());
+			returnCode = 1;
+		}
+	}
+
+	// Remove the corpus, unless it should be kept
+	if(!options.keepCorpus)
+		std::filesystem::remove_all(options.corpusDir);
+
+	return returnCode;
+}
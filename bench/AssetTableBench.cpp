@@ -0,0 +1,137 @@
+#include <WireframeEngine.hpp>
+#include <Assets/AssetTable.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+// Benchmark info
+static const size_t ASSET_COUNT = 20000;
+static const size_t OPERATION_COUNT = 2000000;
+static const size_t QUICK_OPERATION_COUNT = 100000;
+static const size_t WRITE_PERIOD = 20;
+static const size_t THREAD_COUNTS[] { 1, 2, 4, 8, 16 };
+static const size_t QUICK_THREAD_COUNTS[] { 1, 2, 4 };
+
+// The asset lookup path used before the sharded table, kept as the benchmark's baseline
+class MutexAssetMap {
+public:
+	wfe::Asset* Find(wfe::uint64_t id) const {
+		mutex.Lock();
+		auto assetIter = assets.find(id);
+		wfe::Asset* asset = assetIter == assets.end() ? nullptr : assetIter->second;
+		mutex.Unlock();
+
+		return asset;
+	}
+	void Insert(wfe::uint64_t id, wfe::Asset* asset) {
+		mutex.Lock();
+		assets[id] = asset;
+		mutex.Unlock();
+	}
+	void Erase(wfe::uint64_t id, wfe::Asset* asset) {
+		mutex.Lock();
+		auto assetIter = assets.find(id);
+		if(assetIter != assets.end() && assetIter->second == asset)
+			assets.erase(assetIter);
+		mutex.Unlock();
+	}
+private:
+	mutable wfe::AtomicMutex mutex;
+	wfe::unordered_map<wfe::uint64_t, wfe::Asset*> assets;
+};
+
+// Helper functions
+static wfe::Asset* GetFakeAsset(wfe::uint64_t id) {
+	// The assets are never dereferenced, so any unique non-null pointer works
+	return (wfe::Asset*)(size_t)((id + 1) << 4);
+}
+
+template<class Map>
+static double RunBenchmark(Map& map, size_t threadCount, size_t operationCount) {
+	// Fill the map with the starting assets
+	for(wfe::uint64_t id = 0; id != ASSET_COUNT; ++id)
+		map.Insert(id, GetFakeAsset(id));
+	
+	// Run the lookups on every thread, with every thread also inserting and erasing its own IDs periodically
+	auto start = std::chrono::steady_clock::now();
+
+	std::thread* threads = new std::thread[threadCount];
+	for(size_t threadIndex = 0; threadIndex != threadCount; ++threadIndex) {
+		threads[threadIndex] = std::thread([&map, threadIndex, threadCount, operationCount]() {
+			wfe::uint64_t state = threadIndex * 0x9E3779B97F4A7C15 + 1;
+			wfe::uint64_t writeID = ASSET_COUNT + threadIndex;
+			size_t found = 0;
+
+			for(size_t i = 0; i != operationCount / threadCount; ++i) {
+				// Insert or erase the thread's ID periodically
+				if(i % WRITE_PERIOD == 0) {
+					if((i / WRITE_PERIOD) & 1) {
+						map.Erase(writeID, GetFakeAsset(writeID));
+						writeID += threadCount;
+					} else {
+						map.Insert(writeID, GetFakeAsset(writeID));
+					}
+					continue;
+				}
+
+				// Look up a random asset
+				state ^= state << 13;
+				state ^= state >> 7;
+				state ^= state << 17;
+				found += map.Find(state % ASSET_COUNT) != nullptr;
+			}
+
+			if(found == SIZE_MAX)
+				printf("Unreachable\n");
+		});
+	}
+	for(size_t threadIndex = 0; threadIndex != threadCount; ++threadIndex)
+		threads[threadIndex].join();
+	delete[] threads;
+
+	auto end = std::chrono::steady_clock::now();
+
+	// Return the number of operations per second
+	return (double)operationCount / std::chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char** args) {
+	// Parse the benchmark's options; quick runs use fewer operations and threads, so that CTest can run them
+	bool quick = false;
+	for(int i = 1; i < argc; ++i) {
+		if(!strcmp(args[i], "--quick")) {
+			quick = true;
+			continue;
+		}
+
+		fprintf(stderr, "Usage: %s [--quick]\n", args[0]);
+		return 1;
+	}
+
+	size_t operationCount = quick ? QUICK_OPERATION_COUNT : OPERATION_COUNT;
+	const size_t* threadCounts = quick ? QUICK_THREAD_COUNTS : THREAD_COUNTS;
+	size_t threadCountCount = quick ? sizeof(QUICK_THREAD_COUNTS) / sizeof(size_t) : sizeof(THREAD_COUNTS) / sizeof(size_t);
+
+	printf("%-8s %20s %20s %10s\n", "threads", "mutex map (ops/s)", "asset table (ops/s)", "speedup");
+
+	for(size_t i = 0; i != threadCountCount; ++i) {
+		size_t threadCount = threadCounts[i];
+
+		// Run the benchmark for the mutex map baseline
+		MutexAssetMap* mutexMap = new MutexAssetMap();
+		double mutexOps = RunBenchmark(*mutexMap, threadCount, operationCount);
+		delete mutexMap;
+
+		// Run the benchmark for the asset table
+		wfe::AssetTable* assetTable = new wfe::AssetTable();
+		double tableOps = RunBenchmark(*assetTable, threadCount, operationCount);
+		delete assetTable;
+
+		printf("%-8zu %20.0f %20.0f %9.2fx\n", threadCount, mutexOps, tableOps, tableOps / mutexOps);
+	}
+
+	return 0;
+}
@@ -1,66 +1,640 @@
 #include "Asset.hpp"
+#include "AssetPack.hpp"
+#include "AssetSnapshot.hpp"
+#include "Platform/Directory.hpp"
+#include "Platform/FileInfo.hpp"
+#include "Platform/MappedFile.hpp"
+
+#include <new>
+#include <thread>
+#include <typeinfo>
 
 namespace wfe {
 	// Static variables
 	constinit vector<Asset::AssetType> Asset::assetTypes{};
 
+	// Constants
+	static const uint32_t ASSET_FLAG_COMPRESSED = 0x1;
+
+	// Internal helper functions
+	static bool8_t ReadAssetHeader(AssetInput& assetInput, uint64_t& id, vector<uint64_t>& dependencies, uint32_t& flags) {
+		// Read the asset's ID, dependency count and flags
+		uint32_t dependencyCount;
+		assetInput.ReadBuffer(sizeof(uint64_t), &id);
+		assetInput.ReadBuffer(sizeof(uint32_t), &dependencyCount);
+		assetInput.ReadBuffer(sizeof(uint32_t), &flags);
+
+		// Check if the header was read and if its ID and dependency count are valid. IDs which collide with the asset table's reserved keys can only come from corrupt files
+		dependencies.clear();
+		if(assetInput.HasFailed() || id >= AssetTable::ERASED_KEY || dependencyCount > (assetInput.GetSize() - assetInput.GetPos()) / sizeof(uint64_t))
+			return false;
+
+		// Read the asset's dependency IDs
+		dependencies.resize((size_t)dependencyCount);
+		if(dependencyCount)
+			assetInput.ReadBuffer(sizeof(uint64_t) * (size_t)dependencyCount, dependencies.data());
+
+		return true;
+	}
+	static string FormatAssetDir(const string& assetDir) {
+		// Use forward slashes and make sure the path ends with a slash
+		string formattedDir = assetDir;
+		for(size_t pos = formattedDir.find('\\', 0); pos != SIZE_T_MAX; pos = formattedDir.find('\\', pos + 1))
+			formattedDir[pos] = '/';
+		if(formattedDir.empty() || formattedDir.back() != '/')
+			formattedDir.push_back('/');
+
+		return formattedDir;
+	}
+	static const Asset::AssetType* FindAssetType(const string& filePath) {
+		// Map every asset type's file extension to the type on first use, since asset types are only registered during static initialization
+		static const unordered_map<string, const Asset::AssetType*> extensionTypes = [] {
+			unordered_map<string, const Asset::AssetType*> types;
+			for(const auto& assetType : Asset::GetAssetTypes())
+				types.insert({ assetType.fileExtension, &assetType });
+
+			return types;
+		}();
+
+		// Get the asset file's extension, exiting the function if its name has none
+		size_t extensionPos = filePath.rfind('.');
+		size_t nameBegin = filePath.rfind('/');
+		if(extensionPos == SIZE_T_MAX || (nameBegin != SIZE_T_MAX && extensionPos < nameBegin))
+			return nullptr;
+
+		// Find the asset type with the file's extension
+		auto assetType = extensionTypes.find(filePath.substr(extensionPos + 1));
+		if(assetType == extensionTypes.end())
+			return nullptr;
+
+		return assetType->second;
+	}
+	static const Asset::AssetType* FindImportType(const string& filePath) {
+		// Map every import extension to the first asset type which imports it on first use, since asset types are only registered during static initialization
+		static const unordered_map<string, const Asset::AssetType*> extensionTypes = [] {
+			unordered_map<string, const Asset::AssetType*> types;
+			for(const auto& assetType : Asset::GetAssetTypes())
+				for(const auto& importExtension : assetType.importExtensions)
+					types.insert({ importExtension, &assetType });
+
+			return types;
+		}();
+
+		// Get the source file's extension, exiting the function if its name has none
+		size_t extensionPos = filePath.rfind('.');
+		size_t nameBegin = filePath.rfind('/');
+		if(extensionPos == SIZE_T_MAX || (nameBegin != SIZE_T_MAX && extensionPos < nameBegin))
+			return nullptr;
+
+		// Find the asset type which imports the file's extension
+		auto assetType = extensionTypes.find(filePath.substr(extensionPos + 1));
+		if(assetType == extensionTypes.end())
+			return nullptr;
+
+		return assetType->second;
+	}
+	static bool8_t MatchPattern(const char_t* pattern, const char_t* str) {
+		// Match the string one character at a time, backtracking to the last '*' on a mismatch
+		const char_t* starPattern = nullptr;
+		const char_t* starStr = nullptr;
+
+		while(*str) {
+			if(*pattern == '*') {
+				starPattern = ++pattern;
+				starStr = str;
+			} else if(*pattern == '?' || *pattern == *str) {
+				++pattern;
+				++str;
+			} else if(starPattern) {
+				pattern = starPattern;
+				str = ++starStr;
+			} else
+				return false;
+		}
+
+		// Skip any trailing stars
+		while(*pattern == '*')
+			++pattern;
+
+		return !*pattern;
+	}
+	static bool8_t IsPathIgnored(const vector<string>& ignorePatterns, const string& path, size_t nameBegin) {
+		// Match the patterns containing a slash against the path, and the other patterns against the name
+		for(const auto& pattern : ignorePatterns) {
+			if(pattern.find('/', 0) != SIZE_T_MAX) {
+				if(MatchPattern(pattern.c_str(), path.c_str()))
+					return true;
+			} else if(MatchPattern(pattern.c_str(), path.c_str() + nameBegin))
+				return true;
+		}
+
+		return false;
+	}
+	static void StartLoadRecord(AssetLoadRecord& record, uint64_t id, const Asset::AssetType* assetType, const string& filePath) {
+		// Set the record's asset info and start time, and reset its timings
+		record.id = id;
+		record.typeName = assetType ? assetType->name : string();
+		record.filePath = filePath;
+		record.threadID = GetCurrentThreadID();
+		record.startTime = AssetTelemetry::GetTime();
+		record.dependencyWaitTime = 0;
+		record.queueTime = 0;
+		record.openTime = 0;
+		record.readTime = 0;
+		record.parseTime = 0;
+		record.bytesRead = 0;
+		record.retryCount = 0;
+		record.loaded = false;
+	}
+
 	// Job functions
+	void* AssetManager::ScanDirectoryJob(void* args) {
+		// Get the task of the directory to scan
+		ScanTask* task = (ScanTask*)args;
+		AssetManager* manager = task->manager;
+
+		// Read the directory's entries, skipping directories which can't be read
+		vector<DirectoryEntry> entries;
+		if(!ReadDirectory(task->rootDir + task->dirPath, entries))
+			return nullptr;
+
+		// Save every subdirectory and asset or source file which isn't ignored
+		for(const auto& entry : entries) {
+			string path = task->dirPath + entry.name;
+			if(IsPathIgnored(manager->ignorePatterns, path, task->dirPath.size()))
+				continue;
+
+			if(entry.isDirectory) {
+				path.push_back('/');
+				task->subdirs.push_back(path);
+			} else if(task->sourceFiles ? FindImportType(entry.name) != nullptr : FindAssetType(entry.name) != nullptr)
+				task->files.push_back(task->rootDir + path);
+		}
+
+		return nullptr;
+	}
+	void* AssetManager::ReadAssetHeaderJob(void* args) {
+		// Get the node whose header will be read
+		AssetLoadHandle::Node* node = (AssetLoadHandle::Node*)args;
+
+		// Exit the function if the current file is not an asset
+		node->assetType = FindAssetType(node->filePath);
+		if(!node->assetType)
+			return nullptr;
+		
+		// Read the asset's header and save the offset of its data. Files which can't be opened or whose header is invalid are marked as failed, failing their dependents too
+		FileInput fileInput(node->filePath, FileInput::STREAM_TYPE_BINARY);
+		if(!fileInput.IsOpen()) {
+			node->id = 0;
+			node->dependencies.clear();
+			node->headerFailed = true;
+			return nullptr;
+		}
+
+		AssetInput assetInput(&fileInput, 0);
+		node->headerFailed = !ReadAssetHeader(assetInput, node->id, node->dependencies, node->flags);
+		fileInput.Close();
+
+		node->dataSize = assetInput.GetSize();
+		node->dataOffset = assetInput.GetPos();
+
+		return nullptr;
+	}
 	void* AssetManager::LoadAssetJob(void* args) {
-		// Get the job's full args
-		LoadAssetJobArgs* jobArgs = (LoadAssetJobArgs*)args;
-
-		// Check if the asset wasn't constructed
-		if(!jobArgs->asset) {
-			// Get the asset file's extension
-			string fileExtension = jobArgs->filePath.substr(jobArgs->filePath.rfind('.') + 1);
-
-			// Find the asset type with the current file extension
-			const Asset::AssetType* currentType = nullptr;
-			for(const auto& assetType : Asset::GetAssetTypes()) {
-				if(assetType.fileExtension == fileExtension) {
-					currentType = &assetType;
-					break;
+		// Get the node to load and its handle
+		AssetLoadHandle::Node* node = (AssetLoadHandle::Node*)args;
+		AssetLoadHandle* handle = node->handle;
+		AssetManager* manager = handle->manager;
+
+		// Load the asset, if its header was read and none of its dependencies failed to load
+		Asset* asset = nullptr;
+		if(!node->failed && !node->dependencyFailed) {
+			// Start recording the asset's load, if the manager's telemetry is enabled
+			AssetLoadRecord record;
+			AssetLoadRecord* loadRecord = nullptr;
+			if(manager->telemetry.IsEnabled()) {
+				StartLoadRecord(record, node->id, node->assetType, node->data ? handle->sourceName : node->filePath);
+				record.dependencyWaitTime = node->readyTime - handle->startTime;
+				record.queueTime = record.startTime - node->readyTime;
+				loadRecord = &record;
+			}
+
+			// Call the asset's constructor to create the asset and set its info
+			asset = node->assetType->constructor(manager, true);
+			asset->id = node->id;
+			asset->filePath = node->filePath;
+			asset->dependencies = node->dependencies;
+
+			// Acquire the asset's dependencies, so that none of them can be evicted while the asset is loaded
+			bool8_t result = manager->residency.AcquireDependencies(asset);
+
+			if(result) {
+				// Load the asset from its mapped data or from its file, skipping its header
+				JobManager* jobManager = manager->jobManager;
+				if(node->data) {
+					AssetInput assetInput(node->data + node->dataOffset, node->dataSize - node->dataOffset);
+					result = asset->InternalLoad(assetInput, node->flags, node->decompressor, jobManager, loadRecord);
+					if(result)
+						AcquireInPlaceSnapshot(handle, asset);
+				} else if(node->readData) {
+					// Load the asset from the data read by the manager's file reader. Assets loaded in place keep the data, so it is detached from the reader first
+					size_t readSize = node->dataSize - node->dataOffset;
+					if(loadRecord)
+						record.readTime = node->readTime;
+
+					if(asset->UsesInPlaceLoad()) {
+						AssetInput assetInput(manager->fileReader->DetachBuffer(node->readData, readSize), readSize);
+						assetInput.TakeOwnership();
+						node->readData = nullptr;
+						result = asset->InternalLoad(assetInput, node->flags, node->decompressor, jobManager, loadRecord);
+					} else {
+						AssetInput assetInput(node->readData, readSize);
+						result = asset->InternalLoad(assetInput, node->flags, node->decompressor, jobManager, loadRecord);
+					}
+				} else {
+					uint64_t openStartTime = loadRecord ? AssetTelemetry::GetTime() : 0;
+					FileInput fileInput(node->filePath, FileInput::STREAM_TYPE_BINARY);
+					if(loadRecord)
+						record.openTime = AssetTelemetry::GetTime() - openStartTime;
+					result = asset->InternalLoadFile(node->filePath, fileInput, node->dataOffset, node->flags, node->decompressor, jobManager, loadRecord);
+					fileInput.Close();
 				}
+				handle->bytesRead += node->dataSize;
+
+				// Release the asset's dependencies if it failed to load
+				if(!result)
+					manager->residency.ReleaseDependencies(asset);
 			}
 
-			// Exit the function if the current file is not an asset
-			if(!currentType) {
-				jobArgs->finished = true;
-				return nullptr;
+			// Add the asset's load record to the manager's telemetry
+			if(loadRecord) {
+				record.loaded = result;
+				manager->telemetry.AddRecord(record);
 			}
-			
-			// Call the asset's constructor to create the asset
-			jobArgs->asset = currentType->constructor(jobArgs->manager, true);
 
-			// Open the file input stream
-			jobArgs->fileInput.Open(jobArgs->filePath, FileInput::STREAM_TYPE_BINARY);
+			if(result) {
+				// Add the asset to the manager's table and slot map, making sure its ID is never allocated
+				manager->assets.Insert(asset->id, asset);
+				manager->slots.Insert(asset, asset->slotIndex, asset->slotGeneration);
+				manager->typeLists.Insert(asset);
+				manager->idRegistry.MarkIDUsed(asset->id);
 
-			// Read and set the asset's ID
-			uint64_t assetID;
-			jobArgs->fileInput.ReadBuffer(sizeof(uint64_t), &assetID);
-			jobArgs->asset->id = assetID;
+				// Mark the asset as resident, which may evict other assets if its memory usage type is over budget
+				manager->residency.AddResident(asset);
+			} else {
+				// Destroy the asset and mark the node as failed
+				DestroyObject(asset);
+				asset = nullptr;
+				node->failed = true;
+			}
 		} else {
-			// Reset the file input stream's position
-			jobArgs->fileInput.SetPos(sizeof(uint64_t), FileInput::SET_POS_RELATIVE_BEGIN);
+			node->failed = true;
 		}
 
-		// Try to load the asset
-		bool8_t result = jobArgs->asset->LoadAsset(jobArgs->fileInput);
+		// Finish the node's load
+		FinishLoadNode(node, asset);
 
-		// Check if all of the aset's dependendies are loaded
-		if(result) {
-			// Close the file input stream
-			jobArgs->fileInput.Close();
+		return nullptr;
+	}
+	void* AssetManager::LoadAssetBatchJob(void* args) {
+		// Get the batch to load, its handle and its asset type
+		AssetLoadHandle::Batch* batch = (AssetLoadHandle::Batch*)args;
+		AssetLoadHandle* handle = batch->handle;
+		AssetManager* manager = handle->manager;
+		JobManager* jobManager = manager->jobManager;
+		size_t count = batch->nodesEnd - batch->nodesBegin;
+		const Asset::AssetType* assetType = handle->nodes[handle->batchNodes[batch->nodesBegin]].assetType;
+
+		// Allocate the batch's arrays; the asset input streams are constructed in place, since they can't be moved
+		Asset** nodeAssets = NewArray<Asset*>(count);
+		Asset** assets = NewArray<Asset*>(count);
+		size_t* assetNodes = NewArray<size_t>(count);
+		bool8_t* results = NewArray<bool8_t>(count);
+		AssetInput* assetInputs = (AssetInput*)AllocMemory(sizeof(AssetInput) * count);
+		if(!assetInputs)
+			throw BadAllocException("Failed to allocate asset batch memory!");
+
+		AssetLoadRecord* records = manager->telemetry.IsEnabled() ? NewArray<AssetLoadRecord>(count) : nullptr;
+
+		// Create every asset whose dependencies were loaded and get its data in memory
+		size_t assetCount = 0;
+		for(size_t i = 0; i != count; ++i) {
+			AssetLoadHandle::Node* node = handle->nodes + handle->batchNodes[batch->nodesBegin + i];
+			nodeAssets[i] = nullptr;
+
+			if(node->dependencyFailed) {
+				node->failed = true;
+				continue;
+			}
+
+			// Start recording the asset's load, if the manager's telemetry is enabled
+			AssetLoadRecord* record = records ? records + i : nullptr;
+			if(record) {
+				StartLoadRecord(*record, node->id, node->assetType, node->data ? handle->sourceName : node->filePath);
+				record->dependencyWaitTime = node->readyTime - handle->startTime;
+				record->queueTime = record->startTime - node->readyTime;
+				record->readTime = node->readTime;
+			}
+
+			// Create the asset and acquire its dependencies
+			Asset* asset = assetType->constructor(manager, true);
+			asset->id = node->id;
+			asset->filePath = node->filePath;
+			asset->dependencies = node->dependencies;
+
+			if(!manager->residency.AcquireDependencies(asset)) {
+				DestroyObject(asset);
+				node->failed = true;
+				continue;
+			}
+
+			// Get the asset's data from the mapped pack, the manager's file reader or its file. Assets loaded in place keep their data, so they must own it
+			size_t dataSize = node->dataSize - node->dataOffset;
+			const void* data;
+			bool8_t ownsData = false;
+
+			if(node->data) {
+				data = node->data + node->dataOffset;
+			} else if(node->readData && asset->UsesInPlaceLoad()) {
+				data = manager->fileReader->DetachBuffer(node->readData, dataSize);
+				node->readData = nullptr;
+				ownsData = true;
+			} else if(node->readData) {
+				data = node->readData;
+			} else {
+				uint64_t openStartTime = record ? AssetTelemetry::GetTime() : 0;
+				FileInput fileInput(node->filePath, FileInput::STREAM_TYPE_BINARY);
+				if(record)
+					record->openTime = AssetTelemetry::GetTime() - openStartTime;
+
+				void* fileData = AllocMemory(dataSize ? dataSize : 1);
+				if(!fileData)
+					throw BadAllocException("Failed to allocate asset batch memory!");
+
+				AssetInput fileAssetInput(&fileInput, node->dataOffset);
+				fileAssetInput.SetReadTimeCounter(record ? &record->readTime : nullptr);
+				fileAssetInput.ReadBuffer(dataSize, fileData);
+				fileInput.Close();
+
+				// Fail the asset if its file was truncated since its header was read
+				if(fileAssetInput.HasFailed()) {
+					FreeMemory(fileData);
+					manager->residency.ReleaseDependencies(asset);
+					DestroyObject(asset);
+					node->failed = true;
+					continue;
+				}
+
+				data = fileData;
+				ownsData = true;
+			}
+			handle->bytesRead += node->dataSize;
+
+			// Create the asset's input stream and decompress its data, if it is compressed
+			AssetInput* assetInput = new(assetInputs + assetCount) AssetInput(data, dataSize);
+			if(ownsData)
+				assetInput->TakeOwnership();
+
+			uint64_t decompressStartTime = record ? AssetTelemetry::GetTime() : 0;
+			if(record)
+				record->bytesRead += dataSize;
+
+			asset->compressed = node->flags & ASSET_FLAG_COMPRESSED;
+			if(asset->compressed && !assetInput->Decompress(node->decompressor, jobManager)) {
+				assetInput->~AssetInput();
+				manager->residency.ReleaseDependencies(asset);
+				DestroyObject(asset);
+				node->failed = true;
+				continue;
+			}
+			if(record)
+				record->readTime += AssetTelemetry::GetTime() - decompressStartTime;
+
+			assets[assetCount] = asset;
+			assetNodes[assetCount] = i;
+			results[assetCount] = false;
+			++assetCount;
+		}
+
+		// Load every asset in a single call, splitting the load's time evenly between the assets
+		if(assetCount) {
+			uint64_t parseStartTime = records ? AssetTelemetry::GetTime() : 0;
+			assets[0]->LoadAssetBatch(assets, assetInputs, results, assetCount);
+
+			// Fail every asset whose data was truncated or corrupt
+			for(size_t i = 0; i != assetCount; ++i)
+				if(assetInputs[i].HasFailed())
+					results[i] = false;
+
+			if(records) {
+				uint64_t parseTime = (AssetTelemetry::GetTime() - parseStartTime) / assetCount;
+				for(size_t i = 0; i != assetCount; ++i)
+					records[assetNodes[i]].parseTime = parseTime;
+			}
+		}
 
-			// Add the asset to the manager's map
-			jobArgs->manager->managerMutex.Lock();
-			jobArgs->manager->assets[jobArgs->asset->id] = jobArgs->asset;
-			jobArgs->manager->managerMutex.Unlock();
+		// Keep the data of the assets loaded in place and free every input stream, destroying the assets which failed to load
+		size_t loadedCount = 0;
+		uint64_t maxID = 0;
+		for(size_t i = 0; i != assetCount; ++i) {
+			Asset* asset = assets[i];
+			if(results[i] && asset->UsesInPlaceLoad()) {
+				asset->InternalFreeInPlaceData();
+				asset->inPlaceData = assetInputs[i].ReleaseOwnedData();
+				AcquireInPlaceSnapshot(handle, asset);
+			}
+			assetInputs[i].~AssetInput();
+
+			AssetLoadHandle::Node* node = handle->nodes + handle->batchNodes[batch->nodesBegin + assetNodes[i]];
+			if(records) {
+				records[assetNodes[i]].loaded = results[i];
+				if(!results[i])
+					++records[assetNodes[i]].retryCount;
+			}
+
+			if(!results[i]) {
+				manager->residency.ReleaseDependencies(asset);
+				DestroyObject(asset);
+				node->failed = true;
+				continue;
+			}
+
+			// Compact the loaded assets to the start of the array
+			nodeAssets[assetNodes[i]] = asset;
+			assets[loadedCount++] = asset;
+			if(asset->id > maxID)
+				maxID = asset->id;
+		}
 
-			// Set the job as finished
-			jobArgs->finished = true;
+		// Add the batch's load records to the manager's telemetry
+		if(records) {
+			for(size_t i = 0; i != count; ++i)
+				if(!handle->nodes[handle->batchNodes[batch->nodesBegin + i]].dependencyFailed)
+					manager->telemetry.AddRecord(records[i]);
 		}
 
+		// Add the loaded assets to the manager's table, slot map and type index, taking every lock only once, and make sure their IDs are never allocated
+		if(loadedCount) {
+			uint64_t* ids = NewArray<uint64_t>(loadedCount);
+			uint32_t* slotIndices = NewArray<uint32_t>(loadedCount);
+			uint32_t* slotGenerations = NewArray<uint32_t>(loadedCount);
+			for(size_t i = 0; i != loadedCount; ++i)
+				ids[i] = assets[i]->id;
+
+			manager->assets.InsertBatch(ids, assets, loadedCount);
+			manager->slots.InsertBatch(assets, slotIndices, slotGenerations, loadedCount);
+			for(size_t i = 0; i != loadedCount; ++i) {
+				assets[i]->slotIndex = slotIndices[i];
+				assets[i]->slotGeneration = slotGenerations[i];
+			}
+			manager->typeLists.InsertBatch(assets, loadedCount);
+			manager->idRegistry.MarkIDUsed(maxID);
+
+			DestroyArray(ids, loadedCount);
+			DestroyArray(slotIndices, loadedCount);
+			DestroyArray(slotGenerations, loadedCount);
+
+			// Mark the assets as resident, which may evict other assets if their memory usage type is over budget
+			for(size_t i = 0; i != loadedCount; ++i)
+				manager->residency.AddResident(assets[i]);
+		}
+
+		// Free the batch's arrays
+		if(records)
+			DestroyArray(records, count);
+		FreeMemory(assetInputs);
+		DestroyArray(results, count);
+		DestroyArray(assetNodes, count);
+		DestroyArray(assets, count);
+
+		// Finish every node's load, which may submit the loads of their dependents
+		for(size_t i = 0; i != count; ++i)
+			FinishLoadNode(handle->nodes + handle->batchNodes[batch->nodesBegin + i], nodeAssets[i]);
+
+		DestroyArray(nodeAssets, count);
+
+		return nullptr;
+	}
+	void AssetManager::SubmitReadyNode(AssetLoadHandle::Node* node) {
+		// Submit the node's load job, or its batch's load job if this was the batch's last pending node
+		AssetLoadHandle* handle = node->handle;
+		JobManager* jobManager = handle->manager->jobManager;
+
+		if(node->batchIndex == SIZE_T_MAX) {
+			jobManager->SubmitJob(LoadAssetJob, node, node->result);
+			return;
+		}
+
+		AssetLoadHandle::Batch& batch = handle->batches[node->batchIndex];
+		if(!--batch.pendingCount)
+			jobManager->SubmitJob(LoadAssetBatchJob, &batch, batch.result);
+	}
+	void AssetManager::FinishLoadNode(AssetLoadHandle::Node* node, Asset* asset) {
+		AssetLoadHandle* handle = node->handle;
+
+		// Give the read data back to the manager's file reader, if it wasn't taken by the asset
+		if(node->readData) {
+			handle->manager->fileReader->ReleaseBuffer(node->readData);
+			node->readData = nullptr;
+		}
+
+		// Call the handle's asset loaded event and update its progress
+		AssetLoadHandle::AssetLoadedEventInfo eventInfo {
+			.handle = handle,
+			.id = node->id,
+			.asset = asset
+		};
+		handle->assetLoadedEvent.CallEvent(&eventInfo);
+
+		if(node->failed)
+			++handle->failedCount;
+		else
+			++handle->loadedCount;
+
+		// Notify every dependent of the asset and submit the ones with no more pending dependencies
+		for(size_t i = node->dependentsBegin; i != node->dependentsEnd; ++i) {
+			AssetLoadHandle::Node* dependent = handle->nodes + handle->dependents[i];
+
+			if(node->failed)
+				dependent->dependencyFailed = 1;
+			if(!--dependent->pendingCount) {
+				dependent->readyTime = AssetTelemetry::GetTime();
+				SubmitReadyNode(dependent);
+			}
+		}
+	}
+	void AssetManager::AssetReadCallback(void* userData, void* buffer, size_t size, bool8_t success) {
+		// Get the node whose data was read and its handle
+		AssetLoadHandle::Node* node = (AssetLoadHandle::Node*)userData;
+		AssetLoadHandle* handle = node->handle;
+
+		// Save the read data; if the read failed, the load job reads the asset's file itself
+		node->readData = success ? buffer : nullptr;
+		node->readTime = AssetTelemetry::GetTime() - node->readSubmitTime;
+
+		// Submit the node's load job if its dependencies are already loaded
+		if(!--node->pendingCount) {
+			node->readyTime = AssetTelemetry::GetTime();
+			SubmitReadyNode(node);
+		}
+
+		// Mark the read as finished, which must be done last, since the handle may be destroyed right after
+		handle->pendingReadCount.fetch_sub(1, std::memory_order_release);
+	}
+	void AssetManager::AcquireInPlaceSnapshot(AssetLoadHandle* handle, Asset* asset) {
+		// Keep the load's snapshot mapped while the asset uses its data directly, which is the case for assets loaded in place which didn't decompress their data
+		if(handle->snapshot && asset->UsesInPlaceLoad() && !asset->inPlaceData && !asset->inPlaceFile) {
+			handle->snapshot->Acquire();
+			asset->inPlaceSnapshot = handle->snapshot;
+		}
+	}
+	void* AssetManager::ImportAssetJob(void* args) {
+		// Get the task to import and its manager
+		ImportTask* task = (ImportTask*)args;
+		AssetManager* manager = task->manager;
+
+		// Read the ID of the asset file written by a previous import, so that the asset keeps its ID
+		uint64_t id;
+		bool8_t imported = false;
+		FileInput fileInput(task->assetPath, FileInput::STREAM_TYPE_BINARY);
+		if(fileInput.IsOpen()) {
+			vector<uint64_t> dependencies;
+			uint32_t flags;
+			AssetInput headerInput(&fileInput, 0);
+			imported = ReadAssetHeader(headerInput, id, dependencies, flags);
+			fileInput.Close();
+		}
+
+		// Get the asset to import into
+		Asset* asset;
+		if(!imported) {
+			// Create a new asset with a new ID
+			asset = task->assetType->constructor(manager, false);
+			asset->filePath = task->assetPath;
+			manager->typeLists.Insert(asset);
+		} else if((asset = manager->GetAsset(id)) != nullptr) {
+			// Re-import the loaded asset in place, removing it from the residency tracker until its new dependencies are known
+			manager->residency.RemoveAsset(asset);
+		} else {
+			// Create the asset with its previous ID and add it to the manager's table and slot map
+			asset = task->assetType->constructor(manager, true);
+			asset->id = id;
+			asset->filePath = task->assetPath;
+
+			manager->assets.Insert(id, asset);
+			manager->slots.Insert(asset, asset->slotIndex, asset->slotGeneration);
+			manager->typeLists.Insert(asset);
+			manager->idRegistry.MarkIDUsed(id);
+		}
+
+		// Import the asset and save it to its file
+		asset->Import(task->sourcePath);
+		asset->Save();
+
+		// Mark the asset as resident, keeping its dependencies resident
+		if(manager->residency.AcquireDependencies(asset))
+			manager->residency.AddResident(asset);
+
 		return nullptr;
 	}
 	void* AssetManager::SaveAssetJob(void* args) {
@@ -73,239 +647,1457 @@ namespace wfe {
 		return nullptr;
 	}
 
+	// Public static functions
+	size_t Asset::FindAssetTypeIndex(const std::type_info& typeInfo) {
+		// Find the asset type with the given class
+		for(size_t i = 0; i != assetTypes.size(); ++i)
+			if(assetTypes[i].typeInfo && *assetTypes[i].typeInfo == typeInfo)
+				return i;
+
+		return SIZE_T_MAX;
+	}
+	bool8_t Asset::ReadHeader(AssetInput& assetInput, uint64_t& id, vector<uint64_t>& dependencies, uint32_t& flags) {
+		return ReadAssetHeader(assetInput, id, dependencies, flags);
+	}
+
 	// Protected constructor
-	Asset::Asset(AssetManager* manager, bool8_t fromFile) : manager(manager) {
+	Asset::Asset(AssetManager* manager, bool8_t fromFile) : manager(manager), slotIndex(0), slotGeneration(0), typeIndex(SIZE_T_MAX), typeListIndex(0), generation(0), savedGeneration(0), compressed(false), residencyRefCount(0), residentSize(0), residentUsageType(MEMORY_USAGE_TYPE_OTHER), residencyPrev(nullptr), residencyNext(nullptr), resident(!fromFile), residencyLinked(false), inPlaceFile(nullptr), inPlaceData(nullptr), inPlaceSnapshot(nullptr), dirtyPrev(nullptr), dirtyNext(nullptr), dirtyLinked(false) {
 		// Set the asset's ID, if it won't be loaded from a file later
 		if(!fromFile) {
-			// Lock the manager's mutex
-			manager->managerMutex.Lock();
+			// Mark the asset as dirty, since it was never saved
+			MarkDirty();
+
+			// Allocate the asset's ID and add it to the manager's table and slot map
+			id = manager->idRegistry.AllocateID();
+			manager->assets.Insert(id, this);
+			manager->slots.Insert(this, slotIndex, slotGeneration);
+		}
+	}
 
-			// Set the current asset's ID and add it to the manager's unordered map
-			id = manager->nextID;
-			manager->assets.insert({ id, this });
+	// Protected functions
+	void Asset::AddDependency(uint64_t dependencyID) {
+		// Add the dependency only if it wasn't already added
+		for(uint64_t currentID : dependencies)
+			if(currentID == dependencyID)
+				return;
+		
+		dependencies.push_back(dependencyID);
+		MarkDirty();
+
+		// Acquire the new dependency if the asset is resident, since resident assets keep their dependencies resident
+		if(resident) {
+			Asset* dependency = manager->GetAsset(dependencyID);
+			if(dependency)
+				manager->residency.Acquire(dependency);
+		}
+	}
+	void Asset::RemoveDependency(uint64_t dependencyID) {
+		// Find and remove the dependency from the vector
+		for(auto iter = dependencies.begin(); iter != dependencies.end(); ++iter) {
+			if(*iter == dependencyID) {
+				dependencies.erase(iter);
+				MarkDirty();
 
-			// Find the manager's next available ID
-			++manager->nextID;
-			for(; manager->assets.count(manager->nextID); ++manager->nextID);
+				// Release the removed dependency if the asset is resident
+				Asset* dependency = manager->GetAsset(dependencyID);
+				if(resident && dependency && dependency->residencyRefCount)
+					manager->residency.Release(dependency);
 
-			// Unlock the manager's mutex
-			manager->managerMutex.Unlock();
+				break;
+			}
+		}
+	}
+
+	void Asset::LoadAssetBatch(Asset* const* assets, AssetInput* assetInputs, bool8_t* results, size_t count) {
+		// Load every asset on its own
+		for(size_t i = 0; i != count; ++i)
+			results[i] = assets[i]->LoadAsset(assetInputs[i]) && !assetInputs[i].HasFailed();
+	}
+
+	// Private functions
+	bool8_t Asset::InternalLoad(AssetInput& assetInput, uint32_t flags, AssetDecompressor& decompressor, JobManager* jobManager, AssetLoadRecord* record) {
+		// Count the asset's data as read, timing its decompression as part of the read
+		uint64_t readStartTime = 0;
+		if(record) {
+			record->bytesRead += assetInput.GetSize() - assetInput.GetPos();
+			readStartTime = AssetTelemetry::GetTime();
+		}
+
+		// Decompress the asset's data, if it is compressed
+		compressed = flags & ASSET_FLAG_COMPRESSED;
+		if(compressed && !assetInput.Decompress(decompressor, jobManager))
+			return false;
+
+		// Load the asset from its data, timing its reads from its file separately from its parse
+		uint64_t parseStartTime = 0;
+		uint64_t parseReadTime = 0;
+		if(record) {
+			parseStartTime = AssetTelemetry::GetTime();
+			record->readTime += parseStartTime - readStartTime;
+			parseReadTime = record->readTime;
+			assetInput.SetReadTimeCounter(&record->readTime);
+		}
+
+		bool8_t result = LoadAsset(assetInput) && !assetInput.HasFailed();
+
+		if(record) {
+			assetInput.SetReadTimeCounter(nullptr);
+			record->parseTime += AssetTelemetry::GetTime() - parseStartTime - (record->readTime - parseReadTime);
+			if(!result)
+				++record->retryCount;
+		}
+
+		if(!result)
+			return false;
+
+		// Replace the memory of assets loaded in place, keeping their decompressed data, since they use it directly
+		if(UsesInPlaceLoad()) {
+			InternalFreeInPlaceData();
+			inPlaceData = assetInput.ReleaseOwnedData();
+		}
+
+		return true;
+	}
+	bool8_t Asset::InternalLoadFile(const string& filePath, FileInput& fileInput, size_t dataOffset, uint32_t flags, AssetDecompressor& decompressor, JobManager* jobManager, AssetLoadRecord* record) {
+		// Load the asset from its file stream, unless it is loaded in place
+		if(!UsesInPlaceLoad()) {
+			AssetInput assetInput(&fileInput, dataOffset);
+			return InternalLoad(assetInput, flags, decompressor, jobManager, record);
+		}
+
+		// Map the asset's file, so that the asset can use the file's memory directly
+		uint64_t openStartTime = record ? AssetTelemetry::GetTime() : 0;
+		MappedFile* mappedFile = NewObject<MappedFile>(filePath);
+		if(record)
+			record->openTime += AssetTelemetry::GetTime() - openStartTime;
+		if(!mappedFile->IsOpen() || mappedFile->GetSize() < dataOffset) {
+			DestroyObject(mappedFile);
+			return false;
+		}
+
+		AssetInput assetInput((const char_t*)mappedFile->GetData() + dataOffset, mappedFile->GetSize() - dataOffset);
+		if(!InternalLoad(assetInput, flags, decompressor, jobManager, record)) {
+			DestroyObject(mappedFile);
+			return false;
+		}
+
+		// Keep the file mapped while the asset uses it, unless the asset uses its decompressed data instead
+		if(inPlaceData)
+			DestroyObject(mappedFile);
+		else
+			inPlaceFile = mappedFile;
+
+		return true;
+	}
+	bool8_t Asset::InternalLoadSaved(const AssetOutput& assetOutput) {
+		// Load the asset from a copy of the data saved by SaveAsset, which assets loaded in place keep as their in-place data
+		if(!UsesInPlaceLoad()) {
+			AssetInput assetInput(assetOutput.GetData(), assetOutput.GetSize());
+			return LoadAsset(assetInput) && !assetInput.HasFailed();
+		}
+
+		void* data = AllocMemory(assetOutput.GetSize() ? assetOutput.GetSize() : 1);
+		if(!data)
+			throw BadAllocException("Failed to allocate in-place asset memory!");
+		memcpy(data, assetOutput.GetData(), assetOutput.GetSize());
+
+		AssetInput assetInput(data, assetOutput.GetSize());
+		if(!LoadAsset(assetInput) || assetInput.HasFailed()) {
+			FreeMemory(data);
+			return false;
+		}
+
+		InternalFreeInPlaceData();
+		inPlaceData = data;
+
+		return true;
+	}
+	void Asset::InternalFreeInPlaceData() {
+		// Unmap the asset's file and free its decompressed data
+		if(inPlaceFile) {
+			DestroyObject(inPlaceFile);
+			inPlaceFile = nullptr;
+		}
+		if(inPlaceData) {
+			FreeMemory(inPlaceData);
+			inPlaceData = nullptr;
+		}
+
+		// Release the snapshot the asset used the data of, allowing it to be unmapped
+		if(inPlaceSnapshot) {
+			inPlaceSnapshot->Release();
+			inPlaceSnapshot = nullptr;
 		}
 	}
 
 	// Public functions
+	void Asset::MarkDirty() {
+		// Increment the asset's generation and add it to its manager's dirty list
+		++generation;
+		manager->LinkDirtyAsset(this);
+	}
 	bool8_t Asset::Load(const string& filePath) {
-		// Open the file stream and load the asset's ID
+		// Open the file stream and load the asset's header
 		FileInput fileInput(filePath, FileInput::STREAM_TYPE_BINARY);
 
-		fileInput.ReadBuffer(sizeof(uint64_t), &id);
+		if(!fileInput.IsOpen())
+			return false;
+
+		uint64_t newID;
+		vector<uint64_t> newDependencies;
+		uint32_t flags;
+		AssetInput headerInput(&fileInput, 0);
+		if(!ReadAssetHeader(headerInput, newID, newDependencies, flags)) {
+			fileInput.Close();
+			return false;
+		}
+
+		id = newID;
+		dependencies.swap(newDependencies);
+
+		// Exit the function if any of the asset's dependencies isn't loaded
+		for(uint64_t dependencyID : dependencies) {
+			if(!manager->GetAsset(dependencyID)) {
+				fileInput.Close();
+				return false;
+			}
+		}
 
 		// Try to load the asset
-		bool8_t result = LoadAsset(fileInput);
+		AssetDecompressor decompressor;
+		bool8_t result = InternalLoadFile(filePath, fileInput, headerInput.GetPos(), flags, decompressor, nullptr, nullptr);
 
 		fileInput.Close();
 
-		// Set the asset's new file path, if successful
-		if(result)
+		// Set the asset's new file path and mark it as clean, if successful
+		if(result) {
 			this->filePath = filePath;
+			savedGeneration = generation;
+		}
 
 		return result;
 	}
-	void Asset::Import(const string& filePath) {		
+	void Asset::Import(const string& filePath) {
+		// Get the import's cache key from the asset's registered type name, if the asset's importer supports caching
+		uint32_t importerVersion = GetImporterVersion();
+		size_t typeIndex = FindAssetTypeIndex(typeid(*this));
+		uint64_t cacheKey = 0;
+		bool8_t cacheable = importerVersion && typeIndex != SIZE_T_MAX && AssetImportCache::GetKey(filePath, assetTypes[typeIndex].name.c_str(), importerVersion, GetImportSettingsHash(), cacheKey);
+
+		if(cacheable) {
+			// Try to read the cached import
+			MappedFile entryFile(manager->importCache.GetEntryPath(cacheKey));
+			vector<uint64_t> cachedDependencies;
+			const void* data;
+			size_t dataSize;
+
+			if(entryFile.IsOpen() && AssetImportCache::ReadEntry(entryFile.GetData(), entryFile.GetSize(), cacheKey, cachedDependencies, data, dataSize)) {
+				// Load the cached import only if all of its dependencies are loaded
+				bool8_t dependenciesLoaded = true;
+				for(uint64_t dependencyID : cachedDependencies) {
+					if(!manager->GetAsset(dependencyID)) {
+						dependenciesLoaded = false;
+						break;
+					}
+				}
+
+				// Resident assets hold references to their dependencies, so the cached dependencies are acquired before the swap; the old ones are released only once the cached import is loaded
+				if(dependenciesLoaded) {
+					cachedDependencies.swap(dependencies);
+					if(resident && !manager->residency.AcquireDependencies(this)) {
+						cachedDependencies.swap(dependencies);
+						dependenciesLoaded = false;
+					}
+				}
+
+				if(dependenciesLoaded) {
+					// Copy the cached data of assets loaded in place, since the cache entry is unmapped before the asset is unloaded
+					void* inPlaceCopy = nullptr;
+					if(UsesInPlaceLoad()) {
+						inPlaceCopy = AllocMemory(dataSize ? dataSize : 1);
+						if(!inPlaceCopy)
+							throw BadAllocException("Failed to allocate in-place asset memory!");
+						memcpy(inPlaceCopy, data, dataSize);
+						data = inPlaceCopy;
+					}
+
+					AssetInput assetInput(data, dataSize);
+					if(LoadAsset(assetInput) && !assetInput.HasFailed()) {
+						if(inPlaceCopy) {
+							InternalFreeInPlaceData();
+							inPlaceData = inPlaceCopy;
+						}
+
+						// Release the asset's old dependencies
+						if(resident) {
+							cachedDependencies.swap(dependencies);
+							manager->residency.ReleaseDependencies(this);
+							cachedDependencies.swap(dependencies);
+						}
+
+						MarkDirty();
+						return;
+					}
+
+					if(inPlaceCopy)
+						FreeMemory(inPlaceCopy);
+
+					// Release the cached dependencies and restore the asset's old ones, since the cached import failed to load
+					if(resident)
+						manager->residency.ReleaseDependencies(this);
+					cachedDependencies.swap(dependencies);
+				}
+			}
+		}
+
 		// Open the file stream and import the asset
 		FileInput fileInput(filePath, FileInput::STREAM_TYPE_BINARY);
 
 		ImportAsset(fileInput);
 
 		fileInput.Close();
+
+		MarkDirty();
+
+		// Save the imported asset to the import cache
+		if(cacheable) {
+			AssetOutput assetOutput;
+			SaveAsset(assetOutput);
+
+			manager->importCache.WriteEntry(cacheKey, dependencies, assetOutput);
+		}
 	}
 	void Asset::Save() {
-		// Open the file stream and save the asset's ID
-		FileOutput fileOutput(filePath, FileOutput::STREAM_TYPE_BINARY);
+		// Save the generation being written, so that changes made during the save keep the asset dirty
+		uint64_t currentGeneration = generation;
+
+		// Save the asset's data to memory
+		AssetOutput assetOutput;
+		SaveAsset(assetOutput);
+
+		// Open a temporary file stream, which replaces the asset's file once complete, and save the asset's header.
+		// The file is never overwritten in place, so that assets loaded in place keep using their old file's mapping without being loaded again
+		string tempPath = filePath + ".tmp";
+		FileOutput fileOutput(tempPath, FileOutput::STREAM_TYPE_BINARY);
 
+		uint32_t dependencyCount = (uint32_t)dependencies.size();
+		uint32_t flags = compressed ? ASSET_FLAG_COMPRESSED : 0;
 		fileOutput.WriteBuffer(sizeof(uint64_t), &id);
+		fileOutput.WriteBuffer(sizeof(uint32_t), &dependencyCount);
+		fileOutput.WriteBuffer(sizeof(uint32_t), &flags);
+		if(dependencyCount)
+			fileOutput.WriteBuffer(sizeof(uint64_t) * dependencies.size(), dependencies.data());
 
-		// Save the asset
-		SaveAsset(fileOutput);
+		// Write the asset's data, compressing it if required
+		if(compressed) {
+			CompressAssetData(assetOutput.GetData(), assetOutput.GetSize(), fileOutput);
+		} else if(assetOutput.GetSize()) {
+			fileOutput.WriteBuffer(assetOutput.GetSize(), assetOutput.GetData());
+		}
 
 		fileOutput.Close();
+
+		// Replace the asset's file with the complete temporary file. Platforms which can't replace a mapped file require the in-place data to be moved to memory first
+		if(!RenameFile(tempPath, filePath)) {
+			if(!inPlaceFile || !InternalLoadSaved(assetOutput) || !RenameFile(tempPath, filePath))
+				throw Exception("Failed to replace asset file %s!", filePath.c_str());
+		}
+
+		// Save the file's modification time if hot reload is enabled, so that the manager doesn't reload the file it just wrote
+		uint64_t fileSize, fileTime;
+		if(manager->fileWatcher && GetFileInfo(filePath, fileSize, fileTime)) {
+			manager->savedFilesMutex.Lock();
+			manager->savedFileTimes[filePath] = fileTime;
+			manager->savedFilesMutex.Unlock();
+		}
+
+		// Mark the saved generation as clean
+		savedGeneration = currentGeneration;
 	}
 
 	Asset::~Asset() {
-		// Remove the asset from the manager's umap
-		manager->managerMutex.Lock();
-		manager->assets.erase(id);
-		manager->managerMutex.Unlock();
+		// Remove the asset from the manager's dirty list, residency tracker, table, slot map and type index, if it was added to them
+		manager->UnlinkDirtyAsset(this);
+		manager->residency.RemoveAsset(this);
+		manager->assets.Erase(id, this);
+		if(slotGeneration)
+			manager->slots.Remove(slotIndex);
+		manager->typeLists.Remove(this);
+
+		// Free the memory the asset was loaded in place from
+		InternalFreeInPlaceData();
 	}
 
-	AssetManager::AssetManager(const string& assetDir, Program* program) : assetDir(assetDir), program(program) {
-		// Format the asset dir's path properly
-		for(size_t pos = this->assetDir.find('\\', 0); pos != SIZE_T_MAX && pos != this->assetDir.size() - 1; pos = this->assetDir.find('\\', pos + 1))
-			this->assetDir[pos] = '/';
-		if(this->assetDir.back() != '/')
-			this->assetDir.push_back('/');
+	AssetLoadHandle::AssetLoadHandle(AssetManager* manager, size_t nodeCount, const string& sourceName) : manager(manager), sourceName(sourceName), nodes(nullptr), nodeCount(nodeCount), order(nullptr), batches(nullptr), batchCount(0), assetCount(0), started(false), snapshot(nullptr), loadedCount(0), failedCount(0), pendingReadCount(0), bytesRead(0) {
+		// Allocate the node and order arrays
+		if(nodeCount) {
+			nodes = NewArray<Node>(nodeCount);
+			order = NewArray<size_t>(nodeCount);
+		}
 
-		// Try to load all registered asset IDs
-		FileInput fileInput(this->assetDir + ".wfeassets", FileInput::STREAM_TYPE_BINARY);
+		// Set every node's handle
+		for(size_t i = 0; i != nodeCount; ++i)
+			nodes[i].handle = this;
+	}
 
-		if(fileInput.IsOpen()) {
-			// Get the number of IDs saved in the file and allocate an array for them
-			size_t fileSize = (size_t)fileInput.GetSize();
-			size_t idCount = fileSize / sizeof(uint64_t);
+	void AssetLoadHandle::Wait() {
+		// Exit the function if the load was never started
+		if(!started)
+			return;
 
-			uint64_t* ids = (uint64_t*)AllocMemory(fileSize);
-			if(!ids)
-				throw BadAllocException("Failed to allocate ID array!");
-			
-			// Load every ID from the file
-			fileInput.ReadBuffer(fileSize, ids);
-			
-			// Close the file input stream
-			fileInput.Close();
+		// Wait for every asynchronous read, since the read callbacks submit the jobs of the nodes whose dependencies were loaded first
+		while(pendingReadCount.load(std::memory_order_acquire))
+			std::this_thread::yield();
 
-			// Insert every ID into the asset map
-			for(size_t i = 0; i != idCount; ++i)
-				assets.insert({ ids[i], nullptr });
-			
-			// Find the new next ID
-			for(; assets.count(nextID); ++nextID);
+		// Wait for every job in topological order, since every node is submitted by its last dependency's job before that job finishes.
+		// Every batch is waited on at its last node, since the order is sorted by depth, so every job its nodes depend on was waited on before
+		for(size_t i = 0; i != assetCount; ++i) {
+			Node& node = nodes[order[i]];
+			if(node.batchIndex == SIZE_T_MAX)
+				node.result.WaitForResult();
+			else if(batches[node.batchIndex].lastNode == order[i])
+				batches[node.batchIndex].result.WaitForResult();
 		}
 	}
 
-	void AssetManager::LoadAssets(const string& dirPath) {
-		// Scan the directory for files
-		vector<string> files = GetDirectoryFiles(this->assetDir + dirPath);
+	AssetLoadHandle::~AssetLoadHandle() {
+		// Wait for every job to finish, since the jobs reference the handle's nodes
+		Wait();
 
-		// Exit the function if there are no files in the given directory
-		if(files.empty())
-			return;
+		// Free the node, order and batch arrays
+		if(nodeCount) {
+			DestroyArray(nodes, nodeCount);
+			DestroyArray(order, nodeCount);
+		}
+		if(batchCount)
+			DestroyArray(batches, batchCount);
 
-		// Allocate a job args and results array
-		LoadAssetJobArgs* jobArgs = NewArray<LoadAssetJobArgs>(files.size());
-		JobManager::Result* results = NewArray<JobManager::Result>(files.size());
+		// Release the load's reference to its snapshot
+		if(snapshot)
+			snapshot->Release();
+	}
 
-		// Set the job args' info
+	AssetManager::AssetManager(const string& assetDir, JobManager* jobManager) : assetDir(FormatAssetDir(assetDir)), jobManager(jobManager), residency(this), importCache(this->assetDir + ".wfecache/"), prefetcher(this), fileReader(nullptr), fileWatcher(nullptr), firstDirty(nullptr), lastDirty(nullptr), idRegistry(this->assetDir + ".wfeassets", &assets) {
+		// Skip hidden files and directories by default, which include the manager's import cache and ID registry
+		ignorePatterns.push_back(".*");
+
+		// Start the asynchronous file reader, falling back to reading asset files on the load jobs if the platform doesn't support it
+		fileReader = NewObject<AsyncFileReader>();
+		if(!fileReader->IsOpen()) {
+			DestroyObject(fileReader);
+			fileReader = nullptr;
+		}
+	}
+
+	void AssetManager::LoadAssets(const string& dirPath, bool8_t recursive) {
+		// Start loading the directory and wait for it to finish
+		FinishLoad(LoadAssetsAsync(dirPath, nullptr, recursive));
+	}
+	AssetLoadHandle* AssetManager::LoadAssetsAsync(const string& dirPath, const Event::Listener* assetLoadedListener, bool8_t recursive) {
+		// Scan the directory tree for asset files
+		vector<string> files;
+		ScanAssetDirectory(dirPath, recursive, files);
+
+		// Create the load's handle
+		AssetLoadHandle* handle = NewObject<AssetLoadHandle>(this, files.size(), dirPath);
+
+		// Submit header read jobs for every file
 		for(size_t i = 0; i != files.size(); ++i) {
-			jobArgs[i].manager = this;
-			jobArgs[i].asset = nullptr;
-			jobArgs[i].filePath = files[i];
-			jobArgs[i].finished = false;
+			AssetLoadHandle::Node& node = handle->nodes[i];
+
+			node.assetType = nullptr;
+			node.filePath = files[i];
+			node.data = nullptr;
+			node.dataSize = 0;
+			node.headerFailed = false;
+
+			jobManager->SubmitJob(ReadAssetHeaderJob, handle->nodes + i, node.result);
 		}
 
-		// Submit asset load jobs until all assets have finished loading
-		size_t unfinishedCount = files.size();
-		for(size_t loopCount = 0; unfinishedCount && loopCount != files.size(); ++loopCount) {
-			// Loop through all files and submit jobs for the unloaded ones
-			for(size_t i = 0; i != files.size(); ++i) {
-				// Set the new finished cached value
-				jobArgs[i].finishedCached = jobArgs[i].finished;
+		// Wait for every header to be read
+		for(size_t i = 0; i != files.size(); ++i)
+			handle->nodes[i].result.WaitForResult();
+
+		// Start loading the assets
+		StartLoad(handle, assetLoadedListener);
+
+		return handle;
+	}
+	void AssetManager::LoadAssetPack(const string& packPath) {
+		// Start loading the asset pack and wait for it to finish
+		FinishLoad(LoadAssetPackAsync(packPath));
+	}
+	AssetLoadHandle* AssetManager::LoadAssetPackAsync(const string& packPath, const Event::Listener* assetLoadedListener) {
+		// Open the asset pack and add it to the pack vector
+		AssetPack* pack = NewObject<AssetPack>(assetDir + packPath);
+		packs.push_back(pack);
+
+		// Create the load's handle
+		size_t entryCount = pack->GetEntryCount();
+		AssetLoadHandle* handle = NewObject<AssetLoadHandle>(this, entryCount, packPath);
+
+		// Read every asset's header directly from the mapped pack
+		for(size_t i = 0; i != entryCount; ++i) {
+			const AssetPack::Entry& entry = pack->GetEntries()[i];
+			AssetLoadHandle::Node& node = handle->nodes[i];
 
-				// Submit the job if the current file isn't loaded
-				if(!jobArgs[i].finishedCached)
-					program->GetJobManager()->SubmitJob(LoadAssetJob, jobArgs + i, results[i]);
+			node.assetType = AssetPack::FindAssetType(entry.typeHash);
+			node.data = (const char_t*)pack->GetEntryData(entry);
+			node.dataSize = (size_t)entry.size;
+			node.headerFailed = false;
+
+			// Skip the current entry if its asset type isn't registered
+			if(!node.assetType)
+				continue;
+
+			AssetInput assetInput(node.data, node.dataSize);
+			node.headerFailed = !ReadAssetHeader(assetInput, node.id, node.dependencies, node.flags);
+			node.dataOffset = assetInput.GetPos();
+
+			// Keep the pack's ID for entries with an invalid header, so that their dependents fail too
+			if(node.headerFailed) {
+				node.id = entry.id;
+				continue;
+			}
+			if(node.id != entry.id) {
+				DestroyObject(handle);
+				throw Exception("Found mismatched asset ID in asset pack %s!", packPath.c_str());
 			}
+		}
+
+		// Start loading the assets
+		StartLoad(handle, assetLoadedListener);
+
+		return handle;
+	}
+	void AssetManager::ImportAssets(const string& sourceDirPath, const string& dirPath) {
+		// Scan the source directory tree for files with a supported import extension and create the output directory
+		string sourceDir = FormatAssetDir(sourceDirPath);
+		vector<string> sourceFiles;
+		ScanDirectory(sourceDir, "", true, true, sourceFiles);
 
-			// Wait for all unfinished jobs to finish
-			for(size_t i = 0; i != files.size(); ++i) {
-				if(jobArgs[i].finishedCached)
+		string outputDir = assetDir + dirPath;
+		if(!outputDir.empty() && outputDir.back() != '/')
+			outputDir.push_back('/');
+		if(!MakeDirectory(outputDir))
+			throw Exception("Failed to create asset directory %s!", outputDir.c_str());
+
+		// Create an import task for every source file, importing it into the output directory's matching subdirectory
+		if(sourceFiles.empty())
+			return;
+		
+		ImportTask* tasks = NewArray<ImportTask>(sourceFiles.size());
+		size_t taskCount = 0;
+		unordered_map<string, size_t> taskIndices;
+		unordered_map<string, bool8_t> outputSubdirs;
+
+		for(const auto& sourceFile : sourceFiles) {
+			// Get the source file's path relative to the source directory and its extension
+			string relativePath = sourceFile.substr(sourceDir.size());
+			size_t extensionPos = relativePath.rfind('.');
+
+			const Asset::AssetType* importType = FindImportType(relativePath);
+
+			// Create every output subdirectory on the source file's path
+			for(size_t pos = relativePath.find('/'); pos != SIZE_T_MAX; pos = relativePath.find('/', pos + 1)) {
+				string outputSubdir = outputDir + relativePath.substr(0, pos + 1);
+				if(!outputSubdirs.insert({ outputSubdir, true }).second)
 					continue;
-				
-				// Wait for the current job
-				results[i].WaitForResult();
 
-				// Check if the current job is now finished and update the unfinished count
-				unfinishedCount -= jobArgs[i].finished;
+				if(!MakeDirectory(outputSubdir)) {
+					DestroyArray(tasks, sourceFiles.size());
+					throw Exception("Failed to create asset directory %s!", outputSubdir.c_str());
+				}
+			}
+
+			// Set the task's info, checking that no other source file imports to the same asset file
+			ImportTask& task = tasks[taskCount];
+			task.manager = this;
+			task.assetType = importType;
+			task.sourcePath = sourceFile;
+			task.assetPath = outputDir + relativePath.substr(0, extensionPos) + "." + importType->fileExtension;
+
+			if(!taskIndices.insert({ task.assetPath, taskCount }).second) {
+				string assetPath = task.assetPath;
+				DestroyArray(tasks, sourceFiles.size());
+				throw Exception("Found multiple source files for asset file %s!", assetPath.c_str());
 			}
+
+			++taskCount;
 		}
 
-		// Check if any circular or unresolved dependencies exist in the directory
-		if(unfinishedCount)
-			throw Exception("Found circular or unresolved dependencies in asset directory %s!", dirPath.c_str());
+		// Submit an import job for every task and wait for all of them to finish
+		for(size_t i = 0; i != taskCount; ++i)
+			jobManager->SubmitJob(ImportAssetJob, tasks + i, tasks[i].result);
+		for(size_t i = 0; i != taskCount; ++i)
+			tasks[i].result.WaitForResult();
 
-		// Free the two allocated arrays
-		DestroyArray(jobArgs, files.size());
-		DestroyArray(results, files.size());
+		// Free the task array
+		DestroyArray(tasks, sourceFiles.size());
 	}
-	void AssetManager::SaveAssets() {
-		// Lock the manager's mutex
-		managerMutex.Lock();
+	void AssetManager::CookAssets(const string& dirPath, const string& packPath) {
+		// Cook every asset file in the given directory tree into the asset pack
+		vector<string> files;
+		ScanAssetDirectory(dirPath, true, files);
+
+		AssetPack::Cook(files, assetDir + packPath);
+	}
+	void AssetManager::SaveAssetSnapshot(const string& dirPath, const string& snapshotPath) {
+		// Scan the directory tree and write the snapshot of its asset files
+		vector<string> files;
+		ScanAssetDirectory(dirPath, true, files);
+
+		AssetSnapshot::Write(files, assetDir, assetDir + snapshotPath);
+
+		// Unmap the previously loaded snapshots which are no longer used
+		DestroyUnusedSnapshots();
+	}
+	bool8_t AssetManager::LoadAssetSnapshot(const string& dirPath, const string& snapshotPath) {
+		// Start loading the snapshot and wait for it to finish, if it's valid
+		AssetLoadHandle* handle = LoadAssetSnapshotAsync(dirPath, snapshotPath);
+		if(!handle)
+			return false;
+
+		FinishLoad(handle);
+		return true;
+	}
+	AssetLoadHandle* AssetManager::LoadAssetSnapshotAsync(const string& dirPath, const string& snapshotPath, const Event::Listener* assetLoadedListener) {
+		// Open the snapshot, exiting the function if it's missing or invalid
+		AssetSnapshot* snapshot = NewObject<AssetSnapshot>(assetDir + snapshotPath);
+		if(!snapshot->IsOpen()) {
+			DestroyObject(snapshot);
+			return nullptr;
+		}
+
+		// Scan the directory tree and map every asset file's relative path to its index
+		vector<string> files;
+		ScanAssetDirectory(dirPath, true, files);
+
+		size_t entryCount = snapshot->GetEntryCount();
+		unordered_map<string, size_t> fileIndices;
+		for(size_t i = 0; i != files.size(); ++i)
+			fileIndices.insert({ files[i].substr(assetDir.size()), i });
+
+		// Validate every entry against its asset file, exiting the function if any asset file was added, removed or modified since the snapshot was written
+		bool8_t valid = fileIndices.size() == entryCount;
+		for(size_t i = 0; valid && i != entryCount; ++i) {
+			const AssetSnapshot::Entry& entry = snapshot->GetEntries()[i];
 
-		// Exit the function if the asset manager doesn't own any assets
-		if(!assets.size()) {
-			managerMutex.Unlock();
+			auto fileIndex = fileIndices.find(snapshot->GetEntryPath(entry));
+			uint64_t fileSize, fileTime;
+			if(fileIndex == fileIndices.end() || !AssetPack::FindAssetType(entry.typeHash) || !GetFileInfo(files[fileIndex->second], fileSize, fileTime) || fileSize != entry.fileSize || fileTime != entry.fileTime)
+				valid = false;
+		}
+
+		if(!valid) {
+			DestroyObject(snapshot);
+			return nullptr;
+		}
+
+		// Unmap the previously loaded snapshots which are no longer used, then add the snapshot to the snapshot vector, since in-place assets reference its data
+		DestroyUnusedSnapshots();
+		snapshots.push_back(snapshot);
+
+		// Create the load's handle, taking every asset's header and data directly from the mapped snapshot. The handle keeps the snapshot mapped until it is destroyed
+		AssetLoadHandle* handle = NewObject<AssetLoadHandle>(this, entryCount, snapshotPath);
+		snapshot->Acquire();
+		handle->snapshot = snapshot;
+
+		for(size_t i = 0; i != entryCount; ++i) {
+			const AssetSnapshot::Entry& entry = snapshot->GetEntries()[i];
+			AssetLoadHandle::Node& node = handle->nodes[i];
+
+			node.assetType = AssetPack::FindAssetType(entry.typeHash);
+			node.filePath = assetDir + snapshot->GetEntryPath(entry);
+			node.data = (const char_t*)snapshot->GetEntryData(entry);
+			node.dataSize = (size_t)entry.dataSize;
+			node.dataOffset = 0;
+			node.id = entry.id;
+			node.flags = entry.flags;
+			node.headerFailed = false;
+
+			const uint64_t* dependencies = snapshot->GetEntryDependencies(entry);
+			node.dependencies.resize((size_t)entry.dependencyCount);
+			for(size_t j = 0; j != (size_t)entry.dependencyCount; ++j)
+				node.dependencies[j] = dependencies[j];
+		}
+
+		// Start loading the assets
+		StartLoad(handle, assetLoadedListener);
+
+		return handle;
+	}
+	void AssetManager::ScanDirectory(const string& rootDir, const string& dirPath, bool8_t recursive, bool8_t sourceFiles, vector<string>& files) {
+		// Start from the given directory, making sure its path uses forward slashes and ends with a slash
+		vector<string> dirs;
+		dirs.push_back(dirPath);
+		for(size_t pos = dirs[0].find('\\', 0); pos != SIZE_T_MAX; pos = dirs[0].find('\\', pos + 1))
+			dirs[0][pos] = '/';
+		if(!dirs[0].empty() && dirs[0].back() != '/')
+			dirs[0].push_back('/');
+
+		// Scan the directory tree one level at a time, submitting a scan job for every directory in the current level
+		while(!dirs.empty()) {
+			size_t taskCount = dirs.size();
+			ScanTask* tasks = NewArray<ScanTask>(taskCount);
+
+			for(size_t i = 0; i != taskCount; ++i) {
+				tasks[i].manager = this;
+				tasks[i].rootDir = rootDir;
+				tasks[i].dirPath = dirs[i];
+				tasks[i].sourceFiles = sourceFiles;
+			}
+
+			// Scan a single directory on the current thread, since a job would only add latency
+			if(taskCount == 1) {
+				ScanDirectoryJob(tasks);
+			} else {
+				for(size_t i = 0; i != taskCount; ++i)
+					jobManager->SubmitJob(ScanDirectoryJob, tasks + i, tasks[i].result);
+				for(size_t i = 0; i != taskCount; ++i)
+					tasks[i].result.WaitForResult();
+			}
+
+			// Collect the level's asset files and the next level's directories
+			dirs.clear();
+			for(size_t i = 0; i != taskCount; ++i) {
+				for(const auto& file : tasks[i].files)
+					files.push_back(file);
+				if(recursive)
+					for(const auto& subdir : tasks[i].subdirs)
+						dirs.push_back(subdir);
+			}
+
+			DestroyArray(tasks, taskCount);
+		}
+	}
+	void AssetManager::ScanAssetDirectory(const string& dirPath, bool8_t recursive, vector<string>& files) {
+		// Scan the directory in the manager's root directory for asset files
+		ScanDirectory(assetDir, dirPath, recursive, false, files);
+	}
+	void AssetManager::StartLoad(AssetLoadHandle* handle, const Event::Listener* assetLoadedListener) {
+		// Exit the function if there is nothing to load
+		if(!handle->nodeCount)
 			return;
+
+		// Reset every node's load state
+		for(size_t i = 0; i != handle->nodeCount; ++i) {
+			handle->nodes[i].failed = handle->nodes[i].headerFailed;
+			handle->nodes[i].dependencyFailed = 0;
+			handle->nodes[i].readData = nullptr;
+			handle->nodes[i].asyncRead = false;
+			handle->nodes[i].readSubmitTime = 0;
+			handle->nodes[i].readTime = 0;
+			handle->nodes[i].batchIndex = SIZE_T_MAX;
 		}
 
-		// Allocate a results array and id array
-		uint64_t* ids = (uint64_t*)AllocMemory(sizeof(uint64_t) * assets.size());
-		if(!ids)
-			throw BadAllocException("Failed to allocate asset IDs array!");
-		JobManager::Result* results = NewArray<JobManager::Result>(assets.size());
+		// Map every asset ID to its node. The IDs of nodes whose header failed to be read may be invalid, so they never count as duplicates and never replace another node's ID
+		unordered_map<uint64_t, size_t> nodeIndices;
+		size_t typedCount = 0;
+		for(size_t i = 0; i != handle->nodeCount; ++i) {
+			if(!handle->nodes[i].assetType)
+				continue;
+			++typedCount;
 
-		// Submit asset save jobs for every asset and add their ids to the array
-		size_t resultsTop = 0, idsTop = 0;
-		for(auto assetPair : assets) {
-			ids[idsTop++] = assetPair.first;
+			auto nodeIter = nodeIndices.insert({ handle->nodes[i].id, i }).first;
+			if(nodeIter->second == i || handle->nodes[i].headerFailed)
+				continue;
+			if(handle->nodes[nodeIter->second].headerFailed) {
+				nodeIter->second = i;
+				continue;
+			}
 
-			if(assetPair.second)
-				program->GetJobManager()->SubmitJob(SaveAssetJob, assetPair.second, results[resultsTop++]);
+			string sourceName = handle->sourceName;
+			DestroyObject(handle);
+			throw Exception("Found duplicate asset ID in asset source %s!", sourceName.c_str());
 		}
 
-		// Unlock the manager's mutex
-		managerMutex.Unlock();
+		// Count every node's pending dependencies and dependents, resolving the dependencies which are already loaded
+		size_t* dependentCounts = NewArray<size_t>(handle->nodeCount);
+		for(size_t i = 0; i != handle->nodeCount; ++i)
+			dependentCounts[i] = 0;
 
-		// Open the asset IDs file and save the asset IDs in it
-		FileOutput fileOutput(assetDir + ".wfeassets", FileOutput::STREAM_TYPE_BINARY);
-		fileOutput.WriteBuffer(sizeof(uint64_t) * idsTop, ids);
-		fileOutput.Close();
+		for(size_t i = 0; i != handle->nodeCount; ++i) {
+			AssetLoadHandle::Node& node = handle->nodes[i];
+			node.pendingCount = 0;
+
+			if(!node.assetType)
+				continue;
+
+			for(uint64_t dependencyID : node.dependencies) {
+				// Check if the dependency is loaded from the current source
+				auto nodeIter = nodeIndices.find(dependencyID);
+				if(nodeIter != nodeIndices.end()) {
+					++node.pendingCount;
+					++dependentCounts[nodeIter->second];
+					continue;
+				}
+
+				// Check if the dependency was already loaded
+				if(GetAsset(dependencyID))
+					continue;
+
+				string sourceName = handle->sourceName;
+				DestroyArray(dependentCounts, handle->nodeCount);
+				DestroyObject(handle);
+				throw Exception("Found unresolved dependency in asset source %s!", sourceName.c_str());
+			}
+		}
+
+		// Set every node's range in the dependents array
+		size_t dependentTotal = 0;
+		for(size_t i = 0; i != handle->nodeCount; ++i) {
+			handle->nodes[i].dependentsBegin = dependentTotal;
+			handle->nodes[i].dependentsEnd = dependentTotal;
+			dependentTotal += dependentCounts[i];
+		}
+
+		// Fill the dependents array
+		handle->dependents.resize(dependentTotal);
+		for(size_t i = 0; i != handle->nodeCount; ++i) {
+			if(!handle->nodes[i].assetType)
+				continue;
+			
+			for(uint64_t dependencyID : handle->nodes[i].dependencies) {
+				auto nodeIter = nodeIndices.find(dependencyID);
+				if(nodeIter != nodeIndices.end())
+					handle->dependents[handle->nodes[nodeIter->second].dependentsEnd++] = i;
+			}
+		}
+
+		// Sort the nodes topologically, which also checks for circular dependencies before any job is submitted
+		size_t orderSize = 0;
+
+		for(size_t i = 0; i != handle->nodeCount; ++i) {
+			dependentCounts[i] = handle->nodes[i].pendingCount;
+			if(handle->nodes[i].assetType && !dependentCounts[i])
+				handle->order[orderSize++] = i;
+		}
+		size_t rootCount = orderSize;
+		for(size_t orderIndex = 0; orderIndex != orderSize; ++orderIndex) {
+			const AssetLoadHandle::Node& node = handle->nodes[handle->order[orderIndex]];
+			for(size_t i = node.dependentsBegin; i != node.dependentsEnd; ++i)
+				if(!--dependentCounts[handle->dependents[i]])
+					handle->order[orderSize++] = handle->dependents[i];
+		}
+
+		if(orderSize != typedCount) {
+			string sourceName = handle->sourceName;
+			DestroyArray(dependentCounts, handle->nodeCount);
+			DestroyObject(handle);
+			throw Exception("Found circular dependencies in asset source %s!", sourceName.c_str());
+		}
+
+		// Get every node's depth, the length of the longest chain of its dependencies in the source, reusing the count array
+		size_t* depths = dependentCounts;
+		size_t maxDepth = 0;
+		for(size_t i = 0; i != handle->nodeCount; ++i)
+			depths[i] = 0;
+		for(size_t orderIndex = 0; orderIndex != orderSize; ++orderIndex) {
+			const AssetLoadHandle::Node& node = handle->nodes[handle->order[orderIndex]];
+			size_t dependentDepth = depths[handle->order[orderIndex]] + 1;
+			for(size_t i = node.dependentsBegin; i != node.dependentsEnd; ++i) {
+				if(depths[handle->dependents[i]] < dependentDepth)
+					depths[handle->dependents[i]] = dependentDepth;
+				if(maxDepth < dependentDepth)
+					maxDepth = dependentDepth;
+			}
+		}
+
+		// Sort the nodes by depth, keeping their relative order. The order stays topological, since every node is deeper than its dependencies, and the roots stay at its start
+		if(maxDepth) {
+			size_t* depthBegins = NewArray<size_t>(maxDepth + 2);
+			for(size_t i = 0; i != maxDepth + 2; ++i)
+				depthBegins[i] = 0;
+			for(size_t i = 0; i != orderSize; ++i)
+				++depthBegins[depths[handle->order[i]] + 1];
+			for(size_t i = 0; i != maxDepth + 1; ++i)
+				depthBegins[i + 1] += depthBegins[i];
+
+			size_t* sortedOrder = NewArray<size_t>(handle->nodeCount);
+			for(size_t i = 0; i != orderSize; ++i)
+				sortedOrder[depthBegins[depths[handle->order[i]]]++] = handle->order[i];
+
+			DestroyArray(handle->order, handle->nodeCount);
+			DestroyArray(depthBegins, maxDepth + 2);
+			handle->order = sortedOrder;
+		}
+
+		// Group the small nodes whose types load in batches by depth and type, so that no batch can depend on another batch which depends on it.
+		// Batches with a single node are loaded by a regular load job instead
+		vector<size_t> batchSizes;
+		unordered_map<const Asset::AssetType*, size_t> depthBatches;
+		size_t currentDepth = 0;
+
+		for(size_t i = 0; i != orderSize; ++i) {
+			AssetLoadHandle::Node& node = handle->nodes[handle->order[i]];
+			if(node.headerFailed || !node.assetType->batchLoad || node.dataSize - node.dataOffset > BATCH_LOAD_MAX_ASSET_SIZE)
+				continue;
+
+			if(depths[handle->order[i]] != currentDepth) {
+				currentDepth = depths[handle->order[i]];
+				depthBatches.clear();
+			}
+
+			auto batchIter = depthBatches.find(node.assetType);
+			if(batchIter == depthBatches.end() || batchSizes[batchIter->second] == BATCH_LOAD_MAX_COUNT) {
+				depthBatches[node.assetType] = batchSizes.size();
+				node.batchIndex = batchSizes.size();
+				batchSizes.push_back(1);
+			} else {
+				node.batchIndex = batchIter->second;
+				++batchSizes[batchIter->second];
+			}
+		}
+
+		DestroyArray(dependentCounts, handle->nodeCount);
+
+		size_t batchCount = 0;
+		size_t batchNodeCount = 0;
+		for(size_t i = 0; i != batchSizes.size(); ++i) {
+			if(batchSizes[i] > 1) {
+				batchNodeCount += batchSizes[i];
+				batchSizes[i] = batchCount++;
+			} else {
+				batchSizes[i] = SIZE_T_MAX;
+			}
+		}
+
+		// Create the batches and fill their node ranges, in the sorted order
+		if(batchCount) {
+			handle->batches = NewArray<AssetLoadHandle::Batch>(batchCount);
+			handle->batchCount = batchCount;
+			handle->batchNodes.resize(batchNodeCount);
+
+			for(size_t i = 0; i != batchCount; ++i) {
+				handle->batches[i].handle = handle;
+				handle->batches[i].nodesBegin = 0;
+				handle->batches[i].nodesEnd = 0;
+			}
+			for(size_t i = 0; i != orderSize; ++i) {
+				AssetLoadHandle::Node& node = handle->nodes[handle->order[i]];
+				if(node.batchIndex == SIZE_T_MAX)
+					continue;
+
+				node.batchIndex = batchSizes[node.batchIndex];
+				if(node.batchIndex != SIZE_T_MAX)
+					++handle->batches[node.batchIndex].nodesEnd;
+			}
+
+			size_t batchNodeTotal = 0;
+			for(size_t i = 0; i != batchCount; ++i) {
+				AssetLoadHandle::Batch& batch = handle->batches[i];
+				size_t batchSize = batch.nodesEnd;
+				batch.pendingCount = batchSize;
+				batch.nodesBegin = batchNodeTotal;
+				batch.nodesEnd = batchNodeTotal;
+				batchNodeTotal += batchSize;
+			}
+			for(size_t i = 0; i != orderSize; ++i) {
+				AssetLoadHandle::Node& node = handle->nodes[handle->order[i]];
+				if(node.batchIndex == SIZE_T_MAX)
+					continue;
+
+				AssetLoadHandle::Batch& batch = handle->batches[node.batchIndex];
+				handle->batchNodes[batch.nodesEnd++] = handle->order[i];
+				batch.lastNode = handle->order[i];
+			}
+		} else {
+			for(size_t i = 0; i != orderSize; ++i)
+				handle->nodes[handle->order[i]].batchIndex = SIZE_T_MAX;
+		}
+
+		// Add the asset loaded listener before any job can call the event
+		if(assetLoadedListener)
+			handle->assetLoadedEvent.AddListener(*assetLoadedListener);
+
+		// Read the data of every asset loaded from a file asynchronously, if the manager's file reader is running. Every read counts as one more pending dependency of its node,
+		// which must be added to every node before any read is started, since a finished load job may bring its dependents' pending counts to zero
+		size_t readCount = 0;
+		if(fileReader) {
+			for(size_t i = 0; i != orderSize; ++i) {
+				AssetLoadHandle::Node& node = handle->nodes[handle->order[i]];
+				node.asyncRead = !node.data && !node.headerFailed && node.dataSize > node.dataOffset;
+				if(node.asyncRead) {
+					++node.pendingCount;
+					++readCount;
+				}
+			}
+		}
+
+		// Set the load's asset count, pending read count and start time and mark it as started
+		handle->assetCount = orderSize;
+		handle->pendingReadCount = readCount;
+		handle->startTime = AssetTelemetry::GetTime();
+		handle->started = true;
+
+		for(size_t i = 0; i != rootCount; ++i)
+			handle->nodes[handle->order[i]].readyTime = handle->startTime;
+
+		// Queue the reads in the sorted order, so that every asset's dependencies are read before it. The reader keeps many reads in flight at once
+		if(readCount) {
+			for(size_t i = 0; i != orderSize; ++i) {
+				AssetLoadHandle::Node& node = handle->nodes[handle->order[i]];
+				if(!node.asyncRead)
+					continue;
+
+				// Save the time the read was queued at before queueing it, since the callback may be called before Read returns
+				node.readSubmitTime = AssetTelemetry::GetTime();
+				fileReader->Read(node.filePath, node.dataOffset, node.dataSize - node.dataOffset, AssetReadCallback, &node);
+			}
+		}
+
+		// Submit load jobs for every node which had no dependencies in the source and isn't being read; the rest will be submitted by their last dependency's job or by their read's callback.
+		// Batches are submitted once their last node is ready.
+		// The roots are taken from the sorted order, since a running job may bring another node's pending count to zero before this loop reaches it
+		for(size_t i = 0; i != rootCount; ++i)
+			if(!handle->nodes[handle->order[i]].asyncRead)
+				SubmitReadyNode(handle->nodes + handle->order[i]);
+	}
+	void AssetManager::FinishLoad(AssetLoadHandle* handle) {
+		// Wait for the load to finish
+		handle->Wait();
+
+		// Destroy the handle and check if any asset failed to load
+		string sourceName = handle->sourceName;
+		size_t failedCount = handle->failedCount;
+		DestroyObject(handle);
+
+		if(failedCount)
+			throw Exception("Failed to load one or more assets from asset source %s!", sourceName.c_str());
+	}
+	void AssetManager::DestroyUnusedSnapshots() {
+		// Destroy every snapshot which no load or asset references anymore. References are only added by the loads holding one, so an unused snapshot can't be used again
+		size_t snapshotCount = 0;
+		for(AssetSnapshot* snapshot : snapshots) {
+			if(snapshot->IsInUse())
+				snapshots[snapshotCount++] = snapshot;
+			else
+				DestroyObject(snapshot);
+		}
+		snapshots.resize(snapshotCount);
+	}
+	void AssetManager::LinkDirtyAsset(Asset* asset) {
+		dirtyMutex.Lock();
+
+		// Add the asset to the back of the dirty list, if it isn't already in it
+		if(!asset->dirtyLinked) {
+			asset->dirtyPrev = lastDirty;
+			asset->dirtyNext = nullptr;
+			asset->dirtyLinked = true;
+
+			if(lastDirty)
+				lastDirty->dirtyNext = asset;
+			else
+				firstDirty = asset;
+			lastDirty = asset;
+		}
+
+		dirtyMutex.Unlock();
+	}
+	void AssetManager::UnlinkDirtyAsset(Asset* asset) {
+		dirtyMutex.Lock();
+
+		// Remove the asset from the dirty list, if it is in it
+		if(asset->dirtyLinked) {
+			if(asset->dirtyPrev)
+				asset->dirtyPrev->dirtyNext = asset->dirtyNext;
+			else
+				firstDirty = asset->dirtyNext;
+			if(asset->dirtyNext)
+				asset->dirtyNext->dirtyPrev = asset->dirtyPrev;
+			else
+				lastDirty = asset->dirtyPrev;
+
+			asset->dirtyPrev = nullptr;
+			asset->dirtyNext = nullptr;
+			asset->dirtyLinked = false;
+		}
+
+		dirtyMutex.Unlock();
+	}
+	bool8_t AssetManager::ReloadAsset(Asset* asset) {
+		uint64_t id;
+		vector<uint64_t> dependencies;
+		uint32_t flags;
+
+		// Decompress on the calling thread, since reloads may run inside a job and wait for the decompressor's helpers
+		AssetDecompressor decompressor;
+
+		// Reload the asset from its file, if it has one
+		if(!asset->filePath.empty()) {
+			// Start recording the asset's reload, if the manager's telemetry is enabled
+			AssetLoadRecord record;
+			AssetLoadRecord* loadRecord = nullptr;
+			if(telemetry.IsEnabled()) {
+				StartLoadRecord(record, asset->id, FindAssetType(asset->filePath), asset->filePath);
+				loadRecord = &record;
+			}
+
+			FileInput fileInput(asset->filePath, FileInput::STREAM_TYPE_BINARY);
+			if(!fileInput.IsOpen())
+				return false;
+			if(loadRecord)
+				record.openTime = AssetTelemetry::GetTime() - record.startTime;
+
+			AssetInput headerInput(&fileInput, 0);
+			bool8_t result = false;
+			if(ReadAssetHeader(headerInput, id, dependencies, flags) && id == asset->id) {
+				result = asset->InternalLoadFile(asset->filePath, fileInput, headerInput.GetPos(), flags, decompressor, nullptr, loadRecord);
+			}
+
+			fileInput.Close();
+
+			// Add the asset's load record to the manager's telemetry
+			if(loadRecord) {
+				record.loaded = result;
+				telemetry.AddRecord(record);
+			}
+
+			return result;
+		}
+
+		// Find the asset's entry in the manager's asset packs
+		for(AssetPack* pack : packs) {
+			const AssetPack::Entry* entry = pack->FindEntry(asset->id);
+			if(!entry)
+				continue;
+
+			// Start recording the asset's reload, if the manager's telemetry is enabled
+			AssetLoadRecord record;
+			AssetLoadRecord* loadRecord = nullptr;
+			if(telemetry.IsEnabled()) {
+				StartLoadRecord(record, asset->id, AssetPack::FindAssetType(entry->typeHash), pack->GetPackPath());
+				loadRecord = &record;
+			}
+
+			// Reload the asset directly from the mapped pack, skipping its header
+			const char_t* data = (const char_t*)pack->GetEntryData(*entry);
+			size_t dataSize = (size_t)entry->size;
+
+			AssetInput headerInput(data, dataSize);
+			bool8_t result = false;
+			if(ReadAssetHeader(headerInput, id, dependencies, flags)) {
+				AssetInput assetInput(data + headerInput.GetPos(), dataSize - headerInput.GetPos());
+				result = asset->InternalLoad(assetInput, flags, decompressor, nullptr, loadRecord);
+			}
+
+			// Add the asset's load record to the manager's telemetry
+			if(loadRecord) {
+				record.loaded = result;
+				telemetry.AddRecord(record);
+			}
+
+			return result;
+		}
+
+		return false;
+	}
+	bool8_t AssetManager::HotReloadAsset(Asset* asset) {
+		// Open the asset's file, which might have been removed
+		FileInput fileInput(asset->filePath, FileInput::STREAM_TYPE_BINARY);
+		if(!fileInput.IsOpen())
+			return false;
+
+		// Read the asset's new header, keeping the asset unchanged if the header is invalid or its ID changed
+		uint64_t id;
+		vector<uint64_t> dependencies;
+		uint32_t flags;
+		AssetInput headerInput(&fileInput, 0);
+
+		if(!ReadAssetHeader(headerInput, id, dependencies, flags) || id != asset->id) {
+			fileInput.Close();
+			return false;
+		}
+
+		// Exit the function if any of the asset's new dependencies isn't loaded
+		for(uint64_t dependencyID : dependencies) {
+			if(!GetAsset(dependencyID)) {
+				fileInput.Close();
+				return false;
+			}
+		}
+
+		// Acquire the asset, so that it can't be evicted during the reload, and lock its residency mutex, so that no other thread reloads it
+		if(!residency.Acquire(asset)) {
+			fileInput.Close();
+			return false;
+		}
+		asset->residencyMutex.Lock();
+
+		// Acquire the asset's new dependencies, keeping its old ones until the reload succeeds
+		asset->dependencies.swap(dependencies);
+		if(!residency.AcquireDependencies(asset)) {
+			asset->dependencies.swap(dependencies);
+			asset->residencyMutex.Unlock();
+			residency.Release(asset);
+			fileInput.Close();
+			return false;
+		}
+
+		// Save the asset's current data, so that it can be restored if the reload fails. The asset has no unsaved changes, so the data matches its previous file
+		AssetOutput previousData;
+		asset->SaveAsset(previousData);
+		bool8_t previousCompressed = asset->compressed;
+
+		AssetDecompressor decompressor;
+		bool8_t result;
+
+		// Start recording the asset's reload, if the manager's telemetry is enabled
+		AssetLoadRecord record;
+		AssetLoadRecord* loadRecord = nullptr;
+		if(telemetry.IsEnabled()) {
+			StartLoadRecord(record, asset->id, FindAssetType(asset->filePath), asset->filePath);
+			loadRecord = &record;
+		}
+
+		try {
+			result = asset->InternalLoadFile(asset->filePath, fileInput, headerInput.GetPos(), flags, decompressor, nullptr, loadRecord);
+		} catch(const Exception&) {
+			result = false;
+		}
+
+		fileInput.Close();
+
+		// Add the asset's load record to the manager's telemetry
+		if(loadRecord) {
+			record.loaded = result;
+			telemetry.AddRecord(record);
+		}
+
+		if(!result) {
+			// Restore the asset's previous data, release its new dependencies and restore its old ones, leaving its residency unchanged
+			bool8_t restored = asset->InternalLoadSaved(previousData);
+			asset->compressed = previousCompressed;
+
+			residency.ReleaseDependencies(asset);
+			asset->dependencies.swap(dependencies);
+			asset->residencyMutex.Unlock();
+			residency.Release(asset);
+
+			if(!restored)
+				throw Exception("Failed to restore asset %s after a failed hot reload!", asset->filePath.c_str());
+
+			return false;
+		}
+
+		// Remove the asset from the residency tracker with its old dependencies, releasing them, and mark it as resident again with its new size and dependencies
+		asset->dependencies.swap(dependencies);
+		residency.RemoveAsset(asset);
+		asset->dependencies.swap(dependencies);
+		residency.AddResident(asset);
+
+		// Mark the asset as clean and release it
+		asset->savedGeneration = asset->generation;
+
+		asset->residencyMutex.Unlock();
+		residency.Release(asset);
+
+		return true;
+	}
+	void AssetManager::SaveAssets() {
+		// Take the manager's dirty list, so that the assets modified during the save are added to a new list
+		vector<Asset*> dirtyAssets;
+
+		dirtyMutex.Lock();
+		for(Asset* asset = firstDirty; asset; asset = asset->dirtyNext) {
+			asset->dirtyLinked = false;
+			dirtyAssets.push_back(asset);
+		}
+		for(Asset* asset : dirtyAssets) {
+			asset->dirtyPrev = nullptr;
+			asset->dirtyNext = nullptr;
+		}
+		firstDirty = nullptr;
+		lastDirty = nullptr;
+		dirtyMutex.Unlock();
+
+		// Save every listed asset's ID, so that the new IDs can be registered, and keep the modified assets with a valid file path.
+		// Assets which became clean since they were listed are dropped, while modified assets with no file path are listed again
+		vector<uint64_t> ids(dirtyAssets.size());
+
+		size_t dirtyCount = 0;
+		for(size_t i = 0; i != dirtyAssets.size(); ++i) {
+			Asset* asset = dirtyAssets[i];
+			ids[i] = asset->id;
+			if(!asset->IsDirty())
+				continue;
+
+			if(asset->filePath.empty())
+				LinkDirtyAsset(asset);
+			else
+				dirtyAssets[dirtyCount++] = asset;
+		}
+		dirtyAssets.resize(dirtyCount);
+
+		// Submit asset save jobs for every modified asset
+		JobManager::Result* results = nullptr;
+		if(!dirtyAssets.empty()) {
+			results = NewArray<JobManager::Result>(dirtyAssets.size());
+			for(size_t i = 0; i != dirtyAssets.size(); ++i)
+				jobManager->SubmitJob(SaveAssetJob, dirtyAssets[i], results[i]);
+		}
+
+		// Add the new IDs to the manager's ID registry
+		idRegistry.Save(ids);
 
 		// Wait for every asset to finish saving
-		for(size_t i = 0; i != resultsTop; ++i)
-			results[i].WaitForResult();
-		
-		// Free the two allodated arrays
-		FreeMemory(ids);
-		DestroyArray(results, idsTop);
+		if(results) {
+			for(size_t i = 0; i != dirtyAssets.size(); ++i)
+				results[i].WaitForResult();
+			
+			// Free the results array
+			DestroyArray(results, dirtyAssets.size());
+		}
 	}
 
 	vector<Asset*> AssetManager::GetAssets() const {
-		// Lock the manager's mutex
-		managerMutex.Lock();
-
-		// Loop through the manager's assets and add them to a vector
+		// Copy the manager's dense asset array to a vector
 		vector<Asset*> assetsVec;
-		for(auto assetPair : assets)
-			if(assetPair.second)
-				assetsVec.push_back(assetPair.second);
-		
-		// Unlock the manager's mutex and return the vector
-		managerMutex.Unlock();
+		slots.CollectAssets(assetsVec);
 
 		return assetsVec;
 	}
-	Asset* AssetManager::GetAsset(uint64_t id) const {
-		// Lock the manager's mutex
-		managerMutex.Lock();
+	bool8_t AssetManager::EnableHotReload(uint32_t debounceTime) {
+		// Exit the function if hot reload is already enabled
+		if(fileWatcher)
+			return true;
 
-		// Try to find an asset with the given ID
-		auto assetIter = assets.find(id);
-		Asset* asset;
-		if(assetIter == assets.end()) {
-			asset = nullptr;
-		} else {
-			asset = assetIter->second;
+		// Start watching the manager's root directory
+		fileWatcher = NewObject<FileWatcher>(assetDir, debounceTime);
+		if(!fileWatcher->IsOpen()) {
+			DestroyObject(fileWatcher);
+			fileWatcher = nullptr;
+			return false;
+		}
+
+		return true;
+	}
+	void AssetManager::DisableHotReload() {
+		// Stop watching the manager's root directory and forget the files written since it was enabled
+		if(fileWatcher) {
+			DestroyObject(fileWatcher);
+			fileWatcher = nullptr;
 		}
+		savedFileTimes.clear();
+	}
+	size_t AssetManager::PollHotReload() {
+		// Exit the function if hot reload isn't enabled
+		if(!fileWatcher)
+			return 0;
+
+		// Get the files whose changes settled
+		vector<string> changedFiles;
+		fileWatcher->PollChanges(changedFiles);
+		if(changedFiles.empty())
+			return 0;
+
+		// Map every asset file to its asset and every asset to its dependents
+		vector<Asset*> assetsVec;
+		assets.CollectAssets(assetsVec);
+
+		unordered_map<string, Asset*> fileAssets;
+		unordered_map<uint64_t, vector<Asset*>> dependents;
+		for(Asset* asset : assetsVec) {
+			if(!asset->filePath.empty())
+				fileAssets[asset->filePath] = asset;
+			for(uint64_t dependencyID : asset->dependencies)
+				dependents[dependencyID].push_back(asset);
+		}
+
+		// Reload every changed asset in place. Evicted assets read their new file the next time they are acquired
+		vector<Asset*> updatedAssets;
+		set<uint64_t> updatedIDs;
+
+		for(const auto& changedFile : changedFiles) {
+			auto fileAsset = fileAssets.find(changedFile);
+			if(fileAsset == fileAssets.end())
+				continue;
 
-		// Unlock the manager's mutex and return the result
-		managerMutex.Unlock();
+			// Skip the files written by the manager itself, unless they were modified again after the write
+			savedFilesMutex.Lock();
+			auto savedFile = savedFileTimes.find(changedFile);
+			bool8_t saved = savedFile != savedFileTimes.end();
+			uint64_t savedTime = saved ? savedFile->second : 0;
+			if(saved)
+				savedFileTimes.erase(savedFile);
+			savedFilesMutex.Unlock();
+
+			uint64_t fileSize, fileTime;
+			if(saved && GetFileInfo(changedFile, fileSize, fileTime) && fileTime == savedTime)
+				continue;
+
+			Asset* asset = fileAsset->second;
+			if(!asset->resident || asset->IsDirty() || !HotReloadAsset(asset))
+				continue;
+
+			updatedAssets.push_back(asset);
+			updatedIDs.insert(asset->id);
+
+			AssetReloadedEventInfo eventInfo { asset, nullptr };
+			assetReloadedEvent.CallEvent(&eventInfo);
+		}
+
+		// Notify the dependents of every updated asset, propagating the update to their own dependents if they changed as well
+		for(size_t i = 0; i != updatedAssets.size(); ++i) {
+			Asset* dependency = updatedAssets[i];
+
+			auto dependencyDependents = dependents.find(dependency->id);
+			if(dependencyDependents == dependents.end())
+				continue;
+
+			for(Asset* dependent : dependencyDependents->second) {
+				if(!dependent->resident || !dependent->OnDependencyReloaded(dependency))
+					continue;
+
+				AssetReloadedEventInfo eventInfo { dependent, dependency };
+				assetReloadedEvent.CallEvent(&eventInfo);
+
+				// Propagate the update only once per asset, which also stops dependency cycles
+				if(updatedIDs.insert(dependent->id).second)
+					updatedAssets.push_back(dependent);
+			}
+		}
+
+		return updatedAssets.size();
+	}
+	Asset* AssetManager::AcquireAsset(uint64_t id) {
+		// Find the asset and acquire it, reloading it if it was evicted
+		Asset* asset = assets.Find(id);
+		if(!asset)
+			return nullptr;
+
+		prefetcher.RecordAccess(asset);
+		if(!residency.Acquire(asset))
+			return nullptr;
 
 		return asset;
 	}
+	Asset* AssetManager::GetAsset(uint64_t id) const {
+		// Find the asset in the manager's table, without taking any lock
+		return assets.Find(id);
+	}
 
 	AssetManager::~AssetManager() {
+		// Stop watching the manager's root directory and stop prefetching assets
+		DisableHotReload();
+		prefetcher.CancelReplay();
+
 		// Destroy every owned asset
-		for(auto assetPair : assets)
-			if(assetPair.second)
-				DestroyObject(assetPair.second);
+		vector<Asset*> assetsVec;
+		assets.CollectAssets(assetsVec);
+
+		for(Asset* asset : assetsVec)
+			DestroyObject(asset);
+
+		// Destroy every asset pack and snapshot, after all assets which might reference their data are destroyed
+		for(AssetPack* pack : packs)
+			DestroyObject(pack);
+		for(AssetSnapshot* snapshot : snapshots)
+			DestroyObject(snapshot);
+
+		// Stop the asynchronous file reader
+		if(fileReader)
+			DestroyObject(fileReader);
 	}
 }
\ No newline at end of file
@@ -1,11 +1,30 @@
 #pragma once
 
+#include "AssetHandle.hpp"
+#include "AssetIDRegistry.hpp"
+#include "AssetImportCache.hpp"
+#include "AssetInput.hpp"
+#include "AssetOutput.hpp"
+#include "AssetPrefetch.hpp"
+#include "AssetResidency.hpp"
+#include "AssetSlotMap.hpp"
+#include "AssetTable.hpp"
+#include "AssetTelemetry.hpp"
+#include "AssetTypeIndex.hpp"
 #include "General/Program.hpp"
+#include "Platform/AsyncFileReader.hpp"
+#include "Platform/FileWatcher.hpp"
+#include "Platform/MappedFile.hpp"
 
 #include <Core.hpp>
+#include <type_traits>
+#include <typeinfo>
 
 namespace wfe {
+	class AssetLoadHandle;
 	class AssetManager;
+	class AssetPack;
+	class AssetSnapshot;
 	class Program;
 
 	/// @brief The virtual class used for assets bound to files.
@@ -24,8 +43,15 @@ namespace wfe {
 			vector<string> importExtensions;
 			/// @brief The function used to construct assets with the current type.
 			AssetConstructor constructor;
+			/// @brief The C++ type info of the asset type's class.
+			const std::type_info* typeInfo;
+			/// @brief True if the asset type's small assets are loaded in batches using LoadAssetBatch, otherwise false.
+			bool8_t batchLoad;
 		};
 
+		/// @brief Set to true by asset types which load their small assets in batches, by declaring their own public BATCH_LOAD constant and overriding LoadAssetBatch.
+		static const bool8_t BATCH_LOAD = false;
+
 		/// @brief Returns all asset types.
 		/// @return A vector containing structs with descriptions of every asset type.
 		static const vector<AssetType>& GetAssetTypes() {
@@ -36,6 +62,17 @@ namespace wfe {
 		static void AddAssetType(const AssetType& newType) {
 			assetTypes.push_back(newType);
 		}
+		/// @brief Finds the index of the asset type with the given class in the type vector.
+		/// @param typeInfo The C++ type info of the asset type's class.
+		/// @return The index of the asset type, or SIZE_T_MAX if the class isn't a registered asset type.
+		static size_t FindAssetTypeIndex(const std::type_info& typeInfo);
+		/// @brief Reads an asset's header, leaving the given input at the start of the asset's data.
+		/// @param assetInput The input to read the header from.
+		/// @param id A reference to the variable to write the asset's ID to.
+		/// @param dependencies A reference to the vector to write the asset's dependency IDs to.
+		/// @param flags A reference to the variable to write the asset's flags to.
+		/// @return True if the header was read, otherwise false if it is truncated or invalid.
+		static bool8_t ReadHeader(AssetInput& assetInput, uint64_t& id, vector<uint64_t>& dependencies, uint32_t& flags);
 
 		Asset() = delete;
 		Asset(const Asset&) = delete;
@@ -46,12 +83,12 @@ namespace wfe {
 
 		/// @brief Loads the asset from the given file.
 		/// @param filePath The path of the file to load the asset from.
-		/// @return True if all of the asset's dependencies are supported, otherwise false.
+		/// @return True if all of the asset's dependencies are loaded and the asset was loaded successfully, otherwise false.
 		bool8_t Load(const string& filePath);
-		/// @brief Imports the asset from the given file and saves it to a separate file.
+		/// @brief Imports the asset from the given file and marks it as dirty. If the asset's importer supports caching and the file, importer version and import settings didn't change since a previous import, the cached import is loaded instead.
 		/// @param filePath The path of the file to import the asset from.
 		void Import(const string& filePath);
-		/// @brief Saves the asset's info to its file.
+		/// @brief Saves the asset's info to its file and marks the asset as clean.
 		void Save();
 
 		/// @brief Gets the asset's unique ID, which is used to identify the asset for whichever dependencies have it.
@@ -59,11 +96,61 @@ namespace wfe {
 		uint64_t GetID() const {
 			return id;
 		}
+		/// @brief Gets a generational handle to the asset, which can be resolved by the asset's manager without any lookup.
+		/// @return A handle to the asset, or a null handle if the asset wasn't added to its manager yet.
+		AssetHandle<Asset> GetHandle() const {
+			return AssetHandle<Asset>(slotIndex, slotGeneration);
+		}
 		/// @brief Gets the asset's file path.
 		/// @return The asset's file path.
 		const string& GetFilePath() const {
 			return filePath;
 		}
+		/// @brief Marks the asset as modified, adding it to the manager's dirty list, which causes it to be saved on the manager's next save.
+		void MarkDirty();
+		/// @brief Checks if the asset was modified since it was last saved or loaded.
+		/// @return True if the asset has unsaved changes, otherwise false.
+		bool8_t IsDirty() const {
+			return generation != savedGeneration;
+		}
+		/// @brief Gets the asset's generation, which is incremented every time the asset is modified.
+		/// @return The asset's current generation.
+		uint64_t GetGeneration() const {
+			return generation;
+		}
+		/// @brief Checks if the asset's data is compressed in its file.
+		/// @return True if the asset is saved compressed, otherwise false.
+		bool8_t IsCompressed() const {
+			return compressed;
+		}
+		/// @brief Sets whether the asset's data will be compressed in its file, marking the asset as dirty if the setting changed.
+		/// @param compressed True if the asset's data should be compressed, otherwise false.
+		void SetCompressed(bool8_t compressed) {
+			if(this->compressed != compressed) {
+				this->compressed = compressed;
+				MarkDirty();
+			}
+		}
+		/// @brief Checks if the asset's data is loaded in memory.
+		/// @return True if the asset is resident, or false if it was evicted.
+		bool8_t IsResident() const {
+			return resident;
+		}
+		/// @brief Gets the number of bytes the asset's loaded data takes up, which counts towards its memory usage type's budget.
+		/// @return The size of the asset's loaded data.
+		virtual size_t GetMemorySize() const {
+			return 0;
+		}
+		/// @brief Gets the memory usage type whose budget the asset's loaded data counts towards. Assets whose loaded data lives in GPU memory should return MEMORY_USAGE_TYPE_RENDERER, which is the only type trimmed when a GPU memory heap is under pressure.
+		/// @return The asset's memory usage type.
+		virtual MemoryUsageType GetMemoryUsageType() const {
+			return MEMORY_USAGE_TYPE_OTHER;
+		}
+		/// @brief Gets the IDs of the assets this asset depends on.
+		/// @return A vector containing the IDs of every dependency of this asset.
+		const vector<uint64_t>& GetDependencies() const {
+			return dependencies;
+		}
 		/// @brief Gets the manager which owns this asset.
 		/// @return A pointer to the asset's manager.
 		AssetManager* GetManager() {
@@ -83,28 +170,101 @@ namespace wfe {
 		/// @param fromFile True if the asset will be loaded from a file, otherwise false.
 		Asset(AssetManager* manager, bool8_t fromFile);
 
-		/// @brief Loads the current asset from the given file input stream.
-		/// @param fileInput The file input stream to load from.
-		/// @return True if all of the asset's dependencies are supported, otherwise false.
-		virtual bool8_t LoadAsset(FileInput& fileInput) = 0;
+		/// @brief Adds the given asset as a dependency of this asset, which will be loaded before this asset.
+		/// @param dependencyID The ID of the dependency to add.
+		void AddDependency(uint64_t dependencyID);
+		/// @brief Removes the given asset from this asset's dependencies.
+		/// @param dependencyID The ID of the dependency to remove.
+		void RemoveDependency(uint64_t dependencyID);
+
+		/// @brief Loads the current asset from the given asset input stream. Every dependency of the asset is guaranteed to be loaded.
+		/// @param assetInput The asset input stream to load from.
+		/// @return True if the asset was loaded successfully, otherwise false.
+		virtual bool8_t LoadAsset(AssetInput& assetInput) = 0;
+		/// @brief Loads a batch of small assets with the current type from a single job, called on the batch's first asset. Only called for asset types whose BATCH_LOAD constant is true. Every dependency of every asset in the batch is guaranteed to be loaded, and every asset input stream is backed by memory. By default, calls LoadAsset for every asset.
+		/// @param assets An array of pointers to the batch's assets, which all have the current type.
+		/// @param assetInputs An array of the asset input streams to load the assets from.
+		/// @param results An array in which every asset's result must be written, which is true if the asset was loaded successfully, otherwise false.
+		/// @param count The number of assets in the batch.
+		virtual void LoadAssetBatch(Asset* const* assets, AssetInput* assetInputs, bool8_t* results, size_t count);
 		/// @brief Imports one ore more assets from the given file input stream.
 		/// @param fileInput The file input stream to import from.
 		virtual void ImportAsset(FileInput& fileInput) = 0;
-		/// @brief Saves the current asset to the given file output stream.
-		/// @param fileOutput The file output stream to save to.
-		virtual void SaveAsset(FileOutput& fileOutput) = 0;
+		/// @brief Gets the version of the asset's importer, which must be changed whenever the importer's output changes.
+		/// @return The importer's version, or 0 if the importer's results can't be cached, for example because it creates other assets.
+		virtual uint32_t GetImporterVersion() const {
+			return 0;
+		}
+		/// @brief Gets the hash of the settings which affect the asset's import.
+		/// @return The hash of the asset's import settings.
+		virtual uint64_t GetImportSettingsHash() const {
+			return 0;
+		}
+		/// @brief Saves the current asset to the given asset output stream.
+		/// @param assetOutput The asset output stream to save to.
+		virtual void SaveAsset(AssetOutput& assetOutput) = 0;
+		/// @brief Frees the asset's loaded data. The asset will be loaded again by LoadAsset the next time it is acquired. Called with the residency lock held, so it must not acquire or release assets.
+		/// @return True if the asset's data was freed, or false if the asset doesn't support unloading.
+		virtual bool8_t UnloadAsset() {
+			return false;
+		}
+		/// @brief Checks if the asset is loaded in place. Assets loaded in place are loaded from a memory-backed asset input stream whose memory stays valid while the asset is loaded, so they can use their data directly, for example through an asset blob. Their files are mapped into memory, and compressed data is kept after decompression.
+		/// @return True if the asset is loaded in place, otherwise false.
+		virtual bool8_t UsesInPlaceLoad() const {
+			return false;
+		}
+		/// @brief Called by the manager's hot reload after one of the asset's dependencies was reloaded in place.
+		/// @param dependency A pointer to the reloaded dependency.
+		/// @return True if the asset updated its own data, in which case the asset's dependents are notified as well, otherwise false.
+		virtual bool8_t OnDependencyReloaded(Asset* dependency) {
+			return false;
+		}
 
 		string filePath;
 	private:
 		friend AssetManager;
+		friend AssetPrefetcher;
+		friend AssetResidency;
+		friend AssetTypeIndex;
 
 		static vector<AssetType> assetTypes;
 
+		bool8_t InternalLoad(AssetInput& assetInput, uint32_t flags, AssetDecompressor& decompressor, JobManager* jobManager, AssetLoadRecord* record);
+		bool8_t InternalLoadFile(const string& filePath, FileInput& fileInput, size_t dataOffset, uint32_t flags, AssetDecompressor& decompressor, JobManager* jobManager, AssetLoadRecord* record);
+		bool8_t InternalLoadSaved(const AssetOutput& assetOutput);
+		void InternalFreeInPlaceData();
+
 		AssetManager* manager;
 		uint64_t id;
+		vector<uint64_t> dependencies;
+		uint32_t slotIndex;
+		uint32_t slotGeneration;
+		size_t typeIndex;
+		size_t typeListIndex;
+
+		atomic_uint64_t generation;
+		uint64_t savedGeneration;
+		bool8_t compressed;
+
+		AtomicMutex residencyMutex;
+		size_t residencyRefCount;
+		size_t residentSize;
+		MemoryUsageType residentUsageType;
+		Asset* residencyPrev;
+		Asset* residencyNext;
+		bool8_t resident;
+		bool8_t residencyLinked;
+
+		MappedFile* inPlaceFile;
+		void* inPlaceData;
+		AssetSnapshot* inPlaceSnapshot;
+
+		Asset* dirtyPrev;
+		Asset* dirtyNext;
+		bool8_t dirtyLinked;
 	};
 
-#define WFE_ASSET_TYPE(typeName, fileExtension, importExtensions) \
+#define WFE_ASSET_TYPE(typeName, typeFileExtension, typeImportExtensions) \
 static wfe::Asset* typeName ## Constructor(wfe::AssetManager* manager, wfe::bool8_t fromFile) { \
 	return (wfe::Asset*)wfe::NewObject<typeName>(manager, fromFile); \
 } \
@@ -113,22 +273,160 @@ static void typeName ## TypeInfoConstructor() { \
 	wfe::Asset::AssetType assetType; \
 \
 	assetType.name = #typeName; \
-	assetType.fileExtension = fileExtension; \
-	assetType.importExtensions = importExtensions; \
+	assetType.fileExtension = typeFileExtension; \
+	assetType.importExtensions = typeImportExtensions; \
 	assetType.constructor = typeName ## Constructor; \
+	assetType.typeInfo = &typeid(typeName); \
+	assetType.batchLoad = typeName::BATCH_LOAD; \
 \
 	/* Add the asset type to the type vector */ \
 	wfe::Asset::AddAssetType(assetType); \
 } \
-WFE_RUN(TypeInfoConstructor)
+WFE_RUN(typeName ## TypeInfoConstructor)
+
+	/// @brief A handle to an asynchronous asset load, which can be polled or waited on.
+	class AssetLoadHandle {
+	public:
+		/// @brief A struct containing the info of an asset loaded event.
+		struct AssetLoadedEventInfo {
+			/// @brief The handle of the load the asset is part of.
+			AssetLoadHandle* handle;
+			/// @brief The ID of the asset.
+			uint64_t id;
+			/// @brief A pointer to the loaded asset, or nullptr if the asset failed to load.
+			Asset* asset;
+		};
+
+		/// @brief Creates an asset load handle. Handles are created by the asset manager's async load functions.
+		/// @param manager The asset manager which will load the assets.
+		/// @param nodeCount The number of files or pack entries in the load.
+		/// @param sourceName The name of the directory or asset pack being loaded.
+		AssetLoadHandle(AssetManager* manager, size_t nodeCount, const string& sourceName);
+
+		AssetLoadHandle() = delete;
+		AssetLoadHandle(const AssetLoadHandle&) = delete;
+		AssetLoadHandle(AssetLoadHandle&&) noexcept = delete;
+
+		AssetLoadHandle& operator=(const AssetLoadHandle&) = delete;
+		AssetLoadHandle& operator=(AssetLoadHandle&&) = delete;
+
+		/// @brief Gets the name of the directory or asset pack being loaded.
+		/// @return The name of the load's asset source.
+		const string& GetSourceName() const {
+			return sourceName;
+		}
+		/// @brief Gets the number of assets in the load.
+		/// @return The total number of assets which will be loaded.
+		size_t GetAssetCount() const {
+			return assetCount;
+		}
+		/// @brief Gets the number of assets which were loaded successfully so far.
+		/// @return The number of loaded assets.
+		size_t GetLoadedCount() const {
+			return loadedCount;
+		}
+		/// @brief Gets the number of assets which failed to load so far, including the assets whose dependencies failed to load.
+		/// @return The number of failed assets.
+		size_t GetFailedCount() const {
+			return failedCount;
+		}
+		/// @brief Gets the number of bytes read by the load so far.
+		/// @return The number of bytes read.
+		uint64_t GetBytesRead() const {
+			return bytesRead;
+		}
+		/// @brief Checks if every asset in the load was either loaded or failed to load.
+		/// @return True if the load is finished, otherwise false.
+		bool8_t IsFinished() const {
+			return loadedCount + failedCount == assetCount;
+		}
+		/// @brief Waits for every asset in the load to finish loading.
+		void Wait();
+
+		/// @brief Waits for the load to finish and destroys the handle.
+		~AssetLoadHandle();
+	private:
+		friend AssetManager;
+
+		struct Node {
+			AssetLoadHandle* handle;
+			const Asset::AssetType* assetType;
+			string filePath;
+			const char_t* data;
+			size_t dataSize;
+			size_t dataOffset;
+			uint64_t id;
+			uint32_t flags;
+			vector<uint64_t> dependencies;
+			bool8_t headerFailed;
+			AssetDecompressor decompressor;
+			void* readData;
+			bool8_t asyncRead;
+			uint64_t readSubmitTime;
+			uint64_t readTime;
+
+			size_t dependentsBegin;
+			size_t dependentsEnd;
+			atomic_size_t pendingCount;
+			atomic_int32_t dependencyFailed;
+			bool8_t failed;
+			uint64_t readyTime;
+			size_t batchIndex;
+
+			JobManager::Result result;
+		};
+		struct Batch {
+			AssetLoadHandle* handle;
+			size_t nodesBegin;
+			size_t nodesEnd;
+			size_t lastNode;
+			atomic_size_t pendingCount;
+
+			JobManager::Result result;
+		};
+
+		AssetManager* manager;
+		string sourceName;
+
+		Node* nodes;
+		size_t nodeCount;
+		vector<size_t> dependents;
+		size_t* order;
+		Batch* batches;
+		size_t batchCount;
+		vector<size_t> batchNodes;
+		size_t assetCount;
+		bool8_t started;
+		uint64_t startTime;
+		AssetSnapshot* snapshot;
+
+		atomic_size_t loadedCount;
+		atomic_size_t failedCount;
+		atomic_size_t pendingReadCount;
+		atomic_uint64_t bytesRead;
+		Event assetLoadedEvent;
+	};
 
 	/// @brief A manager class that keeps track for multiple assets.
 	class AssetManager {
 	public:
+		/// @brief A struct containing the info of an asset reloaded event.
+		struct AssetReloadedEventInfo {
+			/// @brief A pointer to the reloaded asset.
+			Asset* asset;
+			/// @brief A pointer to the reloaded dependency which caused the asset to update, or nullptr if the asset's own file changed.
+			Asset* dependency;
+		};
+
+		/// @brief The maximum size of an asset's data for the asset to be loaded in a batch.
+		static const size_t BATCH_LOAD_MAX_ASSET_SIZE = 0x4000;
+		/// @brief The maximum number of assets in a single batch.
+		static const size_t BATCH_LOAD_MAX_COUNT = 256;
+
 		/// @brief Creates an asset manager for the given directory.
 		/// @param assetDir The directory to scan for assets.
-		/// @param program The program which owns the job manager.
-		AssetManager(const string& assetDir, Program* program);
+		/// @param jobManager The job manager used to load, import and save assets.
+		AssetManager(const string& assetDir, JobManager* jobManager);
 
 		AssetManager() = delete;
 		AssetManager(const AssetManager&) = delete;
@@ -138,12 +436,21 @@ WFE_RUN(TypeInfoConstructor)
 		AssetManager& operator=(AssetManager&&) = delete;
 
 		/// @brief Creates an asset owned by this manager.
-		/// @tparam T The type of the asset to be created.
+		/// @tparam T The type of the asset to be created, which must be registered with WFE_ASSET_TYPE.
 		/// @param fromFile True if the asset will be loaded from a file, otherwise false.
 		/// @return A pointer to the newly created asset.
 		template<class T>
 		T* CreateAsset(bool8_t fromFile) {
-			return NewObject<T>(this, fromFile);
+			// Check if the asset's class is registered before creating it, since the type index only lists registered classes
+			if(Asset::FindAssetTypeIndex(typeid(T)) == SIZE_T_MAX)
+				throw Exception("Asset class %s isn't a registered asset type!", typeid(T).name());
+
+			// Create the asset and add it to its type's list, if it was added to the manager by its constructor
+			T* asset = NewObject<T>(this, fromFile);
+			if(!fromFile)
+				typeLists.Insert(asset);
+
+			return asset;
 		}
 		/// @brief Destroys an asset owned by this manager.
 		/// @param asset The asset to destroy.
@@ -151,42 +458,296 @@ WFE_RUN(TypeInfoConstructor)
 			DestroyObject(asset);
 		}
 
-		/// @brief Loads every asset from the given directory.
+		/// @brief Checks if the manager reads asset files asynchronously, which is only supported on some platforms. Otherwise, asset files are read by the load jobs.
+		/// @return True if the manager's asynchronous file reader is running, otherwise false.
+		bool8_t IsAsyncIOEnabled() const {
+			return fileReader != nullptr;
+		}
+
+		/// @brief Sets the patterns of the files and directories skipped when scanning asset directories. A pattern can use '*' to match any sequence of characters and '?' to match any single character. Patterns containing a '/' are matched against paths relative to the manager's root directory, while other patterns are matched against names. By default, every hidden file and directory is skipped. Must not be called during a load.
+		/// @param patterns The new ignore patterns.
+		void SetIgnorePatterns(const vector<string>& patterns) {
+			ignorePatterns = patterns;
+		}
+		/// @brief Gets the patterns of the files and directories skipped when scanning asset directories.
+		/// @return A const reference to the manager's ignore patterns.
+		const vector<string>& GetIgnorePatterns() const {
+			return ignorePatterns;
+		}
+
+		/// @brief Loads every asset from the given directory. Every asset is loaded exactly once, as soon as all of its dependencies are loaded and its file was read. Small assets whose types load in batches are grouped by type and loaded together by a single job.
+		/// @param dirPath The directory to load from, relative to the asset manager's root directory.
+		/// @param recursive True if the assets in the directory's subdirectories should be loaded too, otherwise false.
+		void LoadAssets(const string& dirPath, bool8_t recursive = true);
+		/// @brief Starts loading every asset from the given directory in the background. The directory tree is scanned in parallel, one job per directory, and the assets' headers are read before the function returns.
+		/// @param dirPath The directory to load from, relative to the asset manager's root directory.
+		/// @param assetLoadedListener A pointer to a listener called from the job threads with an AssetLoadedEventInfo for every asset, or nullptr if not needed.
+		/// @param recursive True if the assets in the directory's subdirectories should be loaded too, otherwise false.
+		/// @return A handle to the load, which must be destroyed using DestroyObject.
+		AssetLoadHandle* LoadAssetsAsync(const string& dirPath, const Event::Listener* assetLoadedListener = nullptr, bool8_t recursive = true);
+		/// @brief Loads every asset from the given asset pack, reading the assets' data directly from the mapped pack.
+		/// @param packPath The path of the asset pack, relative to the asset manager's root directory.
+		void LoadAssetPack(const string& packPath);
+		/// @brief Starts loading every asset from the given asset pack in the background.
+		/// @param packPath The path of the asset pack, relative to the asset manager's root directory.
+		/// @param assetLoadedListener A pointer to a listener called from the job threads with an AssetLoadedEventInfo for every asset, or nullptr if not needed.
+		/// @return A handle to the load, which must be destroyed using DestroyObject.
+		AssetLoadHandle* LoadAssetPackAsync(const string& packPath, const Event::Listener* assetLoadedListener = nullptr);
+		/// @brief Imports every file with a supported import extension from the given source directory tree in parallel and saves the imported assets to the given directory, in the subdirectories matching their source files'. Assets which were imported before keep their IDs, and loaded assets are re-imported in place, so they must not be in use.
+		/// @param sourceDirPath The path of the source directory to import from.
+		/// @param dirPath The directory to save the imported assets to, relative to the asset manager's root directory.
+		void ImportAssets(const string& sourceDirPath, const string& dirPath);
+		/// @brief Cooks every asset from the given directory tree into an asset pack.
+		/// @param dirPath The directory to cook, relative to the asset manager's root directory.
+		/// @param packPath The path of the asset pack to write, relative to the asset manager's root directory.
+		void CookAssets(const string& dirPath, const string& packPath);
+		/// @brief Writes a snapshot of every asset from the given directory tree, containing the assets' table, dependencies and data in one contiguous image, with every asset's data aligned for in-place loads. Previously loaded snapshots which are no longer used by any load or asset are unmapped.
+		/// @param dirPath The directory to snapshot, relative to the asset manager's root directory.
+		/// @param snapshotPath The path of the snapshot to write, relative to the asset manager's root directory.
+		void SaveAssetSnapshot(const string& dirPath, const string& snapshotPath);
+		/// @brief Loads every asset from the given directory tree using its snapshot, reading the assets' data directly from the mapped snapshot.
 		/// @param dirPath The directory to load from, relative to the asset manager's root directory.
-		void LoadAssets(const string& dirPath);
-		/// @brief Saves all of the manager's assets which have a valid file path.
+		/// @param snapshotPath The path of the directory's snapshot, relative to the asset manager's root directory.
+		/// @return True if the snapshot was used, or false if it's missing or outdated, in which case no assets are loaded.
+		bool8_t LoadAssetSnapshot(const string& dirPath, const string& snapshotPath);
+		/// @brief Starts loading every asset from the given directory tree in the background using its snapshot. The snapshot is only used if every asset file in the directory tree has the same size and modification time as when the snapshot was written. The snapshot stays mapped while the load or any asset loaded in place from it uses its data, and previously loaded snapshots which are no longer used are unmapped.
+		/// @param dirPath The directory to load from, relative to the asset manager's root directory.
+		/// @param snapshotPath The path of the directory's snapshot, relative to the asset manager's root directory.
+		/// @param assetLoadedListener A pointer to a listener called from the job threads with an AssetLoadedEventInfo for every asset, or nullptr if not needed.
+		/// @return A handle to the load, which must be destroyed using DestroyObject, or nullptr if the snapshot is missing or outdated.
+		AssetLoadHandle* LoadAssetSnapshotAsync(const string& dirPath, const string& snapshotPath, const Event::Listener* assetLoadedListener = nullptr);
+		/// @brief Acquires a reference to the asset with the given ID, reloading it if it was evicted. Acquired assets are never evicted until released. The access is recorded by the manager's prefetcher.
+		/// @param id The ID of the asset to acquire.
+		/// @return A pointer to the acquired asset, or nullptr if no asset with the given ID exists or it couldn't be reloaded.
+		Asset* AcquireAsset(uint64_t id);
+		/// @brief Releases a reference to the given asset, allowing it to be evicted once no references are left.
+		/// @param asset The asset to release.
+		void ReleaseAsset(Asset* asset) {
+			residency.Release(asset);
+		}
+		/// @brief Gets the manager's residency tracker, which holds the memory budgets.
+		/// @return A reference to the manager's residency tracker.
+		AssetResidency& GetResidency() {
+			return residency;
+		}
+		/// @brief Gets the manager's residency tracker, which holds the memory budgets.
+		/// @return A const reference to the manager's residency tracker.
+		const AssetResidency& GetResidency() const {
+			return residency;
+		}
+		/// @brief Saves all of the manager's modified assets which have a valid file path and appends the IDs of the modified assets to the manager's ID registry. Only the assets marked as dirty since the previous save are visited, so the save's cost is proportional to the number of modified assets.
 		void SaveAssets();
 
+		/// @brief Starts watching the manager's root directory for modified asset files.
+		/// @param debounceTime The time an asset file must stay unmodified before it is reloaded, in milliseconds.
+		/// @return True if the root directory is being watched, otherwise false.
+		bool8_t EnableHotReload(uint32_t debounceTime = FileWatcher::DEFAULT_DEBOUNCE_TIME);
+		/// @brief Stops watching the manager's root directory.
+		void DisableHotReload();
+		/// @brief Checks if the manager's root directory is being watched.
+		/// @return True if hot reload is enabled, otherwise false.
+		bool8_t IsHotReloadEnabled() const {
+			return fileWatcher != nullptr;
+		}
+		/// @brief Reloads every resident asset whose file changed in place, under its existing ID, then notifies the assets which depend on it. Dirty assets are skipped, so unsaved changes are never lost, and so are the files last written by the manager's own saves and imports. The reloaded assets must not be used by other threads during the call.
+		/// @return The number of reloaded assets, including the dependents which updated their data.
+		size_t PollHotReload();
+		/// @brief Gets the manager's asset reloaded event, called with an AssetReloadedEventInfo for every asset updated by a hot reload.
+		/// @return A reference to the manager's asset reloaded event.
+		Event& GetAssetReloadedEvent() {
+			return assetReloadedEvent;
+		}
+
+		/// @brief Gets the manager's load telemetry, which records the timings of every asset loaded or reloaded by the manager.
+		/// @return A reference to the manager's load telemetry.
+		AssetTelemetry& GetTelemetry() {
+			return telemetry;
+		}
+		/// @brief Gets the manager's load telemetry, which records the timings of every asset loaded or reloaded by the manager.
+		/// @return A const reference to the manager's load telemetry.
+		const AssetTelemetry& GetTelemetry() const {
+			return telemetry;
+		}
+
+		/// @brief Gets the manager's prefetcher, which records the first access of every asset into a manifest and replays recorded manifests as prefetch jobs.
+		/// @return A reference to the manager's prefetcher.
+		AssetPrefetcher& GetPrefetcher() {
+			return prefetcher;
+		}
+		/// @brief Gets the manager's prefetcher, which records the first access of every asset into a manifest and replays recorded manifests as prefetch jobs.
+		/// @return A const reference to the manager's prefetcher.
+		const AssetPrefetcher& GetPrefetcher() const {
+			return prefetcher;
+		}
+
+		/// @brief Gets the total time threads spent waiting for the manager's internal locks, which include the asset table's shard locks, the slot map's lock, the type index's lock, the residency tracker's lock, the dirty list's lock and the ID registry's lock.
+		/// @return The total wait time, in nanoseconds.
+		uint64_t GetLockWaitTime() const {
+			return assets.GetLockWaitTime() + slots.GetLockWaitTime() + typeLists.GetLockWaitTime() + residency.GetLockWaitTime() + dirtyMutex.GetWaitTime() + idRegistry.GetLockWaitTime();
+		}
+
 		/// @brief Gets the manager's assets.
-		/// @return A vector containing pointers to every single asset managed 
+		/// @return A vector containing pointers to every single asset managed, copied from the manager's dense asset array.
 		vector<Asset*> GetAssets() const;
-		/// @brief Gets the manager's asset with the given ID.
+		/// @brief Calls the given function for every asset of the given type, including assets of its subclasses, without taking any lock or allocating memory. Only the dense lists of the registered types whose assets are a T are iterated. Assets created or destroyed during the iteration may be skipped or visited twice.
+		/// @tparam T The type of the assets.
+		/// @tparam F The type of the function.
+		/// @param func The function to call with a T pointer to every asset.
+		template<class T, class F>
+		void ForEachAsset(F&& func) const {
+			for(size_t i = 0; i != typeLists.GetTypeCount(); ++i) {
+				// Every asset in a type's list has the same class, so the whole list is skipped unless its first asset is a T
+				if(!InternalIsTypeListOf<T>(i))
+					continue;
+
+				typeLists.ForEach(i, [&func](Asset* asset) {
+					if constexpr(std::is_base_of_v<Asset, T>)
+						func(static_cast<T*>(asset));
+					else
+						func(dynamic_cast<T*>(asset));
+				});
+			}
+		}
+		/// @brief Gets the manager's assets of the given type.
+		/// @tparam T The type of the assets.
+		/// @return A vector containing pointers to every asset of the given type or its subclasses, in the order of their types' dense lists.
+		template<class T>
+		vector<T*> GetAssets() const {
+			vector<T*> typedAssets;
+			ForEachAsset<T>([&typedAssets](T* asset) {
+				typedAssets.push_back(asset);
+			});
+
+			return typedAssets;
+		}
+		/// @brief Gets the number of assets of the given type, including assets of its subclasses.
+		/// @tparam T The type of the assets.
+		/// @return The number of assets.
+		template<class T>
+		size_t GetAssetCount() const {
+			// Add up the sizes of the lists of every registered type whose assets are a T
+			size_t count = 0;
+			for(size_t i = 0; i != typeLists.GetTypeCount(); ++i)
+				if(InternalIsTypeListOf<T>(i))
+					count += typeLists.GetCount(i);
+
+			return count;
+		}
+		/// @brief Gets the number of assets in the manager.
+		/// @return The number of assets.
+		size_t GetAssetCount() const {
+			return slots.GetCount();
+		}
+		/// @brief Gets the manager's asset with the given ID, without taking any lock. The returned asset may have been evicted by the residency tracker, in which case its data isn't loaded; use AcquireAsset to get an asset that is resident and can't be evicted while in use.
 		/// @param id The ID to check.
-		/// @return The pointer to the asset with the requested ID, otherwise a nullptr.
+		/// @return The pointer to the asset with the requested ID, which may not be resident, otherwise a nullptr.
 		Asset* GetAsset(uint64_t id) const;
+		/// @brief Gets a generational handle to the asset with the given ID. The ID is looked up once, after which the handle resolves without any lookup. The lookup is recorded by the manager's prefetcher.
+		/// @tparam T The type of the asset.
+		/// @param id The ID of the asset.
+		/// @return A handle to the asset, or a null handle if no asset with the given ID and type exists.
+		template<class T>
+		AssetHandle<T> GetHandle(uint64_t id) const {
+			Asset* asset = GetAsset(id);
+			if(!dynamic_cast<T*>(asset))
+				return AssetHandle<T>();
+			prefetcher.RecordAccess(asset);
+			return AssetHandle<T>(asset->slotIndex, asset->slotGeneration);
+		}
+		/// @brief Gets a generational handle to the given asset.
+		/// @tparam T The type of the asset.
+		/// @param asset A pointer to the asset.
+		/// @return A handle to the asset, or a null handle if the asset wasn't added to the manager yet.
+		template<class T>
+		AssetHandle<T> GetHandle(const T* asset) const {
+			return AssetHandle<T>(asset->slotIndex, asset->slotGeneration);
+		}
+		/// @brief Resolves the given handle without taking any lock, by comparing the generation of its slot.
+		/// @tparam T The type of the asset.
+		/// @param handle The handle to resolve.
+		/// @return A pointer to the handle's asset, or nullptr if the handle is null or stale because its asset was destroyed.
+		template<class T>
+		T* Resolve(AssetHandle<T> handle) const {
+			return static_cast<T*>(slots.Resolve(handle.GetIndex(), handle.GetGeneration()));
+		}
 
 		/// @brief Destroys the asset manager.
 		~AssetManager();
 	private:
 		friend Asset;
+		friend AssetLoadHandle;
+		friend AssetPrefetcher;
+		friend AssetResidency;
 
-		struct LoadAssetJobArgs {
+		struct ImportTask {
 			AssetManager* manager;
-			Asset* asset;
-			string filePath;
-			FileInput fileInput;
-			bool8_t finished;
-			bool8_t finishedCached;
+			const Asset::AssetType* assetType;
+			string sourcePath;
+			string assetPath;
+			JobManager::Result result;
 		};
 
+		struct ScanTask {
+			AssetManager* manager;
+			string rootDir;
+			string dirPath;
+			bool8_t sourceFiles;
+			vector<string> files;
+			vector<string> subdirs;
+			JobManager::Result result;
+		};
+
+		static void* ScanDirectoryJob(void* args);
+		static void* ReadAssetHeaderJob(void* args);
+		static void* ImportAssetJob(void* args);
 		static void* LoadAssetJob(void* args);
+		static void* LoadAssetBatchJob(void* args);
+		static void SubmitReadyNode(AssetLoadHandle::Node* node);
+		static void FinishLoadNode(AssetLoadHandle::Node* node, Asset* asset);
+		static void AssetReadCallback(void* userData, void* buffer, size_t size, bool8_t success);
+		static void AcquireInPlaceSnapshot(AssetLoadHandle* handle, Asset* asset);
+
+		void ScanDirectory(const string& rootDir, const string& dirPath, bool8_t recursive, bool8_t sourceFiles, vector<string>& files);
+		void ScanAssetDirectory(const string& dirPath, bool8_t recursive, vector<string>& files);
+		void StartLoad(AssetLoadHandle* handle, const Event::Listener* assetLoadedListener);
+		void FinishLoad(AssetLoadHandle* handle);
+		void DestroyUnusedSnapshots();
+		void LinkDirtyAsset(Asset* asset);
+		void UnlinkDirtyAsset(Asset* asset);
+		bool8_t ReloadAsset(Asset* asset);
+		bool8_t HotReloadAsset(Asset* asset);
 		static void* SaveAssetJob(void* args);
 
+		template<class T>
+		bool8_t InternalIsTypeListOf(size_t typeIndex) const {
+			Asset* asset = typeLists.GetFirst(typeIndex);
+			return asset && dynamic_cast<T*>(asset);
+		}
+
 		string assetDir;
-		Program* program;
+		JobManager* jobManager;
+		vector<string> ignorePatterns;
+		vector<AssetPack*> packs;
+		vector<AssetSnapshot*> snapshots;
+
+		AssetTable assets;
+		AssetSlotMap slots;
+		AssetTypeIndex typeLists;
+		AssetResidency residency;
+		AssetImportCache importCache;
+		AssetTelemetry telemetry;
+		AssetPrefetcher prefetcher;
+
+		AsyncFileReader* fileReader;
+		FileWatcher* fileWatcher;
+		Event assetReloadedEvent;
+		AtomicMutex savedFilesMutex;
+		unordered_map<string, uint64_t> savedFileTimes;
+
+		AssetMutex dirtyMutex;
+		Asset* firstDirty;
+		Asset* lastDirty;
 
-		mutable AtomicMutex managerMutex;
-	 	unordered_map<uint64_t, Asset*> assets;
-		uint64_t nextID;
+		AssetIDRegistry idRegistry;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include "AssetBlob.hpp"
+
+namespace wfe {
+	// Constants
+	static const size_t MIN_BLOB_CAPACITY = 0x1000;
+
+	// Public functions
+	AssetBlobBuilder::AssetBlobBuilder(uint64_t schemaHash) : data(nullptr), size(0), capacity(0) {
+		// Allocate the blob's header
+		size_t headerOffset = Allocate<AssetBlobHeader>();
+
+		AssetBlobHeader* header = Get<AssetBlobHeader>(headerOffset);
+		header->magic = ASSET_BLOB_MAGIC;
+		header->byteOrderMark = ASSET_BLOB_BYTE_ORDER_MARK;
+		header->schemaHash = schemaHash;
+	}
+
+	size_t AssetBlobBuilder::AllocateMemory(size_t size, size_t alignment) {
+		// Check if the alignment is valid
+		if(!alignment || (alignment & (alignment - 1)) || alignment > ASSET_BLOB_ALIGNMENT)
+			throw Exception("Invalid asset blob alignment!");
+
+		// Align the new memory's offset
+		size_t offset = (this->size + alignment - 1) & ~(alignment - 1);
+		size_t newSize = offset + size;
+
+		// Grow the blob's memory if the new memory doesn't fit
+		if(newSize > capacity) {
+			size_t newCapacity = capacity ? capacity : MIN_BLOB_CAPACITY;
+			while(newCapacity < newSize)
+				newCapacity <<= 1;
+
+			char_t* newData = (char_t*)AllocMemory(newCapacity);
+			if(!newData)
+				throw BadAllocException("Failed to allocate asset blob memory!");
+
+			if(data) {
+				memcpy(newData, data, this->size);
+				FreeMemory(data);
+			}
+
+			data = newData;
+			capacity = newCapacity;
+		}
+
+		// Zero the new memory, including the alignment padding
+		memset(data + this->size, 0, newSize - this->size);
+		this->size = newSize;
+
+		return offset;
+	}
+	void AssetBlobBuilder::SetRoot(size_t offset) {
+		// Set the root offset in the blob's header
+		Get<AssetBlobHeader>(0)->rootOffset = (uint64_t)offset;
+	}
+	void AssetBlobBuilder::WriteBlob(AssetOutput& assetOutput) {
+		// Check if the blob starts at an aligned position in the stream, since its offsets and GetAssetBlobRoot rely on the blob's alignment
+		if(assetOutput.GetSize() & (ASSET_BLOB_ALIGNMENT - 1))
+			throw Exception("Asset blobs must be written at a position aligned to ASSET_BLOB_ALIGNMENT!");
+
+		// Set the blob's final size and write it
+		Get<AssetBlobHeader>(0)->size = (uint64_t)size;
+
+		assetOutput.WriteBuffer(size, data);
+	}
+
+	AssetBlobBuilder::~AssetBlobBuilder() {
+		// Free the blob's memory
+		if(data)
+			FreeMemory(data);
+	}
+
+	const void* GetAssetBlobRoot(const void* data, size_t size, uint64_t schemaHash, size_t rootSize) {
+		// Check if the blob's memory is aligned and large enough for its header
+		if(!data || ((size_t)data & (ASSET_BLOB_ALIGNMENT - 1)) || size < sizeof(AssetBlobHeader))
+			return nullptr;
+
+		// Check the blob's header
+		const AssetBlobHeader* header = (const AssetBlobHeader*)data;
+		if(header->magic != ASSET_BLOB_MAGIC || header->byteOrderMark != ASSET_BLOB_BYTE_ORDER_MARK || header->schemaHash != schemaHash)
+			return nullptr;
+		if(header->size > size || header->size < sizeof(AssetBlobHeader))
+			return nullptr;
+
+		// Check if the root object is inside the blob
+		if(header->rootOffset < sizeof(AssetBlobHeader) || header->rootOffset > header->size || rootSize > header->size - header->rootOffset)
+			return nullptr;
+
+		return (const char_t*)data + header->rootOffset;
+	}
+}
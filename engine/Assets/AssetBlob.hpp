@@ -0,0 +1,218 @@
+#pragma once
+
+#include "AssetOutput.hpp"
+
+#include <Core.hpp>
+#include <type_traits>
+
+namespace wfe {
+	class AssetBlobBuilder;
+
+	/// @brief The magic number found at the start of every asset blob.
+	static const uint32_t ASSET_BLOB_MAGIC = 0x424F4C42; // "BLOB"
+	/// @brief A marker written in the byte order of the platform which built the blob. Blobs are little-endian, like every supported platform.
+	static const uint32_t ASSET_BLOB_BYTE_ORDER_MARK = 0x01020304;
+	/// @brief The largest alignment of the objects stored in asset blobs. Asset data always starts at an address aligned to it.
+	static const size_t ASSET_BLOB_ALIGNMENT = 8;
+
+	/// @brief The header found at the start of every asset blob.
+	struct AssetBlobHeader {
+		/// @brief The blob's magic number, which must be ASSET_BLOB_MAGIC.
+		uint32_t magic;
+		/// @brief The blob's byte order mark, which must be ASSET_BLOB_BYTE_ORDER_MARK.
+		uint32_t byteOrderMark;
+		/// @brief The hash of the blob's schema, which must be changed whenever the layout of the blob's objects changes.
+		uint64_t schemaHash;
+		/// @brief The size of the blob, including its header.
+		uint64_t size;
+		/// @brief The offset of the blob's root object, relative to the start of the blob.
+		uint64_t rootOffset;
+	};
+
+	/// @brief A pointer stored inside an asset blob as an offset relative to its own address, so that the blob can be used from any address without a fix-up pass.
+	/// @tparam T The type of the pointed object.
+	template<class T>
+	class BlobPtr {
+	public:
+		/// @brief Gets the pointed object.
+		/// @return A const pointer to the pointed object, or nullptr if the pointer is null.
+		const T* Get() const {
+			if(!offset)
+				return nullptr;
+			return (const T*)((const char_t*)this + offset);
+		}
+		/// @brief Accesses the pointed object.
+		/// @return A const pointer to the pointed object.
+		const T* operator->() const {
+			return Get();
+		}
+		/// @brief Dereferences the pointer.
+		/// @return A const reference to the pointed object.
+		const T& operator*() const {
+			return *Get();
+		}
+		/// @brief Checks if the pointer is null.
+		/// @return True if the pointer isn't null, otherwise false.
+		explicit operator bool8_t() const {
+			return offset != 0;
+		}
+	private:
+		friend AssetBlobBuilder;
+
+		int64_t offset;
+	};
+
+	/// @brief An array stored inside an asset blob, made of a relative pointer to its elements and its size.
+	/// @tparam T The type of the array's elements.
+	template<class T>
+	class BlobArray {
+	public:
+		/// @brief Gets the array's elements.
+		/// @return A const pointer to the array's first element, or nullptr if the array is empty.
+		const T* GetData() const {
+			return data.Get();
+		}
+		/// @brief Gets the array's size.
+		/// @return The number of elements in the array.
+		size_t GetSize() const {
+			return (size_t)size;
+		}
+		/// @brief Checks if the array is empty.
+		/// @return True if the array has no elements, otherwise false.
+		bool8_t IsEmpty() const {
+			return !size;
+		}
+		/// @brief Gets the element at the given index.
+		/// @param index The index of the element.
+		/// @return A const reference to the requested element.
+		const T& operator[](size_t index) const {
+			return data.Get()[index];
+		}
+		/// @brief Gets the array's first element.
+		/// @return A const pointer to the array's first element.
+		const T* begin() const {
+			return data.Get();
+		}
+		/// @brief Gets the end of the array.
+		/// @return A const pointer past the array's last element.
+		const T* end() const {
+			return data.Get() + size;
+		}
+	private:
+		friend AssetBlobBuilder;
+
+		BlobPtr<T> data;
+		uint64_t size;
+	};
+
+	/// @brief Builds an asset blob in memory. Objects are referenced by their offsets, since the blob's memory moves as it grows.
+	class AssetBlobBuilder {
+	public:
+		/// @brief Creates an asset blob builder.
+		/// @param schemaHash The hash of the blob's schema.
+		AssetBlobBuilder(uint64_t schemaHash);
+
+		AssetBlobBuilder() = delete;
+		AssetBlobBuilder(const AssetBlobBuilder&) = delete;
+		AssetBlobBuilder(AssetBlobBuilder&&) noexcept = delete;
+
+		AssetBlobBuilder& operator=(const AssetBlobBuilder&) = delete;
+		AssetBlobBuilder& operator=(AssetBlobBuilder&&) = delete;
+
+		/// @brief Allocates zeroed memory in the blob.
+		/// @param size The size of the memory to allocate.
+		/// @param alignment The alignment of the memory, which must be a power of two no larger than ASSET_BLOB_ALIGNMENT.
+		/// @return The offset of the allocated memory.
+		size_t AllocateMemory(size_t size, size_t alignment);
+		/// @brief Allocates zeroed objects in the blob.
+		/// @tparam T The type of the objects, which must be trivially copyable.
+		/// @param count The number of objects to allocate. Defaulted to 1.
+		/// @return The offset of the first allocated object.
+		template<class T>
+		size_t Allocate(size_t count = 1) {
+			static_assert(std::is_trivially_copyable<T>::value, "Asset blob objects must be trivially copyable!");
+			static_assert(alignof(T) <= ASSET_BLOB_ALIGNMENT, "Asset blob objects can't be aligned to more than ASSET_BLOB_ALIGNMENT!");
+
+			return AllocateMemory(sizeof(T) * count, alignof(T));
+		}
+		/// @brief Copies the given objects to the blob.
+		/// @tparam T The type of the objects, which must be trivially copyable.
+		/// @param objects A pointer to the objects to copy, which must not point inside the blob.
+		/// @param count The number of objects to copy.
+		/// @return The offset of the first copied object.
+		template<class T>
+		size_t Write(const T* objects, size_t count) {
+			size_t offset = Allocate<T>(count);
+			if(count)
+				memcpy(data + offset, objects, sizeof(T) * count);
+
+			return offset;
+		}
+		/// @brief Gets the object at the given offset. The returned pointer is invalidated by the next allocation.
+		/// @tparam T The type of the object.
+		/// @param offset The offset of the object.
+		/// @return A pointer to the requested object.
+		template<class T>
+		T* Get(size_t offset) {
+			return (T*)(data + offset);
+		}
+		/// @brief Points the given blob pointer to the object at the given offset.
+		/// @tparam T The type of the pointed object.
+		/// @param ptr A reference to a blob pointer stored inside the blob.
+		/// @param targetOffset The offset of the pointed object.
+		template<class T>
+		void SetPtr(BlobPtr<T>& ptr, size_t targetOffset) {
+			ptr.offset = (int64_t)targetOffset - (int64_t)((char_t*)&ptr - data);
+		}
+		/// @brief Points the given blob array to the elements at the given offset.
+		/// @tparam T The type of the array's elements.
+		/// @param array A reference to a blob array stored inside the blob.
+		/// @param targetOffset The offset of the array's first element.
+		/// @param size The number of elements in the array.
+		template<class T>
+		void SetArray(BlobArray<T>& array, size_t targetOffset, size_t size) {
+			if(size)
+				SetPtr(array.data, targetOffset);
+			else
+				array.data.offset = 0;
+			array.size = (uint64_t)size;
+		}
+		/// @brief Sets the blob's root object.
+		/// @param offset The offset of the root object.
+		void SetRoot(size_t offset);
+
+		/// @brief Gets the blob's current size.
+		/// @return The size of the blob, including its header.
+		size_t GetSize() const {
+			return size;
+		}
+		/// @brief Writes the finished blob to the given asset output stream. The stream's data must start at an address aligned to ASSET_BLOB_ALIGNMENT, which is true for every asset's data, and the number of bytes written to the stream before the blob must be a multiple of ASSET_BLOB_ALIGNMENT, otherwise an exception is thrown.
+		/// @param assetOutput The asset output stream to write to.
+		void WriteBlob(AssetOutput& assetOutput);
+
+		/// @brief Destroys the asset blob builder.
+		~AssetBlobBuilder();
+	private:
+		char_t* data;
+		size_t size;
+		size_t capacity;
+	};
+
+	/// @brief Gets the root object of the asset blob found in the given memory, after checking its header.
+	/// @param data A pointer to the blob's memory, which must be aligned to ASSET_BLOB_ALIGNMENT.
+	/// @param size The size of the memory.
+	/// @param schemaHash The expected hash of the blob's schema.
+	/// @param rootSize The size of the root object.
+	/// @return A const pointer to the blob's root object, or nullptr if the blob is invalid or has a different schema.
+	const void* GetAssetBlobRoot(const void* data, size_t size, uint64_t schemaHash, size_t rootSize);
+	/// @brief Gets the root object of the asset blob found in the given memory, after checking its header. The blob's objects are used in place, so the memory must outlive them.
+	/// @tparam T The type of the blob's root object.
+	/// @param data A pointer to the blob's memory, which must be aligned to ASSET_BLOB_ALIGNMENT.
+	/// @param size The size of the memory.
+	/// @param schemaHash The expected hash of the blob's schema.
+	/// @return A const pointer to the blob's root object, or nullptr if the blob is invalid or has a different schema.
+	template<class T>
+	const T* GetAssetBlobRoot(const void* data, size_t size, uint64_t schemaHash) {
+		return (const T*)GetAssetBlobRoot(data, size, schemaHash, sizeof(T));
+	}
+}
@@ -0,0 +1,369 @@
+#include "AssetCompression.hpp"
+#include "AssetOutput.hpp"
+
+#include <thread>
+
+namespace wfe {
+	// Structs
+	struct ContainerHeader {
+		uint64_t rawSize;
+		uint32_t chunkSize;
+		uint32_t chunkCount;
+	};
+
+	// Constants
+	static const uint32_t STORED_CHUNK_BIT = 0x80000000;
+	static const size_t HASH_BITS = 12;
+	static const size_t MIN_MATCH = 4;
+	static const size_t MAX_OFFSET = 0xFFFF;
+	static const size_t LAST_LITERALS = 5;
+	static const size_t MATCH_SEARCH_LIMIT = 12;
+
+	// Internal helper functions
+	static uint32_t ReadUInt32(const uint8_t* data) {
+		uint32_t value;
+		memcpy(&value, data, sizeof(uint32_t));
+		return value;
+	}
+	static size_t GetCompressBound(size_t size) {
+		return size + size / 255 + 16;
+	}
+	static uint8_t* WriteLength(uint8_t* output, size_t length) {
+		// Write the length as a sequence of 255 bytes followed by the remainder
+		for(; length >= 255; length -= 255)
+			*output++ = 255;
+		*output++ = (uint8_t)length;
+
+		return output;
+	}
+	static size_t CompressBlock(const uint8_t* input, size_t inputSize, uint8_t* output, size_t outputCapacity) {
+		// Set the positions of every hashed sequence as invalid
+		uint32_t hashTable[1 << HASH_BITS];
+		for(size_t i = 0; i != (1 << HASH_BITS); ++i)
+			hashTable[i] = UINT32_T_MAX;
+
+		const uint8_t* anchor = input;
+		const uint8_t* inputEnd = input + inputSize;
+		uint8_t* outputPos = output;
+		uint8_t* outputEnd = output + outputCapacity;
+
+		// Find matches until the last positions where a match is allowed to start
+		if(inputSize > MATCH_SEARCH_LIMIT) {
+			const uint8_t* matchLimit = inputEnd - MATCH_SEARCH_LIMIT;
+			const uint8_t* matchEnd = inputEnd - LAST_LITERALS;
+
+			for(const uint8_t* inputPos = input; inputPos < matchLimit;) {
+				// Look up and replace the last position with the same hash
+				uint32_t sequence = ReadUInt32(inputPos);
+				uint32_t hash = (sequence * 2654435761U) >> (32 - HASH_BITS);
+				uint32_t reference = hashTable[hash];
+				hashTable[hash] = (uint32_t)(inputPos - input);
+
+				// Move on to the next position if no match was found
+				if(reference == UINT32_T_MAX || (size_t)(inputPos - input) - reference > MAX_OFFSET || ReadUInt32(input + reference) != sequence) {
+					++inputPos;
+					continue;
+				}
+
+				// Extend the match as far as possible
+				const uint8_t* match = input + reference;
+				size_t matchLength = MIN_MATCH;
+				while(inputPos + matchLength < matchEnd && match[matchLength] == inputPos[matchLength])
+					++matchLength;
+
+				// Check if the sequence fits in the output
+				size_t literalLength = (size_t)(inputPos - anchor);
+				if((size_t)(outputEnd - outputPos) < 1 + literalLength + literalLength / 255 + 1 + 2 + (matchLength - MIN_MATCH) / 255 + 1)
+					return 0;
+
+				// Write the sequence's token and literals
+				uint8_t* token = outputPos++;
+				*token = (uint8_t)((literalLength >= 15 ? 15 : literalLength) << 4);
+				if(literalLength >= 15)
+					outputPos = WriteLength(outputPos, literalLength - 15);
+				memcpy(outputPos, anchor, literalLength);
+				outputPos += literalLength;
+
+				// Write the match's offset and length
+				uint16_t offset = (uint16_t)(inputPos - match);
+				memcpy(outputPos, &offset, sizeof(uint16_t));
+				outputPos += sizeof(uint16_t);
+
+				size_t extraLength = matchLength - MIN_MATCH;
+				*token |= (uint8_t)(extraLength >= 15 ? 15 : extraLength);
+				if(extraLength >= 15)
+					outputPos = WriteLength(outputPos, extraLength - 15);
+
+				inputPos += matchLength;
+				anchor = inputPos;
+			}
+		}
+
+		// Write the last literals
+		size_t literalLength = (size_t)(inputEnd - anchor);
+		if((size_t)(outputEnd - outputPos) < 1 + literalLength + literalLength / 255 + 1)
+			return 0;
+
+		*outputPos++ = (uint8_t)((literalLength >= 15 ? 15 : literalLength) << 4);
+		if(literalLength >= 15)
+			outputPos = WriteLength(outputPos, literalLength - 15);
+		memcpy(outputPos, anchor, literalLength);
+		outputPos += literalLength;
+
+		return (size_t)(outputPos - output);
+	}
+	static bool8_t ReadLength(const uint8_t*& input, const uint8_t* inputEnd, size_t& length) {
+		// Add bytes to the length until a byte smaller than 255 is found
+		uint8_t lengthByte;
+		do {
+			if(input == inputEnd)
+				return false;
+			lengthByte = *input++;
+			length += lengthByte;
+		} while(lengthByte == 255);
+
+		return true;
+	}
+	static bool8_t DecompressBlock(const uint8_t* input, size_t inputSize, uint8_t* output, size_t outputSize) {
+		const uint8_t* inputEnd = input + inputSize;
+		uint8_t* outputPos = output;
+		uint8_t* outputEnd = output + outputSize;
+
+		while(true) {
+			// Read the sequence's token
+			if(input == inputEnd)
+				return false;
+			uint8_t token = *input++;
+
+			// Copy the sequence's literals
+			size_t literalLength = token >> 4;
+			if(literalLength == 15 && !ReadLength(input, inputEnd, literalLength))
+				return false;
+			if(literalLength > (size_t)(inputEnd - input) || literalLength > (size_t)(outputEnd - outputPos))
+				return false;
+
+			memcpy(outputPos, input, literalLength);
+			input += literalLength;
+			outputPos += literalLength;
+
+			// Exit the loop if the last sequence was read
+			if(input == inputEnd)
+				break;
+
+			// Read the match's offset and length
+			if((size_t)(inputEnd - input) < sizeof(uint16_t))
+				return false;
+			uint16_t offset;
+			memcpy(&offset, input, sizeof(uint16_t));
+			input += sizeof(uint16_t);
+
+			if(!offset || offset > (size_t)(outputPos - output))
+				return false;
+
+			size_t matchLength = token & 15;
+			if(matchLength == 15 && !ReadLength(input, inputEnd, matchLength))
+				return false;
+			matchLength += MIN_MATCH;
+			if(matchLength > (size_t)(outputEnd - outputPos))
+				return false;
+
+			// Copy the match byte by byte, since it may overlap the output
+			const uint8_t* match = outputPos - offset;
+			for(size_t i = 0; i != matchLength; ++i)
+				outputPos[i] = match[i];
+			outputPos += matchLength;
+		}
+
+		return outputPos == outputEnd;
+	}
+
+	// Public functions
+	void CompressAssetData(const void* data, size_t size, FileOutput& fileOutput) {
+		// Set the container's header
+		ContainerHeader header {
+			.rawSize = (uint64_t)size,
+			.chunkSize = (uint32_t)ASSET_COMPRESSION_CHUNK_SIZE,
+			.chunkCount = (uint32_t)((size + ASSET_COMPRESSION_CHUNK_SIZE - 1) / ASSET_COMPRESSION_CHUNK_SIZE)
+		};
+
+		// Allocate the chunk size array and the compression buffer
+		uint32_t* chunkSizes = nullptr;
+		if(header.chunkCount)
+			chunkSizes = NewArray<uint32_t>(header.chunkCount);
+
+		size_t bufferSize = GetCompressBound(ASSET_COMPRESSION_CHUNK_SIZE);
+		uint8_t* buffer = (uint8_t*)AllocMemory(bufferSize);
+		if(!buffer)
+			throw BadAllocException("Failed to allocate asset compression buffer!");
+
+		// Compress every chunk, storing the chunks which don't get smaller uncompressed
+		AssetOutput chunkOutput;
+		for(size_t i = 0; i != header.chunkCount; ++i) {
+			const uint8_t* chunk = (const uint8_t*)data + i * ASSET_COMPRESSION_CHUNK_SIZE;
+			size_t chunkSize = size - i * ASSET_COMPRESSION_CHUNK_SIZE;
+			if(chunkSize > ASSET_COMPRESSION_CHUNK_SIZE)
+				chunkSize = ASSET_COMPRESSION_CHUNK_SIZE;
+
+			size_t compressedSize = CompressBlock(chunk, chunkSize, buffer, bufferSize);
+			if(compressedSize && compressedSize < chunkSize) {
+				chunkSizes[i] = (uint32_t)compressedSize;
+				chunkOutput.WriteBuffer(compressedSize, buffer);
+			} else {
+				chunkSizes[i] = (uint32_t)chunkSize | STORED_CHUNK_BIT;
+				chunkOutput.WriteBuffer(chunkSize, chunk);
+			}
+		}
+
+		FreeMemory(buffer);
+
+		// Write the container's header, chunk sizes and chunks
+		fileOutput.WriteBuffer(sizeof(ContainerHeader), &header);
+		if(header.chunkCount) {
+			fileOutput.WriteBuffer(sizeof(uint32_t) * header.chunkCount, chunkSizes);
+			DestroyArray(chunkSizes, header.chunkCount);
+		}
+		if(chunkOutput.GetSize())
+			fileOutput.WriteBuffer(chunkOutput.GetSize(), chunkOutput.GetData());
+	}
+	bool8_t GetDecompressedAssetSize(const void* data, size_t size, size_t& rawSize) {
+		// Check if the container's header fits
+		if(size < sizeof(ContainerHeader))
+			return false;
+
+		// Read the container's uncompressed size
+		ContainerHeader header;
+		memcpy(&header, data, sizeof(ContainerHeader));
+		if(header.rawSize > (uint64_t)SIZE_T_MAX)
+			return false;
+
+		rawSize = (size_t)header.rawSize;
+		return true;
+	}
+
+	// Asset decompressor functions
+	AssetDecompressor::AssetDecompressor() : chunkData(nullptr), chunkSizes(nullptr), chunkOffsets(nullptr), chunkCount(0), output(nullptr), outputSize(0), nextChunk(0), finishedChunks(0), failed(0), helperResults(nullptr), helperCount(0) { }
+
+	void* AssetDecompressor::HelperJob(void* args) {
+		// Decompress chunks until none are left
+		AssetDecompressor* decompressor = (AssetDecompressor*)args;
+		decompressor->DecompressChunks();
+
+		return nullptr;
+	}
+	void AssetDecompressor::DecompressChunks() {
+		// Claim and decompress chunks until every chunk was claimed
+		for(size_t index = nextChunk++; index < chunkCount; index = nextChunk++) {
+			// Get the chunk's uncompressed range
+			size_t rawOffset = index * ASSET_COMPRESSION_CHUNK_SIZE;
+			size_t rawSize = outputSize - rawOffset;
+			if(rawSize > ASSET_COMPRESSION_CHUNK_SIZE)
+				rawSize = ASSET_COMPRESSION_CHUNK_SIZE;
+
+			// Copy or decompress the chunk, skipping it if another chunk already failed
+			if(!failed) {
+				const char_t* chunk = chunkData + chunkOffsets[index];
+				if(chunkSizes[index] & STORED_CHUNK_BIT) {
+					if((chunkSizes[index] & ~STORED_CHUNK_BIT) == rawSize) {
+						memcpy(output + rawOffset, chunk, rawSize);
+					} else {
+						failed = 1;
+					}
+				} else if(!DecompressBlock((const uint8_t*)chunk, chunkSizes[index], (uint8_t*)output + rawOffset, rawSize)) {
+					failed = 1;
+				}
+			}
+
+			++finishedChunks;
+		}
+	}
+
+	bool8_t AssetDecompressor::Decompress(const void* data, size_t size, void* output, size_t outputSize, JobManager* jobManager) {
+		// Wait for the helpers of the previous decompression, since they reference the decompressor
+		WaitForHelpers();
+
+		// Read and validate the container's header
+		if(size < sizeof(ContainerHeader))
+			return false;
+
+		ContainerHeader header;
+		memcpy(&header, data, sizeof(ContainerHeader));
+
+		if(header.rawSize != (uint64_t)outputSize || header.chunkSize != ASSET_COMPRESSION_CHUNK_SIZE)
+			return false;
+		if(header.chunkCount != (outputSize + ASSET_COMPRESSION_CHUNK_SIZE - 1) / ASSET_COMPRESSION_CHUNK_SIZE)
+			return false;
+		if(header.chunkCount > (size - sizeof(ContainerHeader)) / sizeof(uint32_t))
+			return false;
+
+		// Exit the function if there is nothing to decompress
+		if(!header.chunkCount)
+			return true;
+
+		// Calculate every chunk's offset, checking that every chunk is inside the container
+		chunkSizes = (const uint32_t*)((const char_t*)data + sizeof(ContainerHeader));
+		chunkData = (const char_t*)(chunkSizes + header.chunkCount);
+		chunkCount = header.chunkCount;
+		chunkOffsets = NewArray<size_t>(chunkCount);
+
+		size_t dataSize = size - sizeof(ContainerHeader) - sizeof(uint32_t) * chunkCount;
+		size_t chunkOffset = 0;
+		for(size_t i = 0; i != chunkCount; ++i) {
+			size_t chunkSize = chunkSizes[i] & ~STORED_CHUNK_BIT;
+			if(chunkSize > dataSize - chunkOffset) {
+				DestroyArray(chunkOffsets, chunkCount);
+				chunkOffsets = nullptr;
+				return false;
+			}
+
+			chunkOffsets[i] = chunkOffset;
+			chunkOffset += chunkSize;
+		}
+
+		// Set the decompression's state
+		this->output = (char_t*)output;
+		this->outputSize = outputSize;
+		nextChunk = 0;
+		finishedChunks = 0;
+		failed = 0;
+
+		// Submit helper jobs for the other chunks
+		if(jobManager && chunkCount > 1) {
+			helperCount = chunkCount - 1;
+			if(helperCount > MAX_HELPER_JOBS)
+				helperCount = MAX_HELPER_JOBS;
+
+			helperResults = NewArray<JobManager::Result>(helperCount);
+			for(size_t i = 0; i != helperCount; ++i)
+				jobManager->SubmitJob(HelperJob, this, helperResults[i]);
+		}
+
+		// Decompress chunks on the calling thread as well, then wait for the chunks claimed by running helpers
+		DecompressChunks();
+		while(finishedChunks != chunkCount)
+			std::this_thread::yield();
+
+		// Free the chunk offset array; helpers which start later won't claim any chunk
+		DestroyArray(chunkOffsets, chunkCount);
+		chunkOffsets = nullptr;
+
+		return !failed;
+	}
+	void AssetDecompressor::WaitForHelpers() {
+		// Exit the function if no helpers were submitted
+		if(!helperResults)
+			return;
+
+		// Wait for every helper and free the result array
+		for(size_t i = 0; i != helperCount; ++i)
+			helperResults[i].WaitForResult();
+
+		DestroyArray(helperResults, helperCount);
+		helperResults = nullptr;
+		helperCount = 0;
+	}
+
+	AssetDecompressor::~AssetDecompressor() {
+		// Wait for every helper, since they reference the decompressor
+		WaitForHelpers();
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <Core.hpp>
+
+namespace wfe {
+	/// @brief The size of the uncompressed chunks asset data is split into. Every chunk is compressed independently, so chunks can be decompressed in parallel.
+	static const size_t ASSET_COMPRESSION_CHUNK_SIZE = 0x40000;
+
+	/// @brief Compresses the given asset data into a chunked container and writes it to the given file output stream.
+	/// @param data A pointer to the asset data to compress.
+	/// @param size The size of the asset data.
+	/// @param fileOutput The file output stream to write the compressed container to.
+	void CompressAssetData(const void* data, size_t size, FileOutput& fileOutput);
+	/// @brief Gets the uncompressed size of the asset data in the given compressed container.
+	/// @param data A pointer to the compressed container.
+	/// @param size The size of the compressed container.
+	/// @param rawSize A reference to the variable in which the uncompressed size will be written.
+	/// @return True if the container's header is valid, otherwise false.
+	bool8_t GetDecompressedAssetSize(const void* data, size_t size, size_t& rawSize);
+
+	/// @brief Decompresses chunked asset data, sharing the chunks with helper jobs when a job manager is given.
+	class AssetDecompressor {
+	public:
+		/// @brief The maximum number of helper jobs submitted for one decompression.
+		static const size_t MAX_HELPER_JOBS = 7;
+
+		/// @brief Creates an asset decompressor.
+		AssetDecompressor();
+		AssetDecompressor(const AssetDecompressor&) = delete;
+		AssetDecompressor(AssetDecompressor&&) noexcept = delete;
+
+		AssetDecompressor& operator=(const AssetDecompressor&) = delete;
+		AssetDecompressor& operator=(AssetDecompressor&&) = delete;
+
+		/// @brief Decompresses the given compressed container. The calling thread decompresses chunks as well and never waits on a helper job which hasn't started, so this is safe to call from inside a job.
+		/// @param data A pointer to the compressed container.
+		/// @param size The size of the compressed container.
+		/// @param output A pointer to the buffer to decompress to, which must have the container's uncompressed size.
+		/// @param outputSize The size of the output buffer.
+		/// @param jobManager The job manager to submit helper jobs to, or nullptr to decompress every chunk on the calling thread.
+		/// @return True if the container was decompressed successfully, otherwise false.
+		bool8_t Decompress(const void* data, size_t size, void* output, size_t outputSize, JobManager* jobManager);
+		/// @brief Waits for every helper job submitted by the last decompression to exit.
+		void WaitForHelpers();
+
+		/// @brief Waits for every helper job to exit and destroys the asset decompressor.
+		~AssetDecompressor();
+	private:
+		static void* HelperJob(void* args);
+
+		void DecompressChunks();
+
+		const char_t* chunkData;
+		const uint32_t* chunkSizes;
+		size_t* chunkOffsets;
+		size_t chunkCount;
+		char_t* output;
+		size_t outputSize;
+
+		atomic_size_t nextChunk;
+		atomic_size_t finishedChunks;
+		atomic_int32_t failed;
+
+		JobManager::Result* helperResults;
+		size_t helperCount;
+	};
+}
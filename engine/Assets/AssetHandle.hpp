@@ -0,0 +1,52 @@
+#pragma once
+
+#include <Core.hpp>
+
+namespace wfe {
+	/// @brief A generational handle to an asset, which stays safe to resolve after the asset is destroyed. Resolving a handle takes a slot array index and a generation compare, without any lookup or lock.
+	/// @tparam T The type of the referenced asset.
+	template<class T>
+	class AssetHandle {
+	public:
+		/// @brief Creates a null handle, which never resolves to an asset.
+		AssetHandle() : index(0), generation(0) { }
+		/// @brief Creates a handle to the given slot. Handles are created by the asset manager.
+		/// @param index The index of the asset's slot.
+		/// @param generation The generation of the asset's slot when the handle was created.
+		AssetHandle(uint32_t index, uint32_t generation) : index(index), generation(generation) { }
+		AssetHandle(const AssetHandle&) = default;
+		AssetHandle(AssetHandle&&) noexcept = default;
+
+		AssetHandle& operator=(const AssetHandle&) = default;
+		AssetHandle& operator=(AssetHandle&&) = default;
+
+		/// @brief Gets the index of the asset's slot.
+		/// @return The handle's slot index.
+		uint32_t GetIndex() const {
+			return index;
+		}
+		/// @brief Gets the generation of the asset's slot when the handle was created.
+		/// @return The handle's generation.
+		uint32_t GetGeneration() const {
+			return generation;
+		}
+		/// @brief Checks if the handle is null. A handle which isn't null might still be stale.
+		/// @return True if the handle was never set to an asset, otherwise false.
+		bool8_t IsNull() const {
+			return !generation;
+		}
+
+		bool8_t operator==(const AssetHandle& other) const {
+			return index == other.index && generation == other.generation;
+		}
+		bool8_t operator!=(const AssetHandle& other) const {
+			return index != other.index || generation != other.generation;
+		}
+
+		/// @brief Destroys the handle.
+		~AssetHandle() = default;
+	private:
+		uint32_t index;
+		uint32_t generation;
+	};
+}
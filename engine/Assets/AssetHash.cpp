@@ -0,0 +1,87 @@
+#include "AssetHash.hpp"
+
+namespace wfe {
+	// Constants
+	static const uint64_t PRIME1 = 0x9E3779B185EBCA87;
+	static const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4F;
+	static const uint64_t PRIME3 = 0x165667B19E3779F9;
+	static const uint64_t PRIME4 = 0x85EBCA77C2B2AE63;
+	static const uint64_t PRIME5 = 0x27D4EB2F165667C5;
+
+	// Internal helper functions
+	static uint64_t RotateLeft(uint64_t value, uint32_t count) {
+		return (value << count) | (value >> (64 - count));
+	}
+	static uint64_t Read64(const uint8_t* data) {
+		uint64_t value;
+		memcpy(&value, data, sizeof(uint64_t));
+		return value;
+	}
+	static uint32_t Read32(const uint8_t* data) {
+		uint32_t value;
+		memcpy(&value, data, sizeof(uint32_t));
+		return value;
+	}
+	static uint64_t Round(uint64_t accumulator, uint64_t input) {
+		accumulator += input * PRIME2;
+		accumulator = RotateLeft(accumulator, 31);
+		return accumulator * PRIME1;
+	}
+	static uint64_t MergeRound(uint64_t accumulator, uint64_t value) {
+		accumulator ^= Round(0, value);
+		return accumulator * PRIME1 + PRIME4;
+	}
+
+	// Public functions
+	uint64_t HashAssetData(const void* data, size_t size, uint64_t seed) {
+		const uint8_t* input = (const uint8_t*)data;
+		const uint8_t* inputEnd = input + size;
+		uint64_t hash;
+
+		if(size >= 32) {
+			// Process the data in 32 byte stripes using four accumulators
+			uint64_t accumulators[4] = { seed + PRIME1 + PRIME2, seed + PRIME2, seed, seed - PRIME1 };
+			const uint8_t* stripeLimit = inputEnd - 32;
+
+			do {
+				accumulators[0] = Round(accumulators[0], Read64(input));
+				accumulators[1] = Round(accumulators[1], Read64(input + 8));
+				accumulators[2] = Round(accumulators[2], Read64(input + 16));
+				accumulators[3] = Round(accumulators[3], Read64(input + 24));
+				input += 32;
+			} while(input <= stripeLimit);
+
+			// Merge the accumulators
+			hash = RotateLeft(accumulators[0], 1) + RotateLeft(accumulators[1], 7) + RotateLeft(accumulators[2], 12) + RotateLeft(accumulators[3], 18);
+			for(size_t i = 0; i != 4; ++i)
+				hash = MergeRound(hash, accumulators[i]);
+		} else {
+			hash = seed + PRIME5;
+		}
+
+		hash += (uint64_t)size;
+
+		// Process the remaining bytes
+		for(; input + 8 <= inputEnd; input += 8)
+			hash = RotateLeft(hash ^ Round(0, Read64(input)), 27) * PRIME1 + PRIME4;
+		if(input + 4 <= inputEnd) {
+			hash = RotateLeft(hash ^ ((uint64_t)Read32(input) * PRIME1), 23) * PRIME2 + PRIME3;
+			input += 4;
+		}
+		for(; input != inputEnd; ++input)
+			hash = RotateLeft(hash ^ (*input * PRIME5), 11) * PRIME1;
+
+		// Avalanche the final hash
+		hash ^= hash >> 33;
+		hash *= PRIME2;
+		hash ^= hash >> 29;
+		hash *= PRIME3;
+		hash ^= hash >> 32;
+
+		return hash;
+	}
+	uint64_t CombineAssetHash(uint64_t hash, uint64_t value) {
+		// Mix the value into the hash
+		return HashAssetData(&value, sizeof(uint64_t), hash);
+	}
+}
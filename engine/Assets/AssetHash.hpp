@@ -0,0 +1,17 @@
+#pragma once
+
+#include <Core.hpp>
+
+namespace wfe {
+	/// @brief Hashes the given data using the 64-bit xxHash algorithm, which is fast enough to hash entire source files.
+	/// @param data A pointer to the data to hash.
+	/// @param size The size of the data to hash.
+	/// @param seed The seed of the hash. Defaulted to 0.
+	/// @return The 64-bit hash of the given data.
+	uint64_t HashAssetData(const void* data, size_t size, uint64_t seed = 0);
+	/// @brief Combines the given hash with another value.
+	/// @param hash The hash to combine.
+	/// @param value The value to combine the hash with.
+	/// @return The combined hash.
+	uint64_t CombineAssetHash(uint64_t hash, uint64_t value);
+}
@@ -0,0 +1,187 @@
+#include "AssetIDRegistry.hpp"
+
+#include <algorithm>
+
+namespace wfe {
+	// Internal helper functions
+	static bool8_t ContainsSortedID(const uint64_t* ids, size_t count, uint64_t id) {
+		// Binary search the sorted IDs for the given ID
+		size_t left = 0, right = count;
+		while(left < right) {
+			size_t middle = (left + right) >> 1;
+			if(ids[middle] < id) {
+				left = middle + 1;
+			} else {
+				right = middle;
+			}
+		}
+
+		return left != count && ids[left] == id;
+	}
+
+	// Public functions
+	AssetIDRegistry::AssetIDRegistry(const string& filePath, const AssetTable* assets) : filePath(filePath), assets(assets), mappedFile(nullptr), sortedIDs(nullptr), sortedCount(0), compactOnSave(false), fallbackID(0), nextID(0) {
+		// Map the registry file and allocate new IDs after the largest registered ID
+		InternalMapFile();
+
+		if(sortedCount)
+			MarkIDUsed(sortedIDs[sortedCount - 1]);
+		if(!journalIDs.empty())
+			MarkIDUsed(journalIDs.back());
+	}
+
+	uint64_t AssetIDRegistry::AllocateID() {
+		// Take the next ID, stopping before the values reserved by the asset table
+		uint64_t id = nextID.load();
+		while(id < AssetTable::ERASED_KEY && !nextID.compare_exchange_weak(id, id + 1));
+		if(id < AssetTable::ERASED_KEY)
+			return id;
+
+		// Every ID after the largest used ID was taken, so search for an unused ID from the start
+		mutex.Lock();
+
+		while(fallbackID < AssetTable::ERASED_KEY && (InternalIsRegistered(fallbackID) || assets->Contains(fallbackID)))
+			++fallbackID;
+		if(fallbackID >= AssetTable::ERASED_KEY) {
+			mutex.Unlock();
+			throw Exception("Ran out of asset IDs!");
+		}
+		id = fallbackID++;
+
+		mutex.Unlock();
+
+		return id;
+	}
+	void AssetIDRegistry::MarkIDUsed(uint64_t id) {
+		// Clamp the ID to the values which can be allocated
+		if(id >= AssetTable::ERASED_KEY)
+			id = AssetTable::ERASED_KEY - 1;
+
+		// Raise the next ID past the given ID, unless it is already larger
+		uint64_t currentNextID = nextID.load();
+		while(currentNextID <= id && !nextID.compare_exchange_weak(currentNextID, id + 1));
+	}
+	bool8_t AssetIDRegistry::IsRegistered(uint64_t id) const {
+		mutex.Lock();
+		bool8_t registered = InternalIsRegistered(id);
+		mutex.Unlock();
+
+		return registered;
+	}
+	void AssetIDRegistry::Save(const vector<uint64_t>& ids) {
+		mutex.Lock();
+
+		// Get the IDs which aren't registered yet, without duplicates
+		vector<uint64_t> newIDs;
+		for(uint64_t id : ids)
+			if(!InternalIsRegistered(id))
+				newIDs.push_back(id);
+
+		std::sort(newIDs.begin(), newIDs.end());
+		newIDs.erase(std::unique(newIDs.begin(), newIDs.end()), newIDs.end());
+
+		// Exit the function if there is nothing to save
+		if(newIDs.empty() && !compactOnSave) {
+			mutex.Unlock();
+			return;
+		}
+
+		// Add the new IDs to the in-memory journal
+		size_t journalSize = journalIDs.size();
+		journalIDs.insert(journalIDs.end(), newIDs.begin(), newIDs.end());
+		std::inplace_merge(journalIDs.begin(), journalIDs.begin() + journalSize, journalIDs.end());
+
+		if(compactOnSave || !mappedFile || journalIDs.size() >= MAX_JOURNAL_SIZE) {
+			// Rewrite the registry as a single sorted array
+			InternalCompact();
+		} else {
+			// Append the new IDs to the registry file's journal
+			FileOutput fileOutput(filePath, (FileOutput::StreamType)(FileOutput::STREAM_TYPE_BINARY | FileOutput::STREAM_TYPE_APPEND));
+			fileOutput.WriteBuffer(sizeof(uint64_t) * newIDs.size(), newIDs.data());
+			fileOutput.Close();
+		}
+
+		mutex.Unlock();
+	}
+
+	AssetIDRegistry::~AssetIDRegistry() {
+		// Unmap the registry file
+		if(mappedFile)
+			DestroyObject(mappedFile);
+	}
+
+	// Private functions
+	void AssetIDRegistry::InternalMapFile() {
+		// Map the registry file
+		mappedFile = NewObject<MappedFile>(filePath);
+		if(!mappedFile->IsOpen()) {
+			// Write a new registry file once the first ID is saved
+			DestroyObject(mappedFile);
+			mappedFile = nullptr;
+			return;
+		}
+
+		const char_t* data = (const char_t*)mappedFile->GetData();
+		size_t idCount = mappedFile->GetSize() / sizeof(uint64_t);
+		const uint64_t* ids = (const uint64_t*)data;
+
+		// Use the registry's sorted array, if the file has a valid header
+		const RegistryHeader* header = (const RegistryHeader*)data;
+		if(mappedFile->GetSize() >= sizeof(RegistryHeader) && header->magic == REGISTRY_MAGIC && header->sortedCount <= idCount - sizeof(RegistryHeader) / sizeof(uint64_t)) {
+			sortedIDs = ids + sizeof(RegistryHeader) / sizeof(uint64_t);
+			sortedCount = (size_t)header->sortedCount;
+		} else {
+			// Convert files without a header, which only contain appended IDs, on the next save
+			sortedIDs = nullptr;
+			sortedCount = 0;
+			compactOnSave = true;
+		}
+
+		// Load the journal following the sorted array into memory, sorted
+		const uint64_t* journal = sortedIDs ? sortedIDs + sortedCount : ids;
+		size_t journalCount = idCount - (size_t)(journal - ids);
+
+		journalIDs.assign(journal, journal + journalCount);
+		std::sort(journalIDs.begin(), journalIDs.end());
+		journalIDs.erase(std::unique(journalIDs.begin(), journalIDs.end()), journalIDs.end());
+
+		// Rewrite the file on the next save if its journal is too large
+		if(journalCount >= MAX_JOURNAL_SIZE)
+			compactOnSave = true;
+	}
+	bool8_t AssetIDRegistry::InternalIsRegistered(uint64_t id) const {
+		// Search the mapped sorted array and the in-memory journal
+		return ContainsSortedID(sortedIDs, sortedCount, id) || ContainsSortedID(journalIDs.data(), journalIDs.size(), id);
+	}
+	void AssetIDRegistry::InternalCompact() {
+		// Merge the sorted array and the journal
+		vector<uint64_t> mergedIDs(sortedCount + journalIDs.size());
+		auto mergedEnd = std::set_union(sortedIDs, sortedIDs + sortedCount, journalIDs.begin(), journalIDs.end(), mergedIDs.begin());
+		mergedIDs.resize((size_t)(mergedEnd - mergedIDs.begin()));
+
+		// Unmap the old registry file, since it will be overwritten
+		if(mappedFile) {
+			DestroyObject(mappedFile);
+			mappedFile = nullptr;
+		}
+		sortedIDs = nullptr;
+		sortedCount = 0;
+		journalIDs.clear();
+
+		// Write the new registry file
+		RegistryHeader header {
+			.magic = REGISTRY_MAGIC,
+			.sortedCount = (uint64_t)mergedIDs.size()
+		};
+
+		FileOutput fileOutput(filePath, FileOutput::STREAM_TYPE_BINARY);
+		fileOutput.WriteBuffer(sizeof(RegistryHeader), &header);
+		if(!mergedIDs.empty())
+			fileOutput.WriteBuffer(sizeof(uint64_t) * mergedIDs.size(), mergedIDs.data());
+		fileOutput.Close();
+
+		// Map the new registry file
+		compactOnSave = false;
+		InternalMapFile();
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "AssetTable.hpp"
+#include "Platform/MappedFile.hpp"
+
+#include <Core.hpp>
+
+namespace wfe {
+	/// @brief Allocates unique asset IDs and keeps track of every ID used by the asset directory in a persistent registry file. The registry stores a sorted ID array, which is mapped and binary searched, followed by a short journal of newer IDs.
+	class AssetIDRegistry {
+	public:
+		/// @brief The magic value at the start of every registry file.
+		static const uint64_t REGISTRY_MAGIC = 0x5344494554454657;
+		/// @brief The journal size at which the registry is rewritten as a single sorted array on the next save.
+		static const size_t MAX_JOURNAL_SIZE = 0x1000;
+
+		/// @brief Opens the given registry file.
+		/// @param filePath The path of the registry file, which doesn't need to exist.
+		/// @param assets The asset table whose IDs are checked if the IDs after the largest registered ID run out.
+		AssetIDRegistry(const string& filePath, const AssetTable* assets);
+
+		AssetIDRegistry() = delete;
+		AssetIDRegistry(const AssetIDRegistry&) = delete;
+		AssetIDRegistry(AssetIDRegistry&&) noexcept = delete;
+
+		AssetIDRegistry& operator=(const AssetIDRegistry&) = delete;
+		AssetIDRegistry& operator=(AssetIDRegistry&&) = delete;
+
+		/// @brief Allocates a new ID, larger than every registered or used ID, without taking any lock.
+		/// @return The allocated ID.
+		uint64_t AllocateID();
+		/// @brief Marks the given ID, used by an existing asset, so that it is never allocated. Doesn't take any lock.
+		/// @param id The used ID.
+		void MarkIDUsed(uint64_t id);
+		/// @brief Checks if the given ID is in the registry.
+		/// @param id The ID to check.
+		/// @return True if the ID is registered, otherwise false.
+		bool8_t IsRegistered(uint64_t id) const;
+		/// @brief Adds the given IDs to the registry file, rewriting the file if its journal grew too large.
+		/// @param ids The IDs to save, which may include registered IDs.
+		void Save(const vector<uint64_t>& ids);
+		/// @brief Gets the total time threads spent waiting for the registry's lock.
+		/// @return The total wait time, in nanoseconds.
+		uint64_t GetLockWaitTime() const {
+			return mutex.GetWaitTime();
+		}
+
+		/// @brief Destroys the asset ID registry.
+		~AssetIDRegistry();
+	private:
+		struct RegistryHeader {
+			uint64_t magic;
+			uint64_t sortedCount;
+		};
+
+		void InternalMapFile();
+		bool8_t InternalIsRegistered(uint64_t id) const;
+		void InternalCompact();
+
+		string filePath;
+		const AssetTable* assets;
+
+		MappedFile* mappedFile;
+		const uint64_t* sortedIDs;
+		size_t sortedCount;
+		vector<uint64_t> journalIDs;
+		bool8_t compactOnSave;
+
+		AssetMutex mutex;
+		uint64_t fallbackID;
+		atomic_uint64_t nextID;
+	};
+}
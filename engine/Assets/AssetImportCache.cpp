@@ -0,0 +1,99 @@
+#include "AssetImportCache.hpp"
+#include "AssetHash.hpp"
+#include "Platform/Directory.hpp"
+#include "Platform/MappedFile.hpp"
+
+namespace wfe {
+	// Structs
+	struct EntryHeader {
+		uint64_t magic;
+		uint64_t key;
+		uint64_t dependencyCount;
+		uint64_t dataSize;
+	};
+
+	// Constants
+	static const char_t HEX_DIGITS[] = "0123456789abcdef";
+
+	// Public static functions
+	bool8_t AssetImportCache::GetKey(const string& sourcePath, const char_t* importerName, uint32_t importerVersion, uint64_t importSettingsHash, uint64_t& key) {
+		// Map the source file
+		MappedFile sourceFile(sourcePath);
+		if(!sourceFile.IsOpen())
+			return false;
+
+		// Hash the source file's contents and combine the hash with the importer's info
+		key = HashAssetData(sourceFile.GetData(), sourceFile.GetSize());
+		key = CombineAssetHash(key, HashAssetData(importerName, strlen(importerName)));
+		key = CombineAssetHash(key, (uint64_t)importerVersion);
+		key = CombineAssetHash(key, importSettingsHash);
+
+		return true;
+	}
+	bool8_t AssetImportCache::ReadEntry(const void* entryData, size_t entrySize, uint64_t key, vector<uint64_t>& dependencies, const void*& data, size_t& dataSize) {
+		// Read and validate the entry's header
+		if(entrySize < sizeof(EntryHeader))
+			return false;
+
+		EntryHeader header;
+		memcpy(&header, entryData, sizeof(EntryHeader));
+
+		if(header.magic != ENTRY_MAGIC || header.key != key)
+			return false;
+		if(header.dependencyCount > (entrySize - sizeof(EntryHeader)) / sizeof(uint64_t))
+			return false;
+		
+		size_t dependenciesSize = sizeof(uint64_t) * (size_t)header.dependencyCount;
+		if(header.dataSize != entrySize - sizeof(EntryHeader) - dependenciesSize)
+			return false;
+
+		// Read the entry's dependencies and get its data
+		const char_t* entryDependencies = (const char_t*)entryData + sizeof(EntryHeader);
+		dependencies.resize((size_t)header.dependencyCount);
+		if(dependenciesSize)
+			memcpy(dependencies.data(), entryDependencies, dependenciesSize);
+
+		data = entryDependencies + dependenciesSize;
+		dataSize = (size_t)header.dataSize;
+
+		return true;
+	}
+
+	// Public functions
+	AssetImportCache::AssetImportCache(const string& cacheDir) : cacheDir(cacheDir) { }
+
+	string AssetImportCache::GetEntryPath(uint64_t key) const {
+		// Write the key as a hex file name
+		char_t fileName[17];
+		for(size_t i = 0; i != 16; ++i)
+			fileName[i] = HEX_DIGITS[(key >> ((15 - i) << 2)) & 0xF];
+		fileName[16] = 0;
+
+		return cacheDir + fileName + ".wfeimport";
+	}
+	void AssetImportCache::WriteEntry(uint64_t key, const vector<uint64_t>& dependencies, const AssetOutput& assetOutput) {
+		// Create the cache directory and open the entry's file; failing to cache an import isn't an error
+		if(!MakeDirectory(cacheDir))
+			return;
+
+		FileOutput fileOutput(GetEntryPath(key), FileOutput::STREAM_TYPE_BINARY);
+		if(!fileOutput.IsOpen())
+			return;
+		
+		// Write the entry's header, dependencies and data
+		EntryHeader header {
+			.magic = ENTRY_MAGIC,
+			.key = key,
+			.dependencyCount = (uint64_t)dependencies.size(),
+			.dataSize = (uint64_t)assetOutput.GetSize()
+		};
+
+		fileOutput.WriteBuffer(sizeof(EntryHeader), &header);
+		if(!dependencies.empty())
+			fileOutput.WriteBuffer(sizeof(uint64_t) * dependencies.size(), dependencies.data());
+		if(assetOutput.GetSize())
+			fileOutput.WriteBuffer(assetOutput.GetSize(), assetOutput.GetData());
+
+		fileOutput.Close();
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "AssetOutput.hpp"
+
+#include <Core.hpp>
+
+namespace wfe {
+	/// @brief A cache of imported asset data, keyed by the hash of the source file's contents, the importer's version and its import settings.
+	class AssetImportCache {
+	public:
+		/// @brief The magic number found at the start of every import cache entry.
+		static const uint64_t ENTRY_MAGIC = 0x0054524F504D4957; // "WIMPORT\0"
+
+		/// @brief Creates an import cache stored in the given directory.
+		/// @param cacheDir The directory the cache entries are stored in. The directory will be created when the first entry is written.
+		AssetImportCache(const string& cacheDir);
+
+		AssetImportCache() = delete;
+		AssetImportCache(const AssetImportCache&) = delete;
+		AssetImportCache(AssetImportCache&&) noexcept = delete;
+
+		AssetImportCache& operator=(const AssetImportCache&) = delete;
+		AssetImportCache& operator=(AssetImportCache&&) = delete;
+
+		/// @brief Gets the cache's directory.
+		/// @return The directory the cache entries are stored in.
+		const string& GetCacheDir() const {
+			return cacheDir;
+		}
+
+		/// @brief Calculates the cache key of an import.
+		/// @param sourcePath The path of the imported source file.
+		/// @param importerName A unique name of the importer.
+		/// @param importerVersion The version of the importer.
+		/// @param importSettingsHash The hash of the import settings.
+		/// @param key A reference to the variable in which the key will be written.
+		/// @return True if the source file could be read and the key was calculated, otherwise false.
+		static bool8_t GetKey(const string& sourcePath, const char_t* importerName, uint32_t importerVersion, uint64_t importSettingsHash, uint64_t& key);
+		/// @brief Gets the path of the cache entry with the given key.
+		/// @param key The key of the entry.
+		/// @return The path of the entry's file.
+		string GetEntryPath(uint64_t key) const;
+
+		/// @brief Reads a cache entry from its mapped file.
+		/// @param entryData A pointer to the entry's mapped contents.
+		/// @param entrySize The size of the entry.
+		/// @param key The key the entry must have.
+		/// @param dependencies A reference to the vector in which the imported asset's dependencies will be written.
+		/// @param data A reference to the variable in which a pointer to the imported asset's data will be written.
+		/// @param dataSize A reference to the variable in which the size of the imported asset's data will be written.
+		/// @return True if the entry is valid and has the given key, otherwise false.
+		static bool8_t ReadEntry(const void* entryData, size_t entrySize, uint64_t key, vector<uint64_t>& dependencies, const void*& data, size_t& dataSize);
+		/// @brief Writes a cache entry.
+		/// @param key The key of the entry.
+		/// @param dependencies The imported asset's dependencies.
+		/// @param assetOutput The asset output stream containing the imported asset's data.
+		void WriteEntry(uint64_t key, const vector<uint64_t>& dependencies, const AssetOutput& assetOutput);
+
+		/// @brief Destroys the import cache.
+		~AssetImportCache() = default;
+	private:
+		string cacheDir;
+	};
+}
@@ -0,0 +1,121 @@
+#include "AssetInput.hpp"
+#include "AssetTelemetry.hpp"
+
+namespace wfe {
+	// Public functions
+	AssetInput::AssetInput(FileInput* fileInput, size_t offset) : fileInput(fileInput), data(nullptr), ownedData(nullptr), offset(offset), pos(0), readTime(nullptr), failed(false) {
+		// Set the size of the asset's data
+		size = (size_t)fileInput->GetSize() - offset;
+
+		// Move the file input stream to the start of the asset's data
+		fileInput->SetPos(offset, FileInput::SET_POS_RELATIVE_BEGIN);
+	}
+	AssetInput::AssetInput(const void* data, size_t size) : fileInput(nullptr), data(data), ownedData(nullptr), offset(0), size(size), pos(0), readTime(nullptr), failed(false) { }
+
+	AssetInput& AssetInput::ReadBuffer(size_t size, void* buffer) {
+		// Fail the stream if the read goes past the end of the asset's data
+		if(failed || size > this->size - pos) {
+			failed = true;
+			memset(buffer, 0, size);
+			return *this;
+		}
+
+		// Read from the stream's backing memory or file
+		if(data) {
+			memcpy(buffer, (const char_t*)data + pos, size);
+		} else if(readTime) {
+			uint64_t startTime = AssetTelemetry::GetTime();
+			fileInput->ReadBuffer(size, buffer);
+			*readTime += AssetTelemetry::GetTime() - startTime;
+		} else {
+			fileInput->ReadBuffer(size, buffer);
+		}
+		pos += size;
+
+		return *this;
+	}
+	AssetInput& AssetInput::SetPos(size_t pos) {
+		// Fail the stream if the new position is past the end of the asset's data
+		if(pos > size) {
+			failed = true;
+			return *this;
+		}
+
+		// Move the file input stream, if the stream is backed by a file
+		if(!data)
+			fileInput->SetPos(offset + pos, FileInput::SET_POS_RELATIVE_BEGIN);
+		this->pos = pos;
+
+		return *this;
+	}
+	bool8_t AssetInput::Decompress(AssetDecompressor& decompressor, JobManager* jobManager) {
+		// Exit the function if the stream already failed
+		if(failed)
+			return false;
+
+		// Get the compressed container, reading it into memory if the stream is backed by a file
+		size_t compressedSize = size - pos;
+		const char_t* compressedData;
+		char_t* readData = nullptr;
+
+		if(data) {
+			compressedData = (const char_t*)data + pos;
+		} else {
+			readData = (char_t*)AllocMemory(compressedSize ? compressedSize : 1);
+			if(!readData)
+				throw BadAllocException("Failed to allocate compressed asset memory!");
+			ReadBuffer(compressedSize, readData);
+			compressedData = readData;
+
+			if(failed) {
+				FreeMemory(readData);
+				return false;
+			}
+		}
+
+		// Allocate the decompressed data's memory
+		size_t rawSize;
+		bool8_t result = GetDecompressedAssetSize(compressedData, compressedSize, rawSize);
+		char_t* rawData = nullptr;
+		if(result) {
+			rawData = (char_t*)AllocMemory(rawSize ? rawSize : 1);
+			if(!rawData) {
+				if(readData)
+					FreeMemory(readData);
+				throw BadAllocException("Failed to allocate decompressed asset memory!");
+			}
+
+			// Decompress the container
+			result = decompressor.Decompress(compressedData, compressedSize, rawData, rawSize, jobManager);
+		}
+
+		// Free the read compressed data
+		if(readData)
+			FreeMemory(readData);
+
+		if(!result) {
+			if(rawData)
+				FreeMemory(rawData);
+			return false;
+		}
+
+		// Make the stream read from the decompressed data
+		if(ownedData)
+			FreeMemory(ownedData);
+
+		fileInput = nullptr;
+		data = rawData;
+		ownedData = rawData;
+		offset = 0;
+		size = rawSize;
+		pos = 0;
+
+		return true;
+	}
+
+	AssetInput::~AssetInput() {
+		// Free the decompressed data, if the stream owns it
+		if(ownedData)
+			FreeMemory(ownedData);
+	}
+}
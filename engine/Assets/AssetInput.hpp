@@ -0,0 +1,102 @@
+#pragma once
+
+#include "AssetCompression.hpp"
+
+#include <Core.hpp>
+
+namespace wfe {
+	/// @brief An input stream for an asset's data, backed either by a file input stream or by a block of memory.
+	class AssetInput {
+	public:
+		/// @brief Creates an asset input stream which reads from the given file input stream.
+		/// @param fileInput The file input stream to read from.
+		/// @param offset The offset in the file at which the asset's data starts.
+		AssetInput(FileInput* fileInput, size_t offset);
+		/// @brief Creates an asset input stream which reads directly from the given memory, without copying it.
+		/// @param data A pointer to the start of the asset's data.
+		/// @param size The size of the asset's data.
+		AssetInput(const void* data, size_t size);
+
+		AssetInput() = delete;
+		AssetInput(const AssetInput&) = delete;
+		AssetInput(AssetInput&&) noexcept = delete;
+
+		AssetInput& operator=(const AssetInput&) = delete;
+		AssetInput& operator=(AssetInput&&) = delete;
+
+		/// @brief Reads the given number of bytes from the stream. Reads past the end of the asset's data fail the stream and fill the buffer with zeros.
+		/// @param size The number of bytes to read.
+		/// @param buffer The buffer to write the read bytes to.
+		/// @return A reference to the asset input stream.
+		AssetInput& ReadBuffer(size_t size, void* buffer);
+		/// @brief Sets the stream's position. Positions past the end of the asset's data fail the stream and leave its position unchanged.
+		/// @param pos The new position, relative to the start of the asset's data.
+		/// @return A reference to the asset input stream.
+		AssetInput& SetPos(size_t pos);
+		/// @brief Checks if any read or position change went past the end of the asset's data, which means the data is truncated or corrupt.
+		/// @return True if the stream failed, otherwise false.
+		bool8_t HasFailed() const {
+			return failed;
+		}
+		/// @brief Gets the stream's position.
+		/// @return The stream's position, relative to the start of the asset's data.
+		size_t GetPos() const {
+			return pos;
+		}
+		/// @brief Gets the size of the asset's data.
+		/// @return The size of the asset's data, in bytes.
+		size_t GetSize() const {
+			return size;
+		}
+
+		/// @brief Decompresses the compressed container found between the stream's position and the end of its data. The stream then reads the decompressed data from memory, starting at position 0.
+		/// @param decompressor The decompressor to use, which must outlive any helper jobs it submits.
+		/// @param jobManager The job manager used to decompress the chunks in parallel, or nullptr to decompress them on the calling thread.
+		/// @return True if the data was decompressed successfully, otherwise false.
+		bool8_t Decompress(AssetDecompressor& decompressor, JobManager* jobManager);
+
+		/// @brief Checks if the stream reads directly from memory.
+		/// @return True if the stream is backed by memory, otherwise false.
+		bool8_t IsMemoryBacked() const {
+			return data != nullptr;
+		}
+		/// @brief Gets the stream's backing memory at the current position, allowing the asset to use its data without copying it. Asset pack memory outlives the stream, and so does all memory given to assets loaded in place; otherwise, decompressed, cached import and asynchronously read data is freed together with the stream.
+		/// @return A const pointer to the stream's memory at its current position, or nullptr if the stream isn't backed by memory.
+		const void* GetData() const {
+			if(!data)
+				return nullptr;
+			return (const char_t*)data + pos;
+		}
+
+		/// @brief Sets the counter to which the time spent reading from the stream's file is added. Reads from memory aren't timed.
+		/// @param readTime A pointer to the counter, in nanoseconds, or nullptr to stop timing reads.
+		void SetReadTimeCounter(uint64_t* readTime) {
+			this->readTime = readTime;
+		}
+
+		/// @brief Makes the stream own its backing memory, which must have been allocated using AllocMemory. The memory is then freed together with the stream, unless it is released using ReleaseOwnedData.
+		void TakeOwnership() {
+			if(data && !ownedData)
+				ownedData = (char_t*)data;
+		}
+		/// @brief Takes ownership of the memory the stream owns, such as its decompressed data, which will no longer be freed together with the stream. The stream can still read from it.
+		/// @return A pointer to the owned data, which must be freed using FreeMemory, or nullptr if the stream doesn't own any data.
+		void* ReleaseOwnedData() {
+			void* releasedData = ownedData;
+			ownedData = nullptr;
+			return releasedData;
+		}
+
+		/// @brief Destroys the asset input stream.
+		~AssetInput();
+	private:
+		FileInput* fileInput;
+		const void* data;
+		char_t* ownedData;
+		size_t offset;
+		size_t size;
+		size_t pos;
+		uint64_t* readTime;
+		bool8_t failed;
+	};
+}
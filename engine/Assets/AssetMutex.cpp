@@ -0,0 +1,21 @@
+#include "AssetMutex.hpp"
+
+#include <chrono>
+#include <thread>
+
+namespace wfe {
+	// Private functions
+	void AssetMutex::InternalWait() const {
+		// Spin until the mutex is unlocked, yielding to the thread which holds it
+		auto start = std::chrono::steady_clock::now();
+
+		do {
+			while(locked.load(std::memory_order_relaxed))
+				std::this_thread::yield();
+		} while(locked.exchange(1, std::memory_order_acquire));
+
+		// Add the wait to the mutex's total wait time
+		auto end = std::chrono::steady_clock::now();
+		waitTime.fetch_add((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(), std::memory_order_relaxed);
+	}
+}
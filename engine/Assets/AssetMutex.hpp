@@ -0,0 +1,39 @@
+#pragma once
+
+#include <Core.hpp>
+#include <atomic>
+
+namespace wfe {
+	/// @brief A spin mutex used by the asset system, which measures the time threads spend waiting for it while it is contended.
+	class AssetMutex {
+	public:
+		/// @brief Creates an unlocked asset mutex.
+		AssetMutex() : locked(0), waitTime(0) { }
+		AssetMutex(const AssetMutex&) = delete;
+		AssetMutex(AssetMutex&&) noexcept = delete;
+
+		AssetMutex& operator=(const AssetMutex&) = delete;
+		AssetMutex& operator=(AssetMutex&&) = delete;
+
+		/// @brief Locks the mutex, measuring the wait if the mutex is already locked.
+		void Lock() const {
+			if(locked.exchange(1, std::memory_order_acquire))
+				InternalWait();
+		}
+		/// @brief Unlocks the mutex.
+		void Unlock() const {
+			locked.store(0, std::memory_order_release);
+		}
+
+		/// @brief Gets the total time threads spent waiting for the mutex.
+		/// @return The total wait time, in nanoseconds.
+		uint64_t GetWaitTime() const {
+			return waitTime.load(std::memory_order_relaxed);
+		}
+	private:
+		void InternalWait() const;
+
+		mutable std::atomic<int32_t> locked;
+		mutable std::atomic<uint64_t> waitTime;
+	};
+}
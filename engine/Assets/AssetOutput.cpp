@@ -0,0 +1,46 @@
+#include "AssetOutput.hpp"
+
+namespace wfe {
+	// Constants
+	static const size_t MIN_OUTPUT_CAPACITY = 0x1000;
+
+	// Public functions
+	AssetOutput::AssetOutput() : data(nullptr), size(0), capacity(0) { }
+
+	AssetOutput& AssetOutput::WriteBuffer(size_t size, const void* buffer) {
+		// Exit the function if there is nothing to write
+		if(!size)
+			return *this;
+
+		// Grow the stream's memory if the written data doesn't fit
+		if(size > capacity - this->size) {
+			size_t newCapacity = capacity ? capacity : MIN_OUTPUT_CAPACITY;
+			while(newCapacity - this->size < size)
+				newCapacity <<= 1;
+
+			char_t* newData = (char_t*)AllocMemory(newCapacity);
+			if(!newData)
+				throw BadAllocException("Failed to allocate asset output memory!");
+
+			if(data) {
+				memcpy(newData, data, this->size);
+				FreeMemory(data);
+			}
+
+			data = newData;
+			capacity = newCapacity;
+		}
+
+		// Copy the buffer to the stream's memory
+		memcpy(data + this->size, buffer, size);
+		this->size += size;
+
+		return *this;
+	}
+
+	AssetOutput::~AssetOutput() {
+		// Free the stream's memory
+		if(data)
+			FreeMemory(data);
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <Core.hpp>
+
+namespace wfe {
+	/// @brief An output stream for an asset's data, which collects the data in memory so that it can be compressed before being written to the asset's file.
+	class AssetOutput {
+	public:
+		/// @brief Creates an empty asset output stream.
+		AssetOutput();
+		AssetOutput(const AssetOutput&) = delete;
+		AssetOutput(AssetOutput&&) noexcept = delete;
+
+		AssetOutput& operator=(const AssetOutput&) = delete;
+		AssetOutput& operator=(AssetOutput&&) = delete;
+
+		/// @brief Writes the given buffer to the stream.
+		/// @param size The number of bytes to write.
+		/// @param buffer The buffer to read the written bytes from.
+		/// @return A reference to the asset output stream.
+		AssetOutput& WriteBuffer(size_t size, const void* buffer);
+
+		/// @brief Gets the stream's written data.
+		/// @return A const pointer to the written data.
+		const void* GetData() const {
+			return data;
+		}
+		/// @brief Gets the number of bytes written to the stream.
+		/// @return The size of the written data, in bytes.
+		size_t GetSize() const {
+			return size;
+		}
+
+		/// @brief Destroys the asset output stream.
+		~AssetOutput();
+	private:
+		char_t* data;
+		size_t size;
+		size_t capacity;
+	};
+}
@@ -0,0 +1,185 @@
+#include "AssetPack.hpp"
+
+#include <algorithm>
+
+namespace wfe {
+	// Constants
+	static const char_t PADDING[AssetPack::PACK_ALIGNMENT]{};
+	static const size_t COPY_BUFFER_SIZE = 0x100000;
+
+	// Internal helper functions
+	static uint64_t AlignOffset(uint64_t offset) {
+		return (offset + AssetPack::PACK_ALIGNMENT - 1) & ~(uint64_t)(AssetPack::PACK_ALIGNMENT - 1);
+	}
+
+	// Public static functions
+	uint64_t AssetPack::GetTypeHash(const string& fileExtension) {
+		// Hash the file extension using 64-bit FNV-1a
+		uint64_t hash = 0xCBF29CE484222325;
+		for(char_t character : fileExtension) {
+			hash ^= (uint8_t)character;
+			hash *= 0x100000001B3;
+		}
+
+		return hash;
+	}
+	const Asset::AssetType* AssetPack::FindAssetType(uint64_t typeHash) {
+		// Map every asset type's file extension hash to the type on first use, since asset types are only registered during static initialization
+		static const unordered_map<uint64_t, const Asset::AssetType*> hashTypes = [] {
+			unordered_map<uint64_t, const Asset::AssetType*> types;
+			for(const auto& assetType : Asset::GetAssetTypes())
+				types.insert({ GetTypeHash(assetType.fileExtension), &assetType });
+
+			return types;
+		}();
+
+		// Find the asset type whose file extension has the given hash
+		auto typeIter = hashTypes.find(typeHash);
+		if(typeIter == hashTypes.end())
+			return nullptr;
+
+		return typeIter->second;
+	}
+	void AssetPack::Cook(const vector<string>& filePaths, const string& packPath) {
+		// Set the entry of every asset file
+		vector<Entry> packEntries;
+		vector<const string*> entryPaths;
+		for(const auto& filePath : filePaths) {
+			// Skip the current file if it isn't an asset
+			string fileExtension = filePath.substr(filePath.rfind('.') + 1);
+			uint64_t typeHash = GetTypeHash(fileExtension);
+			const Asset::AssetType* assetType = FindAssetType(typeHash);
+			if(!assetType || assetType->fileExtension != fileExtension)
+				continue;
+
+			// Read and validate the asset's header, so that truncated or foreign files don't produce garbage entries
+			FileInput fileInput(filePath, FileInput::STREAM_TYPE_BINARY);
+			if(!fileInput.IsOpen())
+				throw Exception("Failed to open asset file %s!", filePath.c_str());
+			
+			Entry entry;
+			entry.size = (uint64_t)fileInput.GetSize();
+			entry.typeHash = typeHash;
+
+			vector<uint64_t> dependencies;
+			uint32_t flags;
+			AssetInput headerInput(&fileInput, 0);
+			if(!Asset::ReadHeader(headerInput, entry.id, dependencies, flags)) {
+				fileInput.Close();
+				throw Exception("Invalid asset header in asset file %s!", filePath.c_str());
+			}
+			fileInput.Close();
+
+			packEntries.push_back(entry);
+			entryPaths.push_back(&filePath);
+		}
+
+		// Sort the entries by ID
+		vector<size_t> order(packEntries.size());
+		for(size_t i = 0; i != order.size(); ++i)
+			order[i] = i;
+		std::sort(order.begin(), order.end(), [&packEntries](size_t first, size_t second) {
+			return packEntries[first].id < packEntries[second].id;
+		});
+
+		// Set the pack's header
+		Header packHeader {
+			.magic = PACK_MAGIC,
+			.version = PACK_VERSION,
+			.alignment = (uint32_t)PACK_ALIGNMENT,
+			.entryCount = (uint64_t)packEntries.size(),
+			.entriesOffset = sizeof(Header)
+		};
+
+		// Set the sorted entries and every asset's aligned offset
+		vector<Entry> sortedEntries(packEntries.size());
+		uint64_t offset = AlignOffset(sizeof(Header) + sizeof(Entry) * packEntries.size());
+		for(size_t i = 0; i != order.size(); ++i) {
+			sortedEntries[i] = packEntries[order[i]];
+			if(i && sortedEntries[i].id == sortedEntries[i - 1].id)
+				throw Exception("Found duplicate asset ID in asset file %s!", entryPaths[order[i]]->c_str());
+
+			sortedEntries[i].offset = offset;
+			offset = AlignOffset(offset + sortedEntries[i].size);
+		}
+
+		// Write the pack's header and table of contents
+		FileOutput fileOutput(packPath, FileOutput::STREAM_TYPE_BINARY);
+		if(!fileOutput.IsOpen())
+			throw Exception("Failed to open asset pack %s!", packPath.c_str());
+
+		fileOutput.WriteBuffer(sizeof(Header), &packHeader);
+		if(!sortedEntries.empty())
+			fileOutput.WriteBuffer(sizeof(Entry) * sortedEntries.size(), sortedEntries.data());
+		
+		uint64_t writtenSize = sizeof(Header) + sizeof(Entry) * sortedEntries.size();
+
+		// Copy every asset's file contents into the pack
+		char_t* copyBuffer = (char_t*)AllocMemory(COPY_BUFFER_SIZE);
+		if(!copyBuffer)
+			throw BadAllocException("Failed to allocate asset pack copy buffer!");
+
+		for(size_t i = 0; i != order.size(); ++i) {
+			// Pad the pack up to the asset's offset
+			fileOutput.WriteBuffer((size_t)(sortedEntries[i].offset - writtenSize), PADDING);
+			writtenSize = sortedEntries[i].offset;
+
+			// Copy the asset file's contents in chunks
+			FileInput fileInput(*entryPaths[order[i]], FileInput::STREAM_TYPE_BINARY);
+			for(uint64_t copied = 0; copied != sortedEntries[i].size;) {
+				size_t chunkSize = (size_t)std::min<uint64_t>(COPY_BUFFER_SIZE, sortedEntries[i].size - copied);
+				fileInput.ReadBuffer(chunkSize, copyBuffer);
+				fileOutput.WriteBuffer(chunkSize, copyBuffer);
+				copied += chunkSize;
+			}
+			fileInput.Close();
+
+			writtenSize += sortedEntries[i].size;
+		}
+
+		FreeMemory(copyBuffer);
+		fileOutput.Close();
+	}
+
+	// Public functions
+	AssetPack::AssetPack(const string& packPath) : packPath(packPath), mappedFile(packPath) {
+		// Check if the pack was mapped successfully
+		if(!mappedFile.IsOpen())
+			throw Exception("Failed to map asset pack %s!", packPath.c_str());
+		
+		// Validate the pack's header
+		if(mappedFile.GetSize() < sizeof(Header))
+			throw Exception("Asset pack %s is too small to contain a header!", packPath.c_str());
+		
+		header = (const Header*)mappedFile.GetData();
+		if(header->magic != PACK_MAGIC)
+			throw Exception("File %s is not an asset pack!", packPath.c_str());
+		if(header->version != PACK_VERSION)
+			throw Exception("Asset pack %s has an unsupported version!", packPath.c_str());
+		if(header->entriesOffset > mappedFile.GetSize() || header->entryCount > (mappedFile.GetSize() - header->entriesOffset) / sizeof(Entry))
+			throw Exception("Asset pack %s has an invalid table of contents!", packPath.c_str());
+		
+		// Validate every entry's range
+		entries = (const Entry*)((const char_t*)mappedFile.GetData() + header->entriesOffset);
+		for(size_t i = 0; i != (size_t)header->entryCount; ++i)
+			if(entries[i].offset > mappedFile.GetSize() || entries[i].size > mappedFile.GetSize() - entries[i].offset)
+				throw Exception("Asset pack %s has an entry outside of the pack!", packPath.c_str());
+	}
+
+	const AssetPack::Entry* AssetPack::FindEntry(uint64_t id) const {
+		// Binary search the sorted entries for the given ID
+		size_t left = 0, right = (size_t)header->entryCount;
+		while(left < right) {
+			size_t middle = (left + right) >> 1;
+			if(entries[middle].id < id) {
+				left = middle + 1;
+			} else {
+				right = middle;
+			}
+		}
+
+		if(left != (size_t)header->entryCount && entries[left].id == id)
+			return entries + left;
+		return nullptr;
+	}
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "Asset.hpp"
+#include "Platform/MappedFile.hpp"
+
+#include <Core.hpp>
+
+namespace wfe {
+	/// @brief A read-only archive which packs multiple asset files into one memory mapped file.
+	class AssetPack {
+	public:
+		/// @brief The magic number found at the start of every asset pack.
+		static const uint64_t PACK_MAGIC = 0x004B434150454657; // "WFEPACK\0"
+		/// @brief The version of the asset pack format.
+		static const uint32_t PACK_VERSION = 1;
+		/// @brief The alignment of every asset's data in the asset pack.
+		static const size_t PACK_ALIGNMENT = 64;
+
+		/// @brief The header found at the start of every asset pack.
+		struct Header {
+			/// @brief The pack's magic number, which must be equal to PACK_MAGIC.
+			uint64_t magic;
+			/// @brief The version of the pack's format.
+			uint32_t version;
+			/// @brief The alignment of every asset's data in the pack.
+			uint32_t alignment;
+			/// @brief The number of entries in the pack's table of contents.
+			uint64_t entryCount;
+			/// @brief The offset in the pack at which the table of contents starts.
+			uint64_t entriesOffset;
+		};
+		/// @brief An entry in the pack's table of contents, which is sorted by asset ID.
+		struct Entry {
+			/// @brief The ID of the asset.
+			uint64_t id;
+			/// @brief The offset in the pack at which the asset's file contents start.
+			uint64_t offset;
+			/// @brief The size of the asset's file contents.
+			uint64_t size;
+			/// @brief The hash of the asset type's file extension.
+			uint64_t typeHash;
+		};
+
+		/// @brief Gets the hash used to identify an asset type in asset packs.
+		/// @param fileExtension The asset type's file extension.
+		/// @return The hash of the given file extension.
+		static uint64_t GetTypeHash(const string& fileExtension);
+		/// @brief Finds the asset type with the given hash.
+		/// @param typeHash The hash of the asset type's file extension.
+		/// @return A pointer to the asset type with the given hash, or nullptr if no such type exists.
+		static const Asset::AssetType* FindAssetType(uint64_t typeHash);
+		/// @brief Cooks the given asset files into an asset pack. Files which aren't assets are skipped, and asset files whose header is truncated or invalid fail the cook.
+		/// @param filePaths A vector containing the paths of every file to pack.
+		/// @param packPath The path of the asset pack to write.
+		static void Cook(const vector<string>& filePaths, const string& packPath);
+
+		/// @brief Opens and maps the given asset pack.
+		/// @param packPath The path of the asset pack to open.
+		AssetPack(const string& packPath);
+
+		AssetPack() = delete;
+		AssetPack(const AssetPack&) = delete;
+		AssetPack(AssetPack&&) noexcept = delete;
+
+		AssetPack& operator=(const AssetPack&) = delete;
+		AssetPack& operator=(AssetPack&&) = delete;
+
+		/// @brief Gets the asset pack's path.
+		/// @return The asset pack's path.
+		const string& GetPackPath() const {
+			return packPath;
+		}
+		/// @brief Gets the number of entries in the pack's table of contents.
+		/// @return The number of entries in the pack.
+		size_t GetEntryCount() const {
+			return (size_t)header->entryCount;
+		}
+		/// @brief Gets the pack's table of contents.
+		/// @return A const pointer to the pack's entry array, sorted by asset ID.
+		const Entry* GetEntries() const {
+			return entries;
+		}
+		/// @brief Finds the entry of the asset with the given ID.
+		/// @param id The ID of the asset to find.
+		/// @return A const pointer to the asset's entry, or nullptr if the pack doesn't contain the asset.
+		const Entry* FindEntry(uint64_t id) const;
+		/// @brief Gets the file contents of the given entry's asset.
+		/// @param entry The entry whose contents to get.
+		/// @return A const pointer to the start of the asset's file contents in the mapped pack.
+		const void* GetEntryData(const Entry& entry) const {
+			return (const char_t*)mappedFile.GetData() + entry.offset;
+		}
+
+		/// @brief Unmaps the asset pack.
+		~AssetPack() = default;
+	private:
+		string packPath;
+		MappedFile mappedFile;
+		const Header* header;
+		const Entry* entries;
+	};
+}
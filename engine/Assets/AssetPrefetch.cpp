@@ -0,0 +1,281 @@
+#include "AssetPrefetch.hpp"
+#include "Asset.hpp"
+#include "AssetPack.hpp"
+#include "Platform/FilePrefetch.hpp"
+#include "Platform/MappedFile.hpp"
+
+#include <chrono>
+#include <thread>
+
+namespace wfe {
+	// Structs
+	struct ManifestHeader {
+		uint64_t magic;
+		uint64_t entryCount;
+	};
+	struct ManifestEntry {
+		uint64_t id;
+		uint64_t time;
+		uint64_t offset;
+		uint64_t size;
+		uint64_t pathSize;
+	};
+
+	// Internal helper functions
+	static bool8_t ReadManifest(const void* manifestData, size_t manifestSize, vector<AssetAccessEntry>& entries) {
+		// Read and validate the manifest's header
+		if(manifestSize < sizeof(ManifestHeader))
+			return false;
+
+		ManifestHeader header;
+		memcpy(&header, manifestData, sizeof(ManifestHeader));
+
+		if(header.magic != AssetPrefetcher::MANIFEST_MAGIC)
+			return false;
+		if(header.entryCount > (manifestSize - sizeof(ManifestHeader)) / sizeof(ManifestEntry))
+			return false;
+
+		// Read every entry, followed by its path
+		const char_t* data = (const char_t*)manifestData;
+		size_t pos = sizeof(ManifestHeader);
+
+		entries.resize((size_t)header.entryCount);
+		for(auto& entry : entries) {
+			if(manifestSize - pos < sizeof(ManifestEntry))
+				return false;
+
+			ManifestEntry manifestEntry;
+			memcpy(&manifestEntry, data + pos, sizeof(ManifestEntry));
+			pos += sizeof(ManifestEntry);
+
+			if(manifestEntry.pathSize > manifestSize - pos)
+				return false;
+
+			entry.id = manifestEntry.id;
+			entry.time = manifestEntry.time;
+			entry.filePath.assign(data + pos, (size_t)manifestEntry.pathSize);
+			entry.offset = manifestEntry.offset;
+			entry.size = manifestEntry.size;
+			pos += (size_t)manifestEntry.pathSize;
+		}
+
+		return true;
+	}
+
+	// Job functions
+	void* AssetPrefetcher::ReplayJob(void* args) {
+		ReplayBatch* batch = (ReplayBatch*)args;
+		AssetPrefetcher* prefetcher = batch->prefetcher;
+		AssetManager* manager = prefetcher->manager;
+		size_t entryCount = prefetcher->replayEntries.size();
+
+		// Prefetch the batch's entries, which are all due, in the order of their first access
+		for(size_t index = batch->begin; index != batch->end && !prefetcher->replayCancelled.load(std::memory_order_relaxed); ++index) {
+			// Hint the file of the entry the hint distance ahead, so that it is read by the time the replay reaches it
+			if(index + HINT_DISTANCE < entryCount)
+				prefetcher->InternalHintEntry(index + HINT_DISTANCE);
+
+			// Reload the entry's asset if the manager knows it and it was evicted, releasing it right away so that it can still be evicted
+			Asset* asset = manager->GetAsset(prefetcher->replayEntries[index].id);
+			if(asset) {
+				try {
+					if(manager->residency.Acquire(asset))
+						manager->residency.Release(asset);
+				} catch(const Exception&) { }
+			}
+
+			prefetcher->replayedCount.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		return nullptr;
+	}
+
+	// Thread functions
+	void AssetPrefetcher::ReplayThread(AssetPrefetcher* prefetcher) {
+		size_t entryCount = prefetcher->replayEntries.size();
+		bool8_t submitted[REPLAY_JOB_COUNT] {};
+		size_t slot = 0;
+
+		// Submit a job for every batch of due entries until every entry was submitted or the replay is cancelled
+		size_t index = 0;
+		while(index != entryCount && !prefetcher->replayCancelled.load(std::memory_order_relaxed)) {
+			// Sleep until the next entry is within the lead time of its recorded first access, in short steps so that a cancel is noticed
+			uint64_t elapsedTime = AssetTelemetry::GetTime() - prefetcher->replayStartTime;
+			uint64_t entryTime = prefetcher->replayEntries[index].time;
+			if(elapsedTime + REPLAY_LEAD_TIME < entryTime) {
+				uint64_t waitTime = entryTime - REPLAY_LEAD_TIME - elapsedTime;
+				std::this_thread::sleep_for(std::chrono::nanoseconds(waitTime < REPLAY_WAIT_STEP ? waitTime : REPLAY_WAIT_STEP));
+				continue;
+			}
+
+			// Take every due entry, up to the batch size
+			size_t end = index + 1;
+			while(end != entryCount && end - index != REPLAY_BATCH_SIZE && elapsedTime + REPLAY_LEAD_TIME >= prefetcher->replayEntries[end].time)
+				++end;
+
+			// Wait for the job previously submitted in the slot, keeping at most the job count in flight, and submit the batch's job
+			if(submitted[slot])
+				prefetcher->replayResults[slot].WaitForResult();
+
+			prefetcher->replayBatches[slot] = { prefetcher, index, end };
+			prefetcher->manager->jobManager->SubmitJob(ReplayJob, prefetcher->replayBatches + slot, prefetcher->replayResults[slot]);
+			submitted[slot] = true;
+
+			index = end;
+			slot = (slot + 1) % REPLAY_JOB_COUNT;
+		}
+
+		// Wait for every submitted job to finish
+		for(size_t i = 0; i != REPLAY_JOB_COUNT; ++i)
+			if(submitted[i])
+				prefetcher->replayResults[i].WaitForResult();
+	}
+
+	// Public functions
+	AssetPrefetcher::AssetPrefetcher(AssetManager* manager) : manager(manager), recording(false), recordingStartTime(0), replayStartTime(0), replayedCount(0), replayCancelled(false) { }
+
+	void AssetPrefetcher::StartRecording() {
+		// Remove the previous accesses and reset the time the accesses are relative to
+		mutex.Lock();
+		accesses.clear();
+		accessIndices.clear();
+		recordingStartTime = AssetTelemetry::GetTime();
+		mutex.Unlock();
+
+		recording.store(true, std::memory_order_relaxed);
+	}
+	vector<AssetAccessEntry> AssetPrefetcher::GetAccesses() const {
+		// Copy the recorded accesses
+		mutex.Lock();
+		vector<AssetAccessEntry> accessesVec = accesses;
+		mutex.Unlock();
+
+		return accessesVec;
+	}
+	bool8_t AssetPrefetcher::SaveManifest(const string& manifestPath) const {
+		// Open the manifest's file
+		FileOutput fileOutput(manifestPath, FileOutput::STREAM_TYPE_BINARY);
+		if(!fileOutput.IsOpen())
+			return false;
+
+		vector<AssetAccessEntry> accessesVec = GetAccesses();
+
+		// Write the manifest's header, followed by every entry and its path
+		ManifestHeader header {
+			.magic = MANIFEST_MAGIC,
+			.entryCount = (uint64_t)accessesVec.size()
+		};
+		fileOutput.WriteBuffer(sizeof(ManifestHeader), &header);
+
+		for(const auto& access : accessesVec) {
+			ManifestEntry manifestEntry {
+				.id = access.id,
+				.time = access.time,
+				.offset = access.offset,
+				.size = access.size,
+				.pathSize = (uint64_t)access.filePath.size()
+			};
+
+			fileOutput.WriteBuffer(sizeof(ManifestEntry), &manifestEntry);
+			if(!access.filePath.empty())
+				fileOutput.WriteBuffer(access.filePath.size(), access.filePath.c_str());
+		}
+
+		fileOutput.Close();
+
+		return true;
+	}
+
+	bool8_t AssetPrefetcher::StartReplay(const string& manifestPath) {
+		// Cancel the previous replay
+		CancelReplay();
+
+		// Read the manifest's entries
+		vector<AssetAccessEntry> entries;
+		{
+			MappedFile manifestFile(manifestPath);
+			if(!manifestFile.IsOpen() || !ReadManifest(manifestFile.GetData(), manifestFile.GetSize(), entries))
+				return false;
+		}
+
+		replayEntries.swap(entries);
+		replayedCount.store(0, std::memory_order_relaxed);
+		replayCancelled.store(false, std::memory_order_relaxed);
+
+		if(replayEntries.empty())
+			return true;
+
+		// Hint the files of the entries up to the hint distance, since no replay job will hint them
+		for(size_t i = 0; i != replayEntries.size() && i != HINT_DISTANCE; ++i)
+			InternalHintEntry(i);
+
+		// Start the replay's pacing thread, pacing the entries from now on
+		replayStartTime = AssetTelemetry::GetTime();
+		replayThread = std::thread(ReplayThread, this);
+
+		return true;
+	}
+	void AssetPrefetcher::WaitForReplay() {
+		// Wait for the pacing thread, which exits once every job it submitted finished
+		if(replayThread.joinable())
+			replayThread.join();
+	}
+	void AssetPrefetcher::CancelReplay() {
+		// Stop the pacing thread from submitting new batches and the jobs from prefetching further entries, and wait for them
+		replayCancelled.store(true, std::memory_order_relaxed);
+		WaitForReplay();
+	}
+
+	AssetPrefetcher::~AssetPrefetcher() {
+		// Cancel the current replay
+		CancelReplay();
+	}
+
+	// Private functions
+	void AssetPrefetcher::InternalRecordAccess(const Asset* asset) const {
+		uint64_t time = AssetTelemetry::GetTime();
+
+		mutex.Lock();
+
+		// Exit the function if the asset was already accessed
+		if(accessIndices.find(asset->id) != accessIndices.end()) {
+			mutex.Unlock();
+			return;
+		}
+
+		// Set the access' info, finding the asset's entry in the manager's packs if it has no file
+		AssetAccessEntry access {
+			.id = asset->id,
+			.time = time > recordingStartTime ? time - recordingStartTime : 0,
+			.filePath = asset->filePath,
+			.offset = 0,
+			.size = 0
+		};
+
+		if(access.filePath.empty()) {
+			for(const AssetPack* pack : manager->packs) {
+				const AssetPack::Entry* entry = pack->FindEntry(asset->id);
+				if(!entry)
+					continue;
+
+				access.filePath = pack->GetPackPath();
+				access.offset = entry->offset;
+				access.size = entry->size;
+				break;
+			}
+		}
+
+		// Add the access, skipping assets which were never saved or loaded, since they have nothing to prefetch
+		if(!access.filePath.empty()) {
+			accessIndices.insert({ access.id, accesses.size() });
+			accesses.push_back(access);
+		}
+
+		mutex.Unlock();
+	}
+	void AssetPrefetcher::InternalHintEntry(size_t index) {
+		// Hint the entry's file range to the operating system; a failed hint only means the file will be read on demand
+		const AssetAccessEntry& entry = replayEntries[index];
+		PrefetchFileRange(entry.filePath, entry.offset, entry.size);
+	}
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "AssetMutex.hpp"
+
+#include <Core.hpp>
+#include <atomic>
+#include <thread>
+
+namespace wfe {
+	class Asset;
+	class AssetManager;
+
+	/// @brief A struct containing a recorded first access of an asset.
+	struct AssetAccessEntry {
+		/// @brief The ID of the accessed asset.
+		uint64_t id;
+		/// @brief The time of the asset's first access, in nanoseconds since the recording started.
+		uint64_t time;
+		/// @brief The path of the asset's file or of the asset pack it was loaded from.
+		string filePath;
+		/// @brief The offset of the asset's data in its file.
+		uint64_t offset;
+		/// @brief The size of the asset's data, or 0 if the asset's data takes up its whole file.
+		uint64_t size;
+	};
+
+	/// @brief Records the order and timing of the first access of every asset into a manifest, and replays a recorded manifest as prefetch jobs which read the assets' files ahead of demand.
+	class AssetPrefetcher {
+	public:
+		/// @brief The magic number found at the start of every access manifest.
+		static const uint64_t MANIFEST_MAGIC = 0x4843544645525057; // "WPREFTCH"
+		/// @brief The number of manifest entries ahead of the entry being prefetched whose files are hinted to the operating system.
+		static const size_t HINT_DISTANCE = 32;
+		/// @brief The highest number of replay jobs in flight at once, which is kept low so that the replay doesn't starve the loads it runs ahead of.
+		static const size_t REPLAY_JOB_COUNT = 2;
+		/// @brief The highest number of due entries prefetched by a single replay job.
+		static const size_t REPLAY_BATCH_SIZE = 16;
+		/// @brief How far ahead of an entry's recorded first access, relative to the replay's start, the entry is prefetched, in nanoseconds.
+		static const uint64_t REPLAY_LEAD_TIME = 200000000;
+		/// @brief The longest time the replay's pacing thread sleeps at once while waiting for the next entry's prefetch time, so that cancelled replays stop quickly, in nanoseconds.
+		static const uint64_t REPLAY_WAIT_STEP = 5000000;
+
+		/// @brief Creates an asset prefetcher.
+		/// @param manager The asset manager whose accesses will be recorded and whose assets will be prefetched.
+		AssetPrefetcher(AssetManager* manager);
+
+		AssetPrefetcher() = delete;
+		AssetPrefetcher(const AssetPrefetcher&) = delete;
+		AssetPrefetcher(AssetPrefetcher&&) noexcept = delete;
+
+		AssetPrefetcher& operator=(const AssetPrefetcher&) = delete;
+		AssetPrefetcher& operator=(AssetPrefetcher&&) = delete;
+
+		/// @brief Starts recording the first access of every asset acquired from the manager or looked up by ID for a handle, removing the previously recorded accesses.
+		void StartRecording();
+		/// @brief Stops recording asset accesses, keeping the accesses recorded so far.
+		void StopRecording() {
+			recording.store(false, std::memory_order_relaxed);
+		}
+		/// @brief Checks if asset accesses are being recorded.
+		/// @return True if accesses are being recorded, otherwise false.
+		bool8_t IsRecording() const {
+			return recording.load(std::memory_order_relaxed);
+		}
+		/// @brief Records an access of the given asset, if accesses are being recorded and the asset wasn't accessed before.
+		/// @param asset A pointer to the accessed asset.
+		void RecordAccess(const Asset* asset) const {
+			if(recording.load(std::memory_order_relaxed))
+				InternalRecordAccess(asset);
+		}
+		/// @brief Gets the recorded accesses.
+		/// @return A vector containing the first access of every recorded asset, in the order of the accesses.
+		vector<AssetAccessEntry> GetAccesses() const;
+		/// @brief Writes the recorded accesses to a manifest file.
+		/// @param manifestPath The path of the manifest file to write.
+		/// @return True if the file was written, otherwise false.
+		bool8_t SaveManifest(const string& manifestPath) const;
+
+		/// @brief Starts prefetching the assets in the given manifest in the background, in the order of their first access. Every entry is prefetched the replay lead time before its recorded first access, measured from the replay's start, so that the replay runs just ahead of demand. The pacing runs on a dedicated thread, which submits a job for every batch of due entries, so no job manager worker waits for an entry's time. Every asset's file is hinted to the operating system shortly before it is reached, and assets known to the manager which aren't resident are reloaded. Any previous replay is cancelled.
+		/// @param manifestPath The path of the manifest file to replay.
+		/// @return True if the manifest was read and the replay started, otherwise false.
+		bool8_t StartReplay(const string& manifestPath);
+		/// @brief Waits for the current replay to finish.
+		void WaitForReplay();
+		/// @brief Stops the current replay after the entries being prefetched finish, and waits for it.
+		void CancelReplay();
+		/// @brief Gets the number of entries of the current or last replay which were prefetched.
+		/// @return The number of prefetched entries.
+		size_t GetReplayedCount() const {
+			return replayedCount.load(std::memory_order_relaxed);
+		}
+		/// @brief Gets the number of entries in the current or last replay.
+		/// @return The number of entries.
+		size_t GetReplayEntryCount() const {
+			return replayEntries.size();
+		}
+
+		/// @brief Cancels the current replay and destroys the asset prefetcher.
+		~AssetPrefetcher();
+	private:
+		struct ReplayBatch {
+			AssetPrefetcher* prefetcher;
+			size_t begin;
+			size_t end;
+		};
+
+		static void* ReplayJob(void* args);
+		static void ReplayThread(AssetPrefetcher* prefetcher);
+
+		void InternalRecordAccess(const Asset* asset) const;
+		void InternalHintEntry(size_t index);
+
+		AssetManager* manager;
+
+		std::atomic<bool8_t> recording;
+		uint64_t recordingStartTime;
+		AssetMutex mutex;
+		mutable vector<AssetAccessEntry> accesses;
+		mutable unordered_map<uint64_t, size_t> accessIndices;
+
+		vector<AssetAccessEntry> replayEntries;
+		uint64_t replayStartTime;
+		std::thread replayThread;
+		ReplayBatch replayBatches[REPLAY_JOB_COUNT];
+		JobManager::Result replayResults[REPLAY_JOB_COUNT];
+		std::atomic<size_t> replayedCount;
+		std::atomic<bool8_t> replayCancelled;
+	};
+}
@@ -0,0 +1,294 @@
+#include "AssetResidency.hpp"
+#include "Asset.hpp"
+
+namespace wfe {
+	// Public functions
+	AssetResidency::AssetResidency(AssetManager* manager) : manager(manager) {
+		// Set every memory usage type's default budget and resident size
+		for(size_t i = 0; i != MEMORY_USAGE_TYPE_COUNT; ++i) {
+			budgets[i] = UNLIMITED_BUDGET;
+			residentSizes[i] = 0;
+		}
+	}
+
+	void AssetResidency::SetBudget(MemoryUsageType memoryUsageType, size_t budget) {
+		// Set the new budget
+		mutex.Lock();
+		budgets[memoryUsageType] = budget;
+		mutex.Unlock();
+
+		// Evict assets until every memory usage type is within its budget
+		InternalEnforceBudgets();
+	}
+	void AssetResidency::Trim(size_t percent) {
+		// Get every memory usage type's target resident size, keeping it within the type's budget
+		size_t limits[MEMORY_USAGE_TYPE_COUNT];
+
+		mutex.Lock();
+		for(size_t i = 0; i != MEMORY_USAGE_TYPE_COUNT; ++i) {
+			size_t limit = residentSizes[i] / 100 * percent;
+			limits[i] = limit < budgets[i] ? limit : budgets[i];
+		}
+		mutex.Unlock();
+
+		// Evict assets until every memory usage type is within its target
+		InternalEvict(limits);
+	}
+	void AssetResidency::Trim(size_t percent, MemoryUsageType memoryUsageType) {
+		// Get the memory usage type's target resident size, keeping it within the type's budget, and leave every other type at its budget
+		size_t limits[MEMORY_USAGE_TYPE_COUNT];
+
+		mutex.Lock();
+		for(size_t i = 0; i != MEMORY_USAGE_TYPE_COUNT; ++i)
+			limits[i] = budgets[i];
+
+		size_t limit = residentSizes[memoryUsageType] / 100 * percent;
+		if(limit < limits[memoryUsageType])
+			limits[memoryUsageType] = limit;
+		mutex.Unlock();
+
+		// Evict assets until the memory usage type is within its target
+		InternalEvict(limits);
+	}
+	size_t AssetResidency::GetResidentSize(MemoryUsageType memoryUsageType) const {
+		// Read the resident size
+		mutex.Lock();
+		size_t residentSize = residentSizes[memoryUsageType];
+		mutex.Unlock();
+
+		return residentSize;
+	}
+
+	bool8_t AssetResidency::Acquire(Asset* asset) {
+		// Add a reference to the asset and remove it from its LRU list, so that it can't be evicted
+		mutex.Lock();
+
+		++asset->residencyRefCount;
+		InternalUnlink(asset);
+		bool8_t resident = asset->resident;
+
+		mutex.Unlock();
+
+		// Exit the function if the asset is still resident
+		if(resident)
+			return true;
+
+		// Lock the asset's residency mutex, so that only one thread reloads the asset
+		asset->residencyMutex.Lock();
+
+		mutex.Lock();
+		resident = asset->resident;
+		mutex.Unlock();
+
+		if(!resident) {
+			// Acquire the asset's dependencies and reload the asset
+			bool8_t result = AcquireDependencies(asset);
+			if(result) {
+				result = manager->ReloadAsset(asset);
+				if(!result)
+					ReleaseDependencies(asset);
+			}
+
+			// Release the reference if the asset couldn't be reloaded
+			if(!result) {
+				asset->residencyMutex.Unlock();
+				Release(asset);
+
+				return false;
+			}
+
+			AddResident(asset);
+		}
+
+		// Unlock the asset's residency mutex
+		asset->residencyMutex.Unlock();
+
+		return true;
+	}
+	void AssetResidency::Release(Asset* asset) {
+		mutex.Lock();
+
+		// Check if the asset was acquired
+		if(!asset->residencyRefCount) {
+			mutex.Unlock();
+			throw Exception("Released an asset with no references!");
+		}
+
+		// Remove the reference from the asset
+		InternalRelease(asset);
+
+		mutex.Unlock();
+
+		// Evict assets until every memory usage type is within its budget
+		InternalEnforceBudgets();
+	}
+
+	// Internal functions
+	bool8_t AssetResidency::AcquireDependencies(Asset* asset) {
+		// Acquire every dependency of the asset, so that none of them can be evicted while the asset is resident
+		for(size_t i = 0; i != asset->dependencies.size(); ++i) {
+			Asset* dependency = manager->GetAsset(asset->dependencies[i]);
+			if(dependency && Acquire(dependency))
+				continue;
+
+			// Release the dependencies acquired so far
+			mutex.Lock();
+			for(size_t j = 0; j != i; ++j) {
+				Asset* acquired = manager->GetAsset(asset->dependencies[j]);
+				if(acquired)
+					InternalRelease(acquired);
+			}
+			mutex.Unlock();
+
+			return false;
+		}
+
+		return true;
+	}
+	void AssetResidency::ReleaseDependencies(Asset* asset) {
+		// Release every dependency of the asset
+		mutex.Lock();
+		InternalReleaseDependencies(asset);
+		mutex.Unlock();
+
+		// Evict assets until every memory usage type is within its budget
+		InternalEnforceBudgets();
+	}
+	void AssetResidency::AddResident(Asset* asset) {
+		// Save the asset's size and memory usage type, so that they can be removed from the resident sizes unchanged
+		size_t memorySize = asset->GetMemorySize();
+		MemoryUsageType memoryUsageType = asset->GetMemoryUsageType();
+
+		mutex.Lock();
+
+		// Mark the asset as resident and add its size to its memory usage type's resident size
+		asset->resident = true;
+		asset->residentSize = memorySize;
+		asset->residentUsageType = memoryUsageType;
+		residentSizes[memoryUsageType] += memorySize;
+
+		// Add the asset to its LRU list if it has no references
+		if(!asset->residencyRefCount)
+			InternalLink(asset);
+
+		mutex.Unlock();
+
+		// Evict assets until every memory usage type is within its budget
+		InternalEnforceBudgets();
+	}
+	void AssetResidency::RemoveAsset(Asset* asset) {
+		mutex.Lock();
+
+		// Remove the asset from its LRU list
+		InternalUnlink(asset);
+
+		// Remove the asset's size from the resident sizes and release its dependencies
+		if(asset->resident) {
+			residentSizes[asset->residentUsageType] -= asset->residentSize;
+			asset->resident = false;
+
+			InternalReleaseDependencies(asset);
+		}
+
+		mutex.Unlock();
+	}
+
+	void AssetResidency::InternalLink(Asset* asset) {
+		// Add the asset to the back of its LRU list, as the most recently used asset
+		LRUList& lruList = lruLists[asset->residentUsageType];
+
+		asset->residencyPrev = lruList.last;
+		asset->residencyNext = nullptr;
+		asset->residencyLinked = true;
+
+		if(lruList.last)
+			lruList.last->residencyNext = asset;
+		else
+			lruList.first = asset;
+		lruList.last = asset;
+	}
+	void AssetResidency::InternalUnlink(Asset* asset) {
+		// Exit the function if the asset isn't in its LRU list
+		if(!asset->residencyLinked)
+			return;
+
+		// Remove the asset from its LRU list
+		LRUList& lruList = lruLists[asset->residentUsageType];
+
+		if(asset->residencyPrev)
+			asset->residencyPrev->residencyNext = asset->residencyNext;
+		else
+			lruList.first = asset->residencyNext;
+		if(asset->residencyNext)
+			asset->residencyNext->residencyPrev = asset->residencyPrev;
+		else
+			lruList.last = asset->residencyPrev;
+
+		asset->residencyPrev = nullptr;
+		asset->residencyNext = nullptr;
+		asset->residencyLinked = false;
+	}
+	void AssetResidency::InternalRelease(Asset* asset) {
+		// Remove the reference and make the asset evictable if no references are left
+		if(!--asset->residencyRefCount && asset->resident)
+			InternalLink(asset);
+	}
+	void AssetResidency::InternalReleaseDependencies(Asset* asset) {
+		// Release every dependency of the asset which is still referenced; dependencies which were destroyed are skipped
+		for(uint64_t dependencyID : asset->dependencies) {
+			Asset* dependency = manager->GetAsset(dependencyID);
+			if(dependency && dependency->residencyRefCount)
+				InternalRelease(dependency);
+		}
+	}
+	void AssetResidency::InternalEvict(const size_t* limits) {
+		mutex.Lock();
+
+		// Keep evicting until no more assets can be evicted, since evicting an asset may make its dependencies evictable
+		bool8_t evicted = true;
+		while(evicted) {
+			// Exit the loop once every memory usage type is within its limit
+			size_t overBudgetType = 0;
+			for(; overBudgetType != MEMORY_USAGE_TYPE_COUNT && residentSizes[overBudgetType] <= limits[overBudgetType]; ++overBudgetType);
+			if(overBudgetType == MEMORY_USAGE_TYPE_COUNT)
+				break;
+
+			evicted = false;
+
+			for(size_t type = 0; type != MEMORY_USAGE_TYPE_COUNT; ++type) {
+				// Evict the least recently used assets until the memory usage type is within its limit, stopping at the list's current last asset, since assets which can't be unloaded are moved after it
+				Asset* last = lruLists[type].last;
+				Asset* next;
+				for(Asset* asset = lruLists[type].first; asset && residentSizes[type] > limits[type]; asset = next) {
+					next = asset == last ? nullptr : asset->residencyNext;
+
+					// Skip assets with unsaved changes, since they can't be reloaded
+					if(asset->IsDirty())
+						continue;
+
+					// Remove the asset from its LRU list and try to unload it; assets which can't be unloaded are kept resident and moved to the back of their list
+					InternalUnlink(asset);
+					if(!asset->UnloadAsset()) {
+						InternalLink(asset);
+						continue;
+					}
+
+					// Free the memory the asset was loaded in place from
+					asset->InternalFreeInPlaceData();
+
+					// Mark the asset as evicted and release its dependencies
+					residentSizes[type] -= asset->residentSize;
+					asset->resident = false;
+					asset->residentSize = 0;
+
+					InternalReleaseDependencies(asset);
+
+					// Released dependencies are linked at the back of their lists, so they will be checked in this pass or the next one
+					evicted = true;
+				}
+			}
+		}
+
+		mutex.Unlock();
+	}
+}
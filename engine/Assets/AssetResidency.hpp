@@ -0,0 +1,95 @@
+#pragma once
+
+#include "AssetMutex.hpp"
+
+#include <Core.hpp>
+
+namespace wfe {
+	class Asset;
+	class AssetManager;
+
+	/// @brief Keeps track of which assets are resident in memory, evicting the least recently used unreferenced assets when a memory usage type goes over its budget.
+	class AssetResidency {
+	public:
+		/// @brief The budget value used for memory usage types with no limit.
+		static const size_t UNLIMITED_BUDGET = SIZE_T_MAX;
+
+		/// @brief Creates an asset residency tracker.
+		/// @param manager The asset manager whose assets will be tracked.
+		AssetResidency(AssetManager* manager);
+
+		AssetResidency() = delete;
+		AssetResidency(const AssetResidency&) = delete;
+		AssetResidency(AssetResidency&&) noexcept = delete;
+
+		AssetResidency& operator=(const AssetResidency&) = delete;
+		AssetResidency& operator=(AssetResidency&&) = delete;
+
+		/// @brief Gets the memory budget of the given memory usage type.
+		/// @param memoryUsageType The memory usage type whose budget to get.
+		/// @return The budget in bytes, or UNLIMITED_BUDGET if the memory usage type has no limit.
+		size_t GetBudget(MemoryUsageType memoryUsageType) const {
+			return budgets[memoryUsageType];
+		}
+		/// @brief Sets the memory budget of the given memory usage type, evicting assets if the resident size goes over the new budget.
+		/// @param memoryUsageType The memory usage type whose budget to set.
+		/// @param budget The new budget in bytes, or UNLIMITED_BUDGET to remove the limit.
+		void SetBudget(MemoryUsageType memoryUsageType, size_t budget);
+		/// @brief Gets the total size of the resident assets with the given memory usage type.
+		/// @param memoryUsageType The memory usage type whose resident size to get.
+		/// @return The resident size in bytes.
+		size_t GetResidentSize(MemoryUsageType memoryUsageType) const;
+		/// @brief Evicts the least recently used unreferenced assets until every memory usage type's resident size is at most the given percentage of its current resident size, without changing the budgets.
+		/// @param percent The percentage of the resident sizes to keep.
+		void Trim(size_t percent);
+		/// @brief Evicts the least recently used unreferenced assets with the given memory usage type until its resident size is at most the given percentage of its current resident size, without changing the budgets. Assets with other memory usage types are kept.
+		/// @param percent The percentage of the resident size to keep.
+		/// @param memoryUsageType The memory usage type whose assets to evict.
+		void Trim(size_t percent, MemoryUsageType memoryUsageType);
+		/// @brief Gets the total time threads spent waiting for the residency tracker's lock.
+		/// @return The total wait time, in nanoseconds.
+		uint64_t GetLockWaitTime() const {
+			return mutex.GetWaitTime();
+		}
+
+		/// @brief Acquires a reference to the given asset, reloading it and its dependencies if they were evicted.
+		/// @param asset The asset to acquire.
+		/// @return True if the asset is resident and was acquired, otherwise false.
+		bool8_t Acquire(Asset* asset);
+		/// @brief Releases a reference to the given asset, allowing it to be evicted once no references are left.
+		/// @param asset The asset to release.
+		void Release(Asset* asset);
+
+		/// @brief Destroys the asset residency tracker.
+		~AssetResidency() = default;
+	private:
+		friend AssetManager;
+		friend Asset;
+
+		struct LRUList {
+			Asset* first = nullptr;
+			Asset* last = nullptr;
+		};
+
+		bool8_t AcquireDependencies(Asset* asset);
+		void ReleaseDependencies(Asset* asset);
+		void AddResident(Asset* asset);
+		void RemoveAsset(Asset* asset);
+
+		void InternalLink(Asset* asset);
+		void InternalUnlink(Asset* asset);
+		void InternalRelease(Asset* asset);
+		void InternalReleaseDependencies(Asset* asset);
+		void InternalEnforceBudgets() {
+			InternalEvict(budgets);
+		}
+		void InternalEvict(const size_t* limits);
+
+		AssetManager* manager;
+
+		AssetMutex mutex;
+		size_t budgets[MEMORY_USAGE_TYPE_COUNT];
+		size_t residentSizes[MEMORY_USAGE_TYPE_COUNT];
+		LRUList lruLists[MEMORY_USAGE_TYPE_COUNT];
+	};
+}
@@ -0,0 +1,124 @@
+#include "AssetSlotMap.hpp"
+
+namespace wfe {
+	// Internal functions
+	bool8_t AssetSlotMap::InternalHasCapacity(size_t count) const {
+		// Check if the free slots and the slots which weren't added yet can hold the given number of assets
+		return count <= freeSlots.size() + (PAGE_SIZE * MAX_PAGE_COUNT - slotCount);
+	}
+	void AssetSlotMap::InternalInsert(Asset* asset, uint32_t& index, uint32_t& generation) {
+		// Reuse a free slot, or add a new slot, allocating its page if needed
+		if(!freeSlots.empty()) {
+			index = freeSlots.back();
+			freeSlots.pop_back();
+		} else {
+			index = slotCount++;
+			if(!(index & PAGE_MASK)) {
+				Slot* page = NewArray<Slot>(PAGE_SIZE);
+				for(size_t i = 0; i != PAGE_SIZE; ++i) {
+					page[i].generation.store(1, std::memory_order_relaxed);
+					page[i].asset.store(nullptr, std::memory_order_relaxed);
+					page[i].denseIndex = 0;
+				}
+
+				pages[index >> PAGE_SHIFT].store(page, std::memory_order_release);
+			}
+		}
+
+		// Set the slot's asset and add the asset to the dense array
+		Slot& slot = pages[index >> PAGE_SHIFT].load(std::memory_order_relaxed)[index & PAGE_MASK];
+		slot.asset.store(asset, std::memory_order_release);
+		slot.denseIndex = (uint32_t)denseAssets.size();
+		generation = slot.generation.load(std::memory_order_relaxed);
+
+		denseAssets.push_back(asset);
+		denseSlots.push_back(index);
+	}
+
+	// Public functions
+	AssetSlotMap::AssetSlotMap() : slotCount(0) {
+		// Set every page as unallocated
+		for(size_t i = 0; i != MAX_PAGE_COUNT; ++i)
+			pages[i].store(nullptr, std::memory_order_relaxed);
+	}
+
+	void AssetSlotMap::Insert(Asset* asset, uint32_t& index, uint32_t& generation) {
+		mutex.Lock();
+
+		// Check if there is a slot left before changing the map
+		if(!InternalHasCapacity(1)) {
+			mutex.Unlock();
+			throw Exception("Ran out of asset slots!");
+		}
+
+		InternalInsert(asset, index, generation);
+		mutex.Unlock();
+	}
+	void AssetSlotMap::InsertBatch(Asset* const* assets, uint32_t* indices, uint32_t* generations, size_t count) {
+		mutex.Lock();
+
+		// Check if there are enough slots left for every asset before changing the map, so that the batch is never partly inserted
+		if(!InternalHasCapacity(count)) {
+			mutex.Unlock();
+			throw Exception("Ran out of asset slots!");
+		}
+
+		for(size_t i = 0; i != count; ++i)
+			InternalInsert(assets[i], indices[i], generations[i]);
+		mutex.Unlock();
+	}
+	void AssetSlotMap::Remove(uint32_t index) {
+		mutex.Lock();
+
+		// Clear the slot and advance its generation, skipping 0, which is used by null handles
+		Slot& slot = pages[index >> PAGE_SHIFT].load(std::memory_order_relaxed)[index & PAGE_MASK];
+		slot.asset.store(nullptr, std::memory_order_relaxed);
+
+		uint32_t generation = slot.generation.load(std::memory_order_relaxed) + 1;
+		if(!generation)
+			generation = 1;
+		slot.generation.store(generation, std::memory_order_release);
+
+		// Move the last asset in the dense array into the removed asset's place
+		uint32_t denseIndex = slot.denseIndex;
+		uint32_t lastSlotIndex = denseSlots.back();
+
+		denseAssets[denseIndex] = denseAssets.back();
+		denseSlots[denseIndex] = lastSlotIndex;
+		pages[lastSlotIndex >> PAGE_SHIFT].load(std::memory_order_relaxed)[lastSlotIndex & PAGE_MASK].denseIndex = denseIndex;
+
+		denseAssets.pop_back();
+		denseSlots.pop_back();
+
+		// Add the slot to the free slots
+		freeSlots.push_back(index);
+
+		mutex.Unlock();
+	}
+
+	size_t AssetSlotMap::GetCount() const {
+		// Get the dense array's size
+		mutex.Lock();
+		size_t count = denseAssets.size();
+		mutex.Unlock();
+
+		return count;
+	}
+	void AssetSlotMap::CollectAssets(vector<Asset*>& assets) const {
+		// Append the dense array to the vector
+		mutex.Lock();
+		assets.reserve(assets.size() + denseAssets.size());
+		for(Asset* asset : denseAssets)
+			assets.push_back(asset);
+		mutex.Unlock();
+	}
+
+	AssetSlotMap::~AssetSlotMap() {
+		// Free every allocated page
+		for(size_t i = 0; i != MAX_PAGE_COUNT; ++i) {
+			Slot* page = pages[i].load(std::memory_order_relaxed);
+			if(page)
+				DestroyArray(page, PAGE_SIZE);
+		}
+	}
+}
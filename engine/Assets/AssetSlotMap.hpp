@@ -0,0 +1,102 @@
+#pragma once
+
+#include "AssetMutex.hpp"
+
+#include <Core.hpp>
+#include <atomic>
+
+namespace wfe {
+	class Asset;
+
+	/// @brief A generational slot array of assets, which resolves asset handles without taking a lock and keeps every asset in a dense array for iteration.
+	class AssetSlotMap {
+	public:
+		/// @brief The number of slots in every page of the slot array.
+		static const size_t PAGE_SIZE = 0x1000;
+		/// @brief The maximum number of pages in the slot array.
+		static const size_t MAX_PAGE_COUNT = 0x1000;
+
+		/// @brief Creates an empty asset slot map.
+		AssetSlotMap();
+		AssetSlotMap(const AssetSlotMap&) = delete;
+		AssetSlotMap(AssetSlotMap&&) noexcept = delete;
+
+		AssetSlotMap& operator=(const AssetSlotMap&) = delete;
+		AssetSlotMap& operator=(AssetSlotMap&&) = delete;
+
+		/// @brief Inserts the given asset into a free slot.
+		/// @param asset A pointer to the asset to insert.
+		/// @param index A reference to the variable in which the index of the asset's slot will be written.
+		/// @param generation A reference to the variable in which the generation of the asset's slot will be written, which is never 0.
+		void Insert(Asset* asset, uint32_t& index, uint32_t& generation);
+		/// @brief Inserts the given assets into free slots, taking the map's lock only once.
+		/// @param assets An array of pointers to the assets to insert.
+		/// @param indices An array in which the indices of the assets' slots will be written.
+		/// @param generations An array in which the generations of the assets' slots will be written, which are never 0.
+		/// @param count The number of assets to insert.
+		void InsertBatch(Asset* const* assets, uint32_t* indices, uint32_t* generations, size_t count);
+		/// @brief Removes the asset in the given slot, invalidating every handle to it.
+		/// @param index The index of the asset's slot.
+		void Remove(uint32_t index);
+		/// @brief Gets the asset in the given slot without taking any lock.
+		/// @param index The index of the asset's slot.
+		/// @param generation The generation of the asset's slot.
+		/// @return A pointer to the asset, or nullptr if the slot's generation changed because its asset was removed.
+		Asset* Resolve(uint32_t index, uint32_t generation) const {
+			// Get the slot's page, which is never freed while the map exists
+			if((index >> PAGE_SHIFT) >= MAX_PAGE_COUNT)
+				return nullptr;
+			const Slot* page = pages[index >> PAGE_SHIFT].load(std::memory_order_acquire);
+			if(!page)
+				return nullptr;
+			const Slot& slot = page[index & PAGE_MASK];
+
+			// Read the slot's asset, checking its generation before and after the read
+			if(slot.generation.load(std::memory_order_acquire) != generation)
+				return nullptr;
+			Asset* asset = slot.asset.load(std::memory_order_acquire);
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if(slot.generation.load(std::memory_order_relaxed) != generation)
+				return nullptr;
+
+			return asset;
+		}
+
+		/// @brief Gets the number of assets in the map.
+		/// @return The number of assets.
+		size_t GetCount() const;
+		/// @brief Appends every asset in the map to the given vector, in the order of the dense array.
+		/// @param assets The vector to append the assets to.
+		void CollectAssets(vector<Asset*>& assets) const;
+		/// @brief Gets the total time threads spent waiting for the map's lock.
+		/// @return The total wait time, in nanoseconds.
+		uint64_t GetLockWaitTime() const {
+			return mutex.GetWaitTime();
+		}
+
+		/// @brief Destroys the asset slot map.
+		~AssetSlotMap();
+	private:
+		static const size_t PAGE_SHIFT = 12;
+		static const size_t PAGE_MASK = PAGE_SIZE - 1;
+
+		struct Slot {
+			std::atomic<uint32_t> generation;
+			std::atomic<Asset*> asset;
+			uint32_t denseIndex;
+		};
+
+		bool8_t InternalHasCapacity(size_t count) const;
+		void InternalInsert(Asset* asset, uint32_t& index, uint32_t& generation);
+
+		std::atomic<Slot*> pages[MAX_PAGE_COUNT];
+		uint32_t slotCount;
+
+		vector<Asset*> denseAssets;
+		vector<uint32_t> denseSlots;
+		vector<uint32_t> freeSlots;
+
+		AssetMutex mutex;
+	};
+}
@@ -0,0 +1,185 @@
+#include "AssetSnapshot.hpp"
+#include "Asset.hpp"
+#include "AssetPack.hpp"
+#include "Platform/Directory.hpp"
+#include "Platform/FileInfo.hpp"
+
+#include <algorithm>
+
+namespace wfe {
+	// Constants
+	static const char_t PADDING[AssetSnapshot::SNAPSHOT_ALIGNMENT]{};
+	static const size_t COPY_BUFFER_SIZE = 0x100000;
+
+	// Internal helper functions
+	static uint64_t AlignOffset(uint64_t offset) {
+		return (offset + AssetSnapshot::SNAPSHOT_ALIGNMENT - 1) & ~(uint64_t)(AssetSnapshot::SNAPSHOT_ALIGNMENT - 1);
+	}
+
+	// Public static functions
+	void AssetSnapshot::Write(const vector<string>& filePaths, const string& rootDir, const string& snapshotPath) {
+		// Set the entry of every asset file, reading its header
+		vector<Entry> snapshotEntries;
+		vector<uint64_t> snapshotDependencies;
+		vector<char_t> snapshotPaths;
+		vector<const string*> entryPaths;
+		vector<uint64_t> headerSizes;
+
+		for(const auto& filePath : filePaths) {
+			// Skip the current file if it isn't an asset
+			size_t extensionPos = filePath.rfind('.');
+			if(extensionPos == SIZE_T_MAX)
+				continue;
+			uint64_t typeHash = AssetPack::GetTypeHash(filePath.substr(extensionPos + 1));
+			if(!AssetPack::FindAssetType(typeHash))
+				continue;
+
+			// Get the file's size and modification time before reading it, so that any later change invalidates the snapshot
+			Entry entry;
+			entry.typeHash = typeHash;
+			if(!GetFileInfo(filePath, entry.fileSize, entry.fileTime))
+				throw Exception("Failed to get the info of asset file %s!", filePath.c_str());
+
+			// Read the asset's header
+			FileInput fileInput(filePath, FileInput::STREAM_TYPE_BINARY);
+			if(!fileInput.IsOpen())
+				throw Exception("Failed to open asset file %s!", filePath.c_str());
+
+			vector<uint64_t> dependencies;
+			AssetInput headerInput(&fileInput, 0);
+			bool8_t headerRead = Asset::ReadHeader(headerInput, entry.id, dependencies, entry.flags);
+			fileInput.Close();
+
+			if(!headerRead)
+				throw Exception("Found invalid header in asset file %s!", filePath.c_str());
+
+			if((uint64_t)headerInput.GetSize() != entry.fileSize)
+				throw Exception("Asset file %s was modified while writing its snapshot!", filePath.c_str());
+
+			entry.dataSize = (uint64_t)(headerInput.GetSize() - headerInput.GetPos());
+			entry.dependenciesBegin = (uint64_t)snapshotDependencies.size();
+			entry.dependencyCount = (uint32_t)dependencies.size();
+			for(uint64_t dependencyID : dependencies)
+				snapshotDependencies.push_back(dependencyID);
+
+			// Save the file's path relative to the root directory
+			size_t pathBegin = filePath.substr(0, rootDir.size()) == rootDir ? rootDir.size() : 0;
+			entry.pathOffset = (uint64_t)snapshotPaths.size();
+			entry.pathSize = (uint64_t)(filePath.size() - pathBegin);
+			for(size_t i = pathBegin; i != filePath.size(); ++i)
+				snapshotPaths.push_back(filePath[i]);
+
+			snapshotEntries.push_back(entry);
+			entryPaths.push_back(&filePath);
+			headerSizes.push_back((uint64_t)headerInput.GetPos());
+		}
+
+		// Set the snapshot's header, placing the dependencies and paths after the asset table
+		Header snapshotHeader {
+			.magic = SNAPSHOT_MAGIC,
+			.version = SNAPSHOT_VERSION,
+			.alignment = (uint32_t)SNAPSHOT_ALIGNMENT,
+			.entryCount = (uint64_t)snapshotEntries.size(),
+			.entriesOffset = sizeof(Header),
+			.dependencyCount = (uint64_t)snapshotDependencies.size(),
+			.dependenciesOffset = sizeof(Header) + sizeof(Entry) * snapshotEntries.size(),
+			.pathsSize = (uint64_t)snapshotPaths.size(),
+			.pathsOffset = sizeof(Header) + sizeof(Entry) * snapshotEntries.size() + sizeof(uint64_t) * snapshotDependencies.size()
+		};
+
+		// Set every asset's aligned data offset
+		uint64_t offset = AlignOffset(snapshotHeader.pathsOffset + snapshotHeader.pathsSize);
+		for(auto& entry : snapshotEntries) {
+			entry.dataOffset = offset;
+			offset = AlignOffset(offset + entry.dataSize);
+		}
+
+		// Write the snapshot's header, asset table, dependencies and paths to a temporary file, which replaces the snapshot once complete.
+		// The snapshot is never overwritten in place, since a previous snapshot load may still have it mapped
+		string tempPath = snapshotPath + ".tmp";
+		FileOutput fileOutput(tempPath, FileOutput::STREAM_TYPE_BINARY);
+		if(!fileOutput.IsOpen())
+			throw Exception("Failed to open asset snapshot %s!", tempPath.c_str());
+
+		fileOutput.WriteBuffer(sizeof(Header), &snapshotHeader);
+		if(!snapshotEntries.empty())
+			fileOutput.WriteBuffer(sizeof(Entry) * snapshotEntries.size(), snapshotEntries.data());
+		if(!snapshotDependencies.empty())
+			fileOutput.WriteBuffer(sizeof(uint64_t) * snapshotDependencies.size(), snapshotDependencies.data());
+		if(!snapshotPaths.empty())
+			fileOutput.WriteBuffer(snapshotPaths.size(), snapshotPaths.data());
+
+		uint64_t writtenSize = snapshotHeader.pathsOffset + snapshotHeader.pathsSize;
+
+		// Copy every asset's data into the snapshot
+		char_t* copyBuffer = (char_t*)AllocMemory(COPY_BUFFER_SIZE);
+		if(!copyBuffer)
+			throw BadAllocException("Failed to allocate asset snapshot copy buffer!");
+
+		for(size_t i = 0; i != snapshotEntries.size(); ++i) {
+			// Pad the snapshot up to the asset's offset
+			fileOutput.WriteBuffer((size_t)(snapshotEntries[i].dataOffset - writtenSize), PADDING);
+			writtenSize = snapshotEntries[i].dataOffset;
+
+			// Copy the asset's data in chunks, skipping its header
+			FileInput fileInput(*entryPaths[i], FileInput::STREAM_TYPE_BINARY);
+			fileInput.SetPos((size_t)headerSizes[i], FileInput::SET_POS_RELATIVE_BEGIN);
+			for(uint64_t copied = 0; copied != snapshotEntries[i].dataSize;) {
+				size_t chunkSize = (size_t)std::min<uint64_t>(COPY_BUFFER_SIZE, snapshotEntries[i].dataSize - copied);
+				fileInput.ReadBuffer(chunkSize, copyBuffer);
+				fileOutput.WriteBuffer(chunkSize, copyBuffer);
+				copied += chunkSize;
+			}
+			fileInput.Close();
+
+			writtenSize += snapshotEntries[i].dataSize;
+		}
+
+		FreeMemory(copyBuffer);
+		fileOutput.Close();
+
+		// Replace the snapshot with the complete temporary file
+		if(!RenameFile(tempPath, snapshotPath))
+			throw Exception("Failed to replace asset snapshot %s!", snapshotPath.c_str());
+	}
+
+	// Public functions
+	AssetSnapshot::AssetSnapshot(const string& snapshotPath) : snapshotPath(snapshotPath), mappedFile(snapshotPath), header(nullptr), entries(nullptr), dependencies(nullptr), paths(nullptr), refCount(0) {
+		// Exit the function if the snapshot doesn't exist or is too small to contain a header
+		if(!mappedFile.IsOpen() || mappedFile.GetSize() < sizeof(Header))
+			return;
+
+		// Validate the snapshot's header and the ranges of its tables
+		const Header* snapshotHeader = (const Header*)mappedFile.GetData();
+		uint64_t size = (uint64_t)mappedFile.GetSize();
+
+		if(snapshotHeader->magic != SNAPSHOT_MAGIC || snapshotHeader->version != SNAPSHOT_VERSION || snapshotHeader->alignment != SNAPSHOT_ALIGNMENT)
+			return;
+		if(snapshotHeader->entriesOffset > size || snapshotHeader->entryCount > (size - snapshotHeader->entriesOffset) / sizeof(Entry))
+			return;
+		if(snapshotHeader->dependenciesOffset > size || snapshotHeader->dependencyCount > (size - snapshotHeader->dependenciesOffset) / sizeof(uint64_t))
+			return;
+		if(snapshotHeader->pathsOffset > size || snapshotHeader->pathsSize > size - snapshotHeader->pathsOffset)
+			return;
+
+		// Validate every entry's ID and ranges, which also rejects partially written snapshots
+		const Entry* snapshotEntries = (const Entry*)((const char_t*)mappedFile.GetData() + snapshotHeader->entriesOffset);
+		for(size_t i = 0; i != (size_t)snapshotHeader->entryCount; ++i) {
+			const Entry& entry = snapshotEntries[i];
+			if(entry.id >= AssetTable::ERASED_KEY)
+				return;
+			if(entry.dataOffset > size || entry.dataSize > size - entry.dataOffset)
+				return;
+			if(entry.dependenciesBegin > snapshotHeader->dependencyCount || entry.dependencyCount > snapshotHeader->dependencyCount - entry.dependenciesBegin)
+				return;
+			if(entry.pathOffset > snapshotHeader->pathsSize || entry.pathSize > snapshotHeader->pathsSize - entry.pathOffset)
+				return;
+		}
+
+		// Save the snapshot's tables
+		header = snapshotHeader;
+		entries = snapshotEntries;
+		dependencies = (const uint64_t*)((const char_t*)mappedFile.GetData() + header->dependenciesOffset);
+		paths = (const char_t*)mappedFile.GetData() + header->pathsOffset;
+	}
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "Platform/MappedFile.hpp"
+
+#include <Core.hpp>
+
+namespace wfe {
+	/// @brief A read-only, memory mapped image of every asset loaded from a directory tree, containing the assets' table, dependencies and data, which is validated against the asset files' sizes and modification times before it is used.
+	class AssetSnapshot {
+	public:
+		/// @brief The magic number found at the start of every asset snapshot.
+		static const uint64_t SNAPSHOT_MAGIC = 0x0050414E53454657; // "WFESNAP\0"
+		/// @brief The version of the asset snapshot format.
+		static const uint32_t SNAPSHOT_VERSION = 1;
+		/// @brief The alignment of every asset's data in the asset snapshot.
+		static const size_t SNAPSHOT_ALIGNMENT = 64;
+
+		/// @brief The header found at the start of every asset snapshot.
+		struct Header {
+			/// @brief The snapshot's magic number, which must be equal to SNAPSHOT_MAGIC.
+			uint64_t magic;
+			/// @brief The version of the snapshot's format.
+			uint32_t version;
+			/// @brief The alignment of every asset's data in the snapshot.
+			uint32_t alignment;
+			/// @brief The number of entries in the snapshot's asset table.
+			uint64_t entryCount;
+			/// @brief The offset in the snapshot at which the asset table starts.
+			uint64_t entriesOffset;
+			/// @brief The total number of dependency IDs in the snapshot.
+			uint64_t dependencyCount;
+			/// @brief The offset in the snapshot at which the dependency IDs start.
+			uint64_t dependenciesOffset;
+			/// @brief The total size of the asset files' paths.
+			uint64_t pathsSize;
+			/// @brief The offset in the snapshot at which the asset files' paths start.
+			uint64_t pathsOffset;
+		};
+		/// @brief An entry in the snapshot's asset table.
+		struct Entry {
+			/// @brief The ID of the asset.
+			uint64_t id;
+			/// @brief The hash of the asset type's file extension.
+			uint64_t typeHash;
+			/// @brief The size of the asset's file when the snapshot was written.
+			uint64_t fileSize;
+			/// @brief The modification time of the asset's file when the snapshot was written.
+			uint64_t fileTime;
+			/// @brief The offset in the snapshot at which the asset's data starts, after its header.
+			uint64_t dataOffset;
+			/// @brief The size of the asset's data.
+			uint64_t dataSize;
+			/// @brief The index of the asset's first dependency ID.
+			uint64_t dependenciesBegin;
+			/// @brief The number of the asset's dependencies.
+			uint32_t dependencyCount;
+			/// @brief The flags from the asset's header.
+			uint32_t flags;
+			/// @brief The offset of the asset file's path in the snapshot's paths, relative to the asset directory.
+			uint64_t pathOffset;
+			/// @brief The size of the asset file's path.
+			uint64_t pathSize;
+		};
+
+		/// @brief Writes an asset snapshot of the given asset files to a temporary file, which then replaces the snapshot, so that existing mappings of the previous snapshot stay valid. Files which aren't assets are skipped.
+		/// @param filePaths A vector containing the paths of every file to add to the snapshot.
+		/// @param rootDir The directory every file path starts with, which isn't saved in the snapshot.
+		/// @param snapshotPath The path of the asset snapshot to write.
+		static void Write(const vector<string>& filePaths, const string& rootDir, const string& snapshotPath);
+
+		/// @brief Opens and maps the given asset snapshot.
+		/// @param snapshotPath The path of the asset snapshot to open.
+		AssetSnapshot(const string& snapshotPath);
+
+		AssetSnapshot() = delete;
+		AssetSnapshot(const AssetSnapshot&) = delete;
+		AssetSnapshot(AssetSnapshot&&) noexcept = delete;
+
+		AssetSnapshot& operator=(const AssetSnapshot&) = delete;
+		AssetSnapshot& operator=(AssetSnapshot&&) = delete;
+
+		/// @brief Checks if the snapshot was mapped and has a valid structure. Missing, partially written and outdated snapshots aren't valid.
+		/// @return True if the snapshot can be used, otherwise false.
+		bool8_t IsOpen() const {
+			return header != nullptr;
+		}
+		/// @brief Gets the asset snapshot's path.
+		/// @return The asset snapshot's path.
+		const string& GetSnapshotPath() const {
+			return snapshotPath;
+		}
+		/// @brief Gets the number of entries in the snapshot's asset table.
+		/// @return The number of assets in the snapshot.
+		size_t GetEntryCount() const {
+			return (size_t)header->entryCount;
+		}
+		/// @brief Gets the snapshot's asset table.
+		/// @return A const pointer to the snapshot's entry array.
+		const Entry* GetEntries() const {
+			return entries;
+		}
+		/// @brief Gets the data of the given entry's asset.
+		/// @param entry The entry whose data to get.
+		/// @return A const pointer to the start of the asset's data in the mapped snapshot.
+		const void* GetEntryData(const Entry& entry) const {
+			return (const char_t*)mappedFile.GetData() + entry.dataOffset;
+		}
+		/// @brief Gets the dependency IDs of the given entry's asset.
+		/// @param entry The entry whose dependencies to get.
+		/// @return A const pointer to the asset's dependency IDs in the mapped snapshot.
+		const uint64_t* GetEntryDependencies(const Entry& entry) const {
+			return dependencies + entry.dependenciesBegin;
+		}
+		/// @brief Gets the path of the given entry's asset file.
+		/// @param entry The entry whose path to get.
+		/// @return The path of the asset's file, relative to the asset directory.
+		string GetEntryPath(const Entry& entry) const {
+			return string(paths + entry.pathOffset, (size_t)entry.pathSize);
+		}
+
+		/// @brief Adds a reference to the snapshot's data, held by every load using the snapshot and every asset loaded in place from it.
+		void Acquire() {
+			++refCount;
+		}
+		/// @brief Removes a reference to the snapshot's data.
+		void Release() {
+			--refCount;
+		}
+		/// @brief Checks if any load or asset still references the snapshot's data.
+		/// @return True if the snapshot is referenced, otherwise false.
+		bool8_t IsInUse() const {
+			return refCount != 0;
+		}
+
+		/// @brief Unmaps the asset snapshot.
+		~AssetSnapshot() = default;
+	private:
+		string snapshotPath;
+		MappedFile mappedFile;
+		const Header* header;
+		const Entry* entries;
+		const uint64_t* dependencies;
+		const char_t* paths;
+		atomic_size_t refCount;
+	};
+}
@@ -0,0 +1,349 @@
+#include "AssetTable.hpp"
+
+#include <thread>
+
+namespace wfe {
+	// Constants
+	static const size_t MIN_TABLE_CAPACITY = 16;
+	static const size_t SHARD_SHIFT = 58;
+
+	// Internal helper functions
+	static uint64_t HashID(uint64_t id) {
+		// Mix the ID's bits using the SplitMix64 finalizer, since most IDs are sequential
+		id ^= id >> 30;
+		id *= 0xBF58476D1CE4E5B9;
+		id ^= id >> 27;
+		id *= 0x94D049BB133111EB;
+		id ^= id >> 31;
+
+		return id;
+	}
+
+	// Internal functions
+	uint64_t AssetTable::WaitForCompaction(const Shard& shard) {
+		// Yield to the writer until any in-place compaction of the shard finishes, instead of spinning on its version
+		uint64_t version = shard.version.load(std::memory_order_acquire);
+		while(version & 1) {
+			std::this_thread::yield();
+			version = shard.version.load(std::memory_order_acquire);
+		}
+
+		return version;
+	}
+	AssetTable::Table* AssetTable::CreateTable(size_t capacity) {
+		// Allocate the table and its slots
+		Table* table = NewObject<Table>();
+		table->capacity = capacity;
+		table->slots = NewArray<Slot>(capacity);
+
+		// Set every slot as empty
+		for(size_t i = 0; i != capacity; ++i) {
+			table->slots[i].key.store(EMPTY_KEY, std::memory_order_relaxed);
+			table->slots[i].value.store(nullptr, std::memory_order_relaxed);
+		}
+
+		return table;
+	}
+	void AssetTable::DestroyTable(Table* table) {
+		// Free the table's slots and the table itself
+		DestroyArray(table->slots, table->capacity);
+		DestroyObject(table);
+	}
+
+	Asset* AssetTable::InternalFind(uint64_t id, bool8_t& found) const {
+		// Get the shard of the given ID
+		uint64_t hash = HashID(id);
+		const Shard& shard = shards[hash >> SHARD_SHIFT];
+
+		while(true) {
+			// Wait for any in-place compaction of the shard to finish
+			uint64_t version = WaitForCompaction(shard);
+
+			// Probe the shard's current table for the given ID
+			const Table* table = shard.table.load(std::memory_order_acquire);
+			size_t mask = table->capacity - 1;
+
+			Asset* asset = nullptr;
+			found = false;
+			for(size_t index = (size_t)hash & mask;; index = (index + 1) & mask) {
+				uint64_t key = table->slots[index].key.load(std::memory_order_acquire);
+				if(key == id) {
+					asset = table->slots[index].value.load(std::memory_order_acquire);
+					found = true;
+					break;
+				}
+				if(key == EMPTY_KEY)
+					break;
+			}
+
+			// Return the result if the shard wasn't compacted during the lookup
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if(shard.version.load(std::memory_order_relaxed) == version)
+				return asset;
+		}
+	}
+	bool8_t AssetTable::InternalInsert(uint64_t id, Asset* asset, bool8_t replace) {
+		// Check if the given ID collides with the reserved keys
+		if(id >= ERASED_KEY)
+			throw Exception("Invalid asset ID!");
+
+		// Get and lock the shard of the given ID
+		uint64_t hash = HashID(id);
+		Shard& shard = shards[hash >> SHARD_SHIFT];
+		shard.mutex.Lock();
+
+		// Insert the asset into the shard
+		bool8_t inserted = InternalInsertLocked(shard, hash, id, asset, replace);
+
+		shard.mutex.Unlock();
+		return inserted;
+	}
+	bool8_t AssetTable::InternalInsertLocked(Shard& shard, uint64_t hash, uint64_t id, Asset* asset, bool8_t replace) {
+		// Look for the given ID or the first empty slot in its probe sequence
+		Table* table = shard.table.load(std::memory_order_relaxed);
+		size_t mask = table->capacity - 1;
+		size_t index = (size_t)hash & mask;
+		for(;; index = (index + 1) & mask) {
+			uint64_t key = table->slots[index].key.load(std::memory_order_relaxed);
+			if(key == id) {
+				// Replace the existing asset, if requested
+				if(replace)
+					table->slots[index].value.store(asset, std::memory_order_release);
+
+				return false;
+			}
+			if(key == EMPTY_KEY)
+				break;
+		}
+
+		// Rehash the shard if the table would become more than three quarters full, then find the new empty slot
+		if((shard.usedCount + 1) * 4 > table->capacity * 3) {
+			InternalRehash(shard);
+
+			table = shard.table.load(std::memory_order_relaxed);
+			mask = table->capacity - 1;
+			for(index = (size_t)hash & mask; table->slots[index].key.load(std::memory_order_relaxed) != EMPTY_KEY; index = (index + 1) & mask);
+		}
+
+		// Write the slot's value before its key, so that readers never see the key without its value
+		table->slots[index].value.store(asset, std::memory_order_relaxed);
+		table->slots[index].key.store(id, std::memory_order_release);
+
+		++shard.usedCount;
+		++shard.liveCount;
+
+		return true;
+	}
+	void AssetTable::InternalRehash(Shard& shard) {
+		Table* table = shard.table.load(std::memory_order_relaxed);
+
+		// Grow the table if it would be more than half full of live entries, otherwise compact its erased slots in place
+		if((shard.liveCount + 1) * 2 > table->capacity) {
+			// Create the new table and copy every live entry to it
+			Table* newTable = CreateTable(table->capacity << 1);
+			size_t mask = newTable->capacity - 1;
+
+			for(size_t i = 0; i != table->capacity; ++i) {
+				uint64_t key = table->slots[i].key.load(std::memory_order_relaxed);
+				if(key == EMPTY_KEY || key == ERASED_KEY)
+					continue;
+				
+				size_t index = (size_t)HashID(key) & mask;
+				for(; newTable->slots[index].key.load(std::memory_order_relaxed) != EMPTY_KEY; index = (index + 1) & mask);
+
+				newTable->slots[index].value.store(table->slots[i].value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+				newTable->slots[index].key.store(key, std::memory_order_relaxed);
+			}
+
+			// Publish the new table; the old table is kept alive, since readers might still be probing it
+			shard.tables.push_back(newTable);
+			shard.table.store(newTable, std::memory_order_release);
+		} else {
+			// Save every live entry
+			vector<uint64_t> keys;
+			vector<Asset*> values;
+			keys.reserve(shard.liveCount);
+			values.reserve(shard.liveCount);
+
+			for(size_t i = 0; i != table->capacity; ++i) {
+				uint64_t key = table->slots[i].key.load(std::memory_order_relaxed);
+				if(key == EMPTY_KEY || key == ERASED_KEY)
+					continue;
+				
+				keys.push_back(key);
+				values.push_back(table->slots[i].value.load(std::memory_order_relaxed));
+			}
+
+			// Mark the shard as being compacted
+			uint64_t version = shard.version.load(std::memory_order_relaxed);
+			shard.version.store(version + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+
+			// Clear the table and reinsert every live entry
+			for(size_t i = 0; i != table->capacity; ++i) {
+				table->slots[i].key.store(EMPTY_KEY, std::memory_order_relaxed);
+				table->slots[i].value.store(nullptr, std::memory_order_relaxed);
+			}
+
+			size_t mask = table->capacity - 1;
+			for(size_t i = 0; i != keys.size(); ++i) {
+				size_t index = (size_t)HashID(keys[i]) & mask;
+				for(; table->slots[index].key.load(std::memory_order_relaxed) != EMPTY_KEY; index = (index + 1) & mask);
+
+				table->slots[index].value.store(values[i], std::memory_order_relaxed);
+				table->slots[index].key.store(keys[i], std::memory_order_relaxed);
+			}
+
+			// Mark the shard's compaction as finished
+			shard.version.store(version + 2, std::memory_order_release);
+		}
+
+		// Every used slot is now live
+		shard.usedCount = shard.liveCount;
+	}
+
+	// Public functions
+	AssetTable::AssetTable() {
+		// Create every shard's starting table
+		for(size_t i = 0; i != SHARD_COUNT; ++i) {
+			Table* table = CreateTable(MIN_TABLE_CAPACITY);
+
+			shards[i].tables.push_back(table);
+			shards[i].table.store(table, std::memory_order_relaxed);
+			shards[i].version.store(0, std::memory_order_relaxed);
+			shards[i].usedCount = 0;
+			shards[i].liveCount = 0;
+		}
+	}
+
+	Asset* AssetTable::Find(uint64_t id) const {
+		bool8_t found;
+		return InternalFind(id, found);
+	}
+	bool8_t AssetTable::Contains(uint64_t id) const {
+		bool8_t found;
+		InternalFind(id, found);
+		return found;
+	}
+	bool8_t AssetTable::Insert(uint64_t id, Asset* asset) {
+		return InternalInsert(id, asset, true);
+	}
+	void AssetTable::InsertBatch(const uint64_t* ids, Asset* const* assets, size_t count) {
+		// Check if any of the given IDs collides with the reserved keys
+		for(size_t i = 0; i != count; ++i)
+			if(ids[i] >= ERASED_KEY)
+				throw Exception("Invalid asset ID!");
+
+		// Sort the assets by shard, so that every shard is locked only once
+		size_t shardBegins[SHARD_COUNT + 1];
+		for(size_t i = 0; i != SHARD_COUNT + 1; ++i)
+			shardBegins[i] = 0;
+		for(size_t i = 0; i != count; ++i)
+			++shardBegins[(HashID(ids[i]) >> SHARD_SHIFT) + 1];
+		for(size_t i = 0; i != SHARD_COUNT; ++i)
+			shardBegins[i + 1] += shardBegins[i];
+
+		size_t shardEnds[SHARD_COUNT];
+		for(size_t i = 0; i != SHARD_COUNT; ++i)
+			shardEnds[i] = shardBegins[i];
+
+		size_t* sortedIndices = NewArray<size_t>(count ? count : 1);
+		for(size_t i = 0; i != count; ++i)
+			sortedIndices[shardEnds[HashID(ids[i]) >> SHARD_SHIFT]++] = i;
+
+		// Insert every shard's assets with the shard's lock held
+		for(size_t i = 0; i != SHARD_COUNT; ++i) {
+			if(shardBegins[i] == shardEnds[i])
+				continue;
+
+			shards[i].mutex.Lock();
+			for(size_t j = shardBegins[i]; j != shardEnds[i]; ++j) {
+				size_t index = sortedIndices[j];
+				InternalInsertLocked(shards[i], HashID(ids[index]), ids[index], assets[index], true);
+			}
+			shards[i].mutex.Unlock();
+		}
+
+		DestroyArray(sortedIndices, count ? count : 1);
+	}
+	bool8_t AssetTable::Reserve(uint64_t id) {
+		return InternalInsert(id, nullptr, false);
+	}
+	bool8_t AssetTable::Erase(uint64_t id, Asset* asset) {
+		// Get and lock the shard of the given ID
+		uint64_t hash = HashID(id);
+		Shard& shard = shards[hash >> SHARD_SHIFT];
+		shard.mutex.Lock();
+
+		// Look for the given ID in its probe sequence
+		Table* table = shard.table.load(std::memory_order_relaxed);
+		size_t mask = table->capacity - 1;
+		for(size_t index = (size_t)hash & mask;; index = (index + 1) & mask) {
+			uint64_t key = table->slots[index].key.load(std::memory_order_relaxed);
+			if(key == EMPTY_KEY)
+				break;
+			if(key != id)
+				continue;
+
+			// Exit the loop if a different asset is stored under the given ID
+			if(table->slots[index].value.load(std::memory_order_relaxed) != asset)
+				break;
+			
+			// Clear the slot's value before marking it as erased; the slot is only reused after the shard is rehashed
+			table->slots[index].value.store(nullptr, std::memory_order_release);
+			table->slots[index].key.store(ERASED_KEY, std::memory_order_release);
+			--shard.liveCount;
+
+			shard.mutex.Unlock();
+			return true;
+		}
+
+		shard.mutex.Unlock();
+		return false;
+	}
+	void AssetTable::CollectAssets(vector<Asset*>& assets) const {
+		for(size_t i = 0; i != SHARD_COUNT; ++i) {
+			const Shard& shard = shards[i];
+			size_t oldSize = assets.size();
+
+			while(true) {
+				// Wait for any in-place compaction of the shard to finish
+				uint64_t version = WaitForCompaction(shard);
+
+				// Add every asset in the shard's table to the vector
+				const Table* table = shard.table.load(std::memory_order_acquire);
+				for(size_t index = 0; index != table->capacity; ++index) {
+					uint64_t key = table->slots[index].key.load(std::memory_order_acquire);
+					if(key == EMPTY_KEY || key == ERASED_KEY)
+						continue;
+					
+					Asset* asset = table->slots[index].value.load(std::memory_order_acquire);
+					if(asset)
+						assets.push_back(asset);
+				}
+
+				// Exit the loop if the shard wasn't compacted in the meantime, otherwise retry
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if(shard.version.load(std::memory_order_relaxed) == version)
+					break;
+				assets.resize(oldSize);
+			}
+		}
+	}
+
+	uint64_t AssetTable::GetLockWaitTime() const {
+		// Add up the wait times of every shard's lock
+		uint64_t waitTime = 0;
+		for(size_t i = 0; i != SHARD_COUNT; ++i)
+			waitTime += shards[i].mutex.GetWaitTime();
+
+		return waitTime;
+	}
+
+	AssetTable::~AssetTable() {
+		// Destroy every table ever created by the shards
+		for(size_t i = 0; i != SHARD_COUNT; ++i)
+			for(Table* table : shards[i].tables)
+				DestroyTable(table);
+	}
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "AssetMutex.hpp"
+
+#include <Core.hpp>
+#include <atomic>
+
+namespace wfe {
+	class Asset;
+
+	/// @brief A concurrent map from asset IDs to assets, split into shards whose lookups never take a lock. Lookups are lock-free but not wait-free: a lookup which overlaps an in-place compaction of its shard yields until the compaction finishes, then retries.
+	class AssetTable {
+	public:
+		/// @brief The number of shards in the table.
+		static const size_t SHARD_COUNT = 64;
+		/// @brief The key value of empty slots, which can't be used as an asset ID.
+		static const uint64_t EMPTY_KEY = UINT64_T_MAX;
+		/// @brief The key value of erased slots, which can't be used as an asset ID.
+		static const uint64_t ERASED_KEY = UINT64_T_MAX - 1;
+
+		/// @brief Creates an empty asset table.
+		AssetTable();
+		AssetTable(const AssetTable&) = delete;
+		AssetTable(AssetTable&&) noexcept = delete;
+
+		AssetTable& operator=(const AssetTable&) = delete;
+		AssetTable& operator=(AssetTable&&) = delete;
+
+		/// @brief Finds the asset with the given ID without taking any lock, yielding while the ID's shard is being compacted.
+		/// @param id The ID of the asset to find.
+		/// @return A pointer to the asset with the given ID, or nullptr if no such asset exists or the ID is only reserved.
+		Asset* Find(uint64_t id) const;
+		/// @brief Checks if the given ID is used by an asset or reserved.
+		/// @param id The ID to check.
+		/// @return True if the ID is in the table, otherwise false.
+		bool8_t Contains(uint64_t id) const;
+		/// @brief Inserts the given asset into the table, replacing the asset with the same ID if one exists.
+		/// @param id The ID of the asset to insert.
+		/// @param asset A pointer to the asset to insert.
+		/// @return True if the ID wasn't in the table before, otherwise false.
+		bool8_t Insert(uint64_t id, Asset* asset);
+		/// @brief Inserts the given assets into the table, replacing the assets with the same IDs, locking every shard only once.
+		/// @param ids An array of the IDs of the assets to insert.
+		/// @param assets An array of pointers to the assets to insert.
+		/// @param count The number of assets to insert.
+		void InsertBatch(const uint64_t* ids, Asset* const* assets, size_t count);
+		/// @brief Reserves the given ID, if it isn't already in the table.
+		/// @param id The ID to reserve.
+		/// @return True if the ID wasn't in the table before, otherwise false.
+		bool8_t Reserve(uint64_t id);
+		/// @brief Erases the given asset from the table, if it is the asset currently stored under its ID.
+		/// @param id The ID of the asset to erase.
+		/// @param asset A pointer to the asset to erase.
+		/// @return True if the asset was erased, otherwise false.
+		bool8_t Erase(uint64_t id, Asset* asset);
+		/// @brief Appends every asset in the table to the given vector.
+		/// @param assets The vector to append the assets to.
+		void CollectAssets(vector<Asset*>& assets) const;
+		/// @brief Gets the total time threads spent waiting for the table's shard locks.
+		/// @return The total wait time, in nanoseconds.
+		uint64_t GetLockWaitTime() const;
+
+		/// @brief Destroys the asset table.
+		~AssetTable();
+	private:
+		struct Slot {
+			std::atomic<uint64_t> key;
+			std::atomic<Asset*> value;
+		};
+		struct Table {
+			size_t capacity;
+			Slot* slots;
+		};
+		struct alignas(64) Shard {
+			std::atomic<Table*> table;
+			std::atomic<uint64_t> version;
+			AssetMutex mutex;
+			size_t usedCount;
+			size_t liveCount;
+			vector<Table*> tables;
+		};
+
+		static uint64_t WaitForCompaction(const Shard& shard);
+		static Table* CreateTable(size_t capacity);
+		static void DestroyTable(Table* table);
+
+		Asset* InternalFind(uint64_t id, bool8_t& found) const;
+		bool8_t InternalInsert(uint64_t id, Asset* asset, bool8_t replace);
+		bool8_t InternalInsertLocked(Shard& shard, uint64_t hash, uint64_t id, Asset* asset, bool8_t replace);
+		void InternalRehash(Shard& shard);
+
+		Shard shards[SHARD_COUNT];
+	};
+}
@@ -0,0 +1,227 @@
+#include "AssetTelemetry.hpp"
+
+#include <chrono>
+#include <stdio.h>
+
+namespace wfe {
+	// Internal helper functions
+	static void AppendJSONString(string& str, const string& value) {
+		// Append the value between quotes, escaping every character JSON doesn't allow in strings
+		str.push_back('"');
+		for(char_t c : value) {
+			if(c == '"' || c == '\\') {
+				str.push_back('\\');
+				str.push_back(c);
+			} else if((unsigned char)c < 0x20) {
+				char_t escaped[8];
+				snprintf(escaped, sizeof(escaped), "\\u%04x", (uint32_t)(unsigned char)c);
+				str += escaped;
+			} else {
+				str.push_back(c);
+			}
+		}
+		str.push_back('"');
+	}
+	static void AppendCSVString(string& str, const string& value) {
+		// Append the value between quotes, doubling every quote inside it
+		str.push_back('"');
+		for(char_t c : value) {
+			if(c == '"')
+				str.push_back('"');
+			str.push_back(c);
+		}
+		str.push_back('"');
+	}
+	static bool8_t WriteTextFile(const string& filePath, const string& text) {
+		// Write the text to the file, replacing its contents
+		FileOutput fileOutput(filePath, FileOutput::STREAM_TYPE_BINARY);
+		if(!fileOutput.IsOpen())
+			return false;
+
+		fileOutput.WriteBuffer(text.size(), text.c_str());
+		fileOutput.Close();
+
+		return true;
+	}
+
+	// Public functions
+	uint64_t AssetTelemetry::GetTime() {
+		// Get the steady clock's time in nanoseconds
+		return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	AssetTelemetry::AssetTelemetry() : enabled(true), startTime(GetTime()) { }
+
+	void AssetTelemetry::AddRecord(const AssetLoadRecord& record) {
+		mutex.Lock();
+
+		// Make the record's start time relative to the telemetry's start time
+		AssetLoadRecord newRecord = record;
+		newRecord.startTime = record.startTime > startTime ? record.startTime - startTime : 0;
+
+		// Replace the asset's previous record, keeping its retry count, or add a new record
+		auto indexIter = recordIndices.find(record.id);
+		if(indexIter != recordIndices.end()) {
+			newRecord.retryCount += records[indexIter->second].retryCount;
+			records[indexIter->second] = newRecord;
+		} else {
+			recordIndices.insert({ record.id, records.size() });
+			records.push_back(newRecord);
+		}
+
+		// Find or add the stats of the record's asset type
+		AssetTypeLoadStats* stats = nullptr;
+		for(auto& typeStat : typeStats) {
+			if(typeStat.typeName == record.typeName) {
+				stats = &typeStat;
+				break;
+			}
+		}
+		if(!stats) {
+			typeStats.push_back({
+				.typeName = record.typeName,
+				.loadCount = 0,
+				.failedCount = 0,
+				.retryCount = 0,
+				.bytesRead = 0,
+				.dependencyWaitTime = 0,
+				.openTime = 0,
+				.readTime = 0,
+				.parseTime = 0,
+				.maxLoadTime = 0
+			});
+			stats = &typeStats.back();
+		}
+
+		// Add the record to its type's stats
+		if(record.loaded)
+			++stats->loadCount;
+		else
+			++stats->failedCount;
+		stats->retryCount += record.retryCount;
+		stats->bytesRead += record.bytesRead;
+		stats->dependencyWaitTime += record.dependencyWaitTime;
+		stats->openTime += record.openTime;
+		stats->readTime += record.readTime;
+		stats->parseTime += record.parseTime;
+
+		uint64_t loadTime = record.openTime + record.readTime + record.parseTime;
+		if(loadTime > stats->maxLoadTime)
+			stats->maxLoadTime = loadTime;
+
+		mutex.Unlock();
+	}
+	bool8_t AssetTelemetry::GetRecord(uint64_t id, AssetLoadRecord& record) const {
+		mutex.Lock();
+
+		// Look for the asset's record
+		auto indexIter = recordIndices.find(id);
+		bool8_t found = indexIter != recordIndices.end();
+		if(found)
+			record = records[indexIter->second];
+
+		mutex.Unlock();
+
+		return found;
+	}
+	vector<AssetLoadRecord> AssetTelemetry::GetRecords() const {
+		// Copy every record
+		mutex.Lock();
+		vector<AssetLoadRecord> recordsCopy = records;
+		mutex.Unlock();
+
+		return recordsCopy;
+	}
+	vector<AssetTypeLoadStats> AssetTelemetry::GetTypeStats() const {
+		// Copy every type's stats
+		mutex.Lock();
+		vector<AssetTypeLoadStats> typeStatsCopy = typeStats;
+		mutex.Unlock();
+
+		return typeStatsCopy;
+	}
+	void AssetTelemetry::Clear() {
+		// Remove every record and restart the telemetry's clock
+		mutex.Lock();
+
+		records.clear();
+		recordIndices.clear();
+		typeStats.clear();
+		startTime = GetTime();
+
+		mutex.Unlock();
+	}
+
+	bool8_t AssetTelemetry::ExportChromeTrace(const string& filePath) const {
+		vector<AssetLoadRecord> recordsCopy = GetRecords();
+
+		// Write every record as a complete event on its worker thread's track, with its dependency wait as an async event on the asset's own track
+		string trace = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+		char_t buffer[256];
+		bool8_t first = true;
+
+		for(const auto& record : recordsCopy) {
+			double start = record.startTime / 1000.0;
+			double loadTime = (record.openTime + record.readTime + record.parseTime) / 1000.0;
+
+			if(!first)
+				trace.push_back(',');
+			first = false;
+
+			trace += "\n{\"name\":";
+			AppendJSONString(trace, record.filePath);
+			trace += ",\"cat\":";
+			AppendJSONString(trace, record.typeName);
+			snprintf(buffer, sizeof(buffer), ",\"ph\":\"X\",\"pid\":1,\"tid\":%llu,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"id\":%llu,\"bytes_read\":%llu,\"open_us\":%.3f,\"read_us\":%.3f,\"parse_us\":%.3f,\"dependency_wait_us\":%.3f,\"queue_us\":%.3f,\"retries\":%u,\"loaded\":%s}}",
+				(unsigned long long)record.threadID, start, loadTime,
+				(unsigned long long)record.id, (unsigned long long)record.bytesRead,
+				record.openTime / 1000.0, record.readTime / 1000.0, record.parseTime / 1000.0,
+				record.dependencyWaitTime / 1000.0, record.queueTime / 1000.0,
+				record.retryCount, record.loaded ? "true" : "false");
+			trace += buffer;
+
+			// Skip the dependency wait if the asset had to wait for none of its dependencies
+			if(!record.dependencyWaitTime)
+				continue;
+
+			double waitEnd = (record.startTime > record.queueTime ? record.startTime - record.queueTime : 0) / 1000.0;
+			double waitStart = waitEnd - record.dependencyWaitTime / 1000.0;
+			if(waitStart < 0.0)
+				waitStart = 0.0;
+
+			for(size_t i = 0; i != 2; ++i) {
+				trace += ",\n{\"name\":";
+				AppendJSONString(trace, record.filePath);
+				snprintf(buffer, sizeof(buffer), ",\"cat\":\"dependency wait\",\"ph\":\"%c\",\"pid\":1,\"id\":\"0x%llx\",\"ts\":%.3f}", i ? 'e' : 'b', (unsigned long long)record.id, i ? waitEnd : waitStart);
+				trace += buffer;
+			}
+		}
+
+		trace += "\n]}\n";
+
+		return WriteTextFile(filePath, trace);
+	}
+	bool8_t AssetTelemetry::ExportCSV(const string& filePath) const {
+		vector<AssetLoadRecord> recordsCopy = GetRecords();
+
+		// Write the header and one row for every record
+		string csv = "id,type,file,thread,start_us,dependency_wait_us,queue_us,open_us,read_us,parse_us,bytes_read,retries,loaded\n";
+		char_t buffer[256];
+
+		for(const auto& record : recordsCopy) {
+			snprintf(buffer, sizeof(buffer), "%llu,", (unsigned long long)record.id);
+			csv += buffer;
+			AppendCSVString(csv, record.typeName);
+			csv.push_back(',');
+			AppendCSVString(csv, record.filePath);
+			snprintf(buffer, sizeof(buffer), ",%llu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%llu,%u,%u\n",
+				(unsigned long long)record.threadID, record.startTime / 1000.0,
+				record.dependencyWaitTime / 1000.0, record.queueTime / 1000.0,
+				record.openTime / 1000.0, record.readTime / 1000.0, record.parseTime / 1000.0,
+				(unsigned long long)record.bytesRead, record.retryCount, (uint32_t)record.loaded);
+			csv += buffer;
+		}
+
+		return WriteTextFile(filePath, csv);
+	}
+}
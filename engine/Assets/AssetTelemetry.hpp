@@ -0,0 +1,125 @@
+#pragma once
+
+#include "AssetMutex.hpp"
+
+#include <Core.hpp>
+
+namespace wfe {
+	/// @brief A struct containing the telemetry of an asset's latest load.
+	struct AssetLoadRecord {
+		/// @brief The ID of the asset.
+		uint64_t id;
+		/// @brief The name of the asset's type.
+		string typeName;
+		/// @brief The path of the asset's file, or the name of the asset pack it was loaded from.
+		string filePath;
+		/// @brief The ID of the worker thread which loaded the asset.
+		Thread::ThreadID threadID;
+		/// @brief The time the asset's load started, in nanoseconds since the telemetry was created or cleared.
+		uint64_t startTime;
+		/// @brief The time spent waiting for the asset's dependencies to load, and for its asynchronous read to finish, before the asset could be scheduled, in nanoseconds.
+		uint64_t dependencyWaitTime;
+		/// @brief The time between the asset's dependencies finishing and a worker thread starting its load, in nanoseconds.
+		uint64_t queueTime;
+		/// @brief The time spent opening or mapping the asset's file, in nanoseconds.
+		uint64_t openTime;
+		/// @brief The time spent reading and decompressing the asset's data, in nanoseconds. For assets read by the manager's asynchronous file reader, the read time is measured from the moment the read was queued until it finished.
+		uint64_t readTime;
+		/// @brief The time spent in the asset's LoadAsset function, excluding reads from its file, in nanoseconds.
+		uint64_t parseTime;
+		/// @brief The number of bytes of asset data read from the asset's file or pack.
+		uint64_t bytesRead;
+		/// @brief The number of times the asset's LoadAsset function returned false, across every load of the asset.
+		uint32_t retryCount;
+		/// @brief True if the asset's latest load succeeded, otherwise false.
+		bool8_t loaded;
+	};
+
+	/// @brief A struct containing the load telemetry of every asset with the same type.
+	struct AssetTypeLoadStats {
+		/// @brief The name of the asset type.
+		string typeName;
+		/// @brief The number of loads which succeeded.
+		size_t loadCount;
+		/// @brief The number of loads which failed.
+		size_t failedCount;
+		/// @brief The number of times LoadAsset returned false.
+		size_t retryCount;
+		/// @brief The total number of bytes read.
+		uint64_t bytesRead;
+		/// @brief The total time spent waiting for dependencies, in nanoseconds.
+		uint64_t dependencyWaitTime;
+		/// @brief The total time spent opening files, in nanoseconds.
+		uint64_t openTime;
+		/// @brief The total time spent reading and decompressing data, in nanoseconds.
+		uint64_t readTime;
+		/// @brief The total time spent parsing data, in nanoseconds.
+		uint64_t parseTime;
+		/// @brief The longest time spent loading a single asset, excluding its dependency wait, in nanoseconds.
+		uint64_t maxLoadTime;
+	};
+
+	/// @brief Records the telemetry of every asset load performed by an asset manager, which can be queried at runtime or exported as a Chrome trace or a CSV file.
+	class AssetTelemetry {
+	public:
+		/// @brief Gets the current time of the clock used by the telemetry.
+		/// @return The current time, in nanoseconds.
+		static uint64_t GetTime();
+
+		/// @brief Creates an enabled asset telemetry recorder.
+		AssetTelemetry();
+		AssetTelemetry(const AssetTelemetry&) = delete;
+		AssetTelemetry(AssetTelemetry&&) noexcept = delete;
+
+		AssetTelemetry& operator=(const AssetTelemetry&) = delete;
+		AssetTelemetry& operator=(AssetTelemetry&&) = delete;
+
+		/// @brief Checks if loads are being recorded.
+		/// @return True if the telemetry is enabled, otherwise false.
+		bool8_t IsEnabled() const {
+			return enabled.load(std::memory_order_relaxed);
+		}
+		/// @brief Sets whether loads are recorded. Loads which are already running may still be recorded.
+		/// @param enabled True to record loads, otherwise false.
+		void SetEnabled(bool8_t enabled) {
+			this->enabled.store(enabled, std::memory_order_relaxed);
+		}
+
+		/// @brief Adds the given load record, replacing the previous record of the same asset. The record's retry count is added to the previous record's.
+		/// @param record The record to add, whose start time is the clock's absolute time.
+		void AddRecord(const AssetLoadRecord& record);
+		/// @brief Gets the latest load record of the given asset.
+		/// @param id The ID of the asset.
+		/// @param record A reference to the struct in which the record will be written.
+		/// @return True if the asset has a load record, otherwise false.
+		bool8_t GetRecord(uint64_t id, AssetLoadRecord& record) const;
+		/// @brief Gets the latest load record of every asset.
+		/// @return A vector containing every load record, in the order the assets were first loaded.
+		vector<AssetLoadRecord> GetRecords() const;
+		/// @brief Gets the load telemetry of every asset type, aggregated over every recorded load.
+		/// @return A vector containing the stats of every asset type with at least one recorded load.
+		vector<AssetTypeLoadStats> GetTypeStats() const;
+		/// @brief Removes every record and resets the time the records' start times are relative to.
+		void Clear();
+
+		/// @brief Writes every load record to a Chrome trace file, which can be opened with chrome://tracing or Perfetto. Every load is shown on its worker thread's track, and every dependency wait on the asset's own async track.
+		/// @param filePath The path of the trace file to write.
+		/// @return True if the file was written, otherwise false.
+		bool8_t ExportChromeTrace(const string& filePath) const;
+		/// @brief Writes every load record to a CSV file, with one row per asset.
+		/// @param filePath The path of the CSV file to write.
+		/// @return True if the file was written, otherwise false.
+		bool8_t ExportCSV(const string& filePath) const;
+
+		/// @brief Destroys the asset telemetry recorder.
+		~AssetTelemetry() = default;
+	private:
+		std::atomic<bool8_t> enabled;
+		uint64_t startTime;
+
+		AssetMutex mutex;
+		vector<AssetLoadRecord> records;
+		unordered_map<uint64_t, size_t> recordIndices;
+		vector<AssetTypeLoadStats> typeStats;
+	};
+}
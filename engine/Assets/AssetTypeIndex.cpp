@@ -0,0 +1,136 @@
+#include "AssetTypeIndex.hpp"
+#include "Asset.hpp"
+
+#include <typeinfo>
+
+namespace wfe {
+	// Internal functions
+	void AssetTypeIndex::InternalInsert(Asset* asset, size_t typeIndex) {
+		// Add a page to the type's list if the last page is full
+		TypeList& list = lists[typeIndex];
+		size_t index = list.count.load(std::memory_order_relaxed);
+		if(!(index & PAGE_MASK)) {
+			if(!list.pages[index >> PAGE_SHIFT].load(std::memory_order_relaxed)) {
+				std::atomic<Asset*>* page = NewArray<std::atomic<Asset*>>(PAGE_SIZE);
+				for(size_t i = 0; i != PAGE_SIZE; ++i)
+					page[i].store(nullptr, std::memory_order_relaxed);
+
+				list.pages[index >> PAGE_SHIFT].store(page, std::memory_order_release);
+			}
+		}
+
+		// Append the asset to the list, publishing it before the new size
+		InternalGetEntry(list, index).store(asset, std::memory_order_release);
+		asset->typeIndex = typeIndex;
+		asset->typeListIndex = index;
+		list.count.store(index + 1, std::memory_order_release);
+	}
+
+	// Public functions
+	AssetTypeIndex::AssetTypeIndex() : lists(nullptr), typeCount(Asset::GetAssetTypes().size()) {
+		// Create an empty list for every registered asset type
+		if(!typeCount)
+			return;
+
+		lists = NewArray<TypeList>(typeCount);
+		for(size_t i = 0; i != typeCount; ++i) {
+			for(size_t j = 0; j != MAX_PAGE_COUNT; ++j)
+				lists[i].pages[j].store(nullptr, std::memory_order_relaxed);
+			lists[i].count.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	void AssetTypeIndex::Insert(Asset* asset) {
+		// Find the asset's type. Assets are listed under their exact class, so an unregistered class can't be listed under a registered base
+		size_t typeIndex = Asset::FindAssetTypeIndex(typeid(*asset));
+		if(typeIndex >= typeCount)
+			throw Exception("Asset class %s isn't a registered asset type!", typeid(*asset).name());
+
+		mutex.Lock();
+
+		// Check if the type's list has room left before changing it
+		if(lists[typeIndex].count.load(std::memory_order_relaxed) == PAGE_SIZE * MAX_PAGE_COUNT) {
+			mutex.Unlock();
+			throw Exception("Ran out of asset type list entries!");
+		}
+
+		InternalInsert(asset, typeIndex);
+		mutex.Unlock();
+	}
+	void AssetTypeIndex::InsertBatch(Asset* const* assets, size_t count) {
+		// Find every asset's type and count the assets of every type before taking the lock, failing the whole batch if any asset's class isn't registered
+		size_t* typeIndices = NewArray<size_t>(count ? count : 1);
+		size_t* typeInsertCounts = NewArray<size_t>(typeCount ? typeCount : 1);
+		for(size_t i = 0; i != typeCount; ++i)
+			typeInsertCounts[i] = 0;
+		for(size_t i = 0; i != count; ++i) {
+			typeIndices[i] = Asset::FindAssetTypeIndex(typeid(*assets[i]));
+			if(typeIndices[i] >= typeCount) {
+				DestroyArray(typeIndices, count ? count : 1);
+				DestroyArray(typeInsertCounts, typeCount ? typeCount : 1);
+				throw Exception("Asset class %s isn't a registered asset type!", typeid(*assets[i]).name());
+			}
+
+			++typeInsertCounts[typeIndices[i]];
+		}
+
+		mutex.Lock();
+
+		// Check if every type's list has room for its assets before changing any list, so that the batch is never partly inserted
+		for(size_t i = 0; i != typeCount; ++i) {
+			if(typeInsertCounts[i] <= PAGE_SIZE * MAX_PAGE_COUNT - lists[i].count.load(std::memory_order_relaxed))
+				continue;
+
+			mutex.Unlock();
+			DestroyArray(typeIndices, count ? count : 1);
+			DestroyArray(typeInsertCounts, typeCount ? typeCount : 1);
+			throw Exception("Ran out of asset type list entries!");
+		}
+
+		for(size_t i = 0; i != count; ++i)
+			InternalInsert(assets[i], typeIndices[i]);
+		mutex.Unlock();
+
+		DestroyArray(typeIndices, count ? count : 1);
+		DestroyArray(typeInsertCounts, typeCount ? typeCount : 1);
+	}
+	void AssetTypeIndex::Remove(Asset* asset) {
+		// Exit the function if the asset was never added
+		if(asset->typeIndex >= typeCount)
+			return;
+
+		mutex.Lock();
+
+		// Move the last asset in the type's list into the removed asset's place
+		TypeList& list = lists[asset->typeIndex];
+		size_t lastIndex = list.count.load(std::memory_order_relaxed) - 1;
+		Asset* lastAsset = InternalGetEntry(list, lastIndex).load(std::memory_order_relaxed);
+
+		InternalGetEntry(list, asset->typeListIndex).store(lastAsset, std::memory_order_release);
+		lastAsset->typeListIndex = asset->typeListIndex;
+
+		// Clear the last entry and shrink the list, keeping its pages for later inserts
+		InternalGetEntry(list, lastIndex).store(nullptr, std::memory_order_release);
+		list.count.store(lastIndex, std::memory_order_release);
+
+		asset->typeIndex = SIZE_T_MAX;
+
+		mutex.Unlock();
+	}
+
+	AssetTypeIndex::~AssetTypeIndex() {
+		// Free every allocated page and the lists
+		if(!lists)
+			return;
+
+		for(size_t i = 0; i != typeCount; ++i) {
+			for(size_t j = 0; j != MAX_PAGE_COUNT; ++j) {
+				std::atomic<Asset*>* page = lists[i].pages[j].load(std::memory_order_relaxed);
+				if(page)
+					DestroyArray(page, PAGE_SIZE);
+			}
+		}
+
+		DestroyArray(lists, typeCount);
+	}
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "AssetMutex.hpp"
+
+#include <Core.hpp>
+#include <atomic>
+
+namespace wfe {
+	class Asset;
+
+	/// @brief Keeps a dense list of assets for every registered asset type, updated on every insert and removal, which can be iterated without taking a lock.
+	class AssetTypeIndex {
+	public:
+		/// @brief The number of assets in every page of a type's list.
+		static const size_t PAGE_SIZE = 0x400;
+		/// @brief The maximum number of pages in a type's list.
+		static const size_t MAX_PAGE_COUNT = 0x400;
+
+		/// @brief Creates an asset type index with an empty list for every asset type registered so far.
+		AssetTypeIndex();
+		AssetTypeIndex(const AssetTypeIndex&) = delete;
+		AssetTypeIndex(AssetTypeIndex&&) noexcept = delete;
+
+		AssetTypeIndex& operator=(const AssetTypeIndex&) = delete;
+		AssetTypeIndex& operator=(AssetTypeIndex&&) = delete;
+
+		/// @brief Gets the number of asset types in the index.
+		/// @return The number of type lists.
+		size_t GetTypeCount() const {
+			return typeCount;
+		}
+		/// @brief Gets the number of assets with the given type.
+		/// @param typeIndex The index of the asset type.
+		/// @return The number of assets in the type's list.
+		size_t GetCount(size_t typeIndex) const {
+			return lists[typeIndex].count.load(std::memory_order_acquire);
+		}
+		/// @brief Gets the first asset with the given type, which can be used to check the C++ class every asset in the type's list has.
+		/// @param typeIndex The index of the asset type.
+		/// @return A pointer to the first asset in the type's list, or nullptr if the list is empty.
+		Asset* GetFirst(size_t typeIndex) const {
+			const TypeList& list = lists[typeIndex];
+			if(!list.count.load(std::memory_order_acquire))
+				return nullptr;
+
+			return list.pages[0].load(std::memory_order_acquire)[0].load(std::memory_order_acquire);
+		}
+
+		/// @brief Adds the given asset to the list of its type. Every list holds assets of exactly one class, so assets whose class isn't registered or was registered after the index was created are rejected with an exception.
+		/// @param asset A pointer to the asset to add.
+		void Insert(Asset* asset);
+		/// @brief Adds the given assets to the lists of their types, taking the index's lock only once. No asset is added if any asset's class isn't registered.
+		/// @param assets An array of pointers to the assets to add.
+		/// @param count The number of assets to add.
+		void InsertBatch(Asset* const* assets, size_t count);
+		/// @brief Removes the given asset from the list of its type, if it was added to it.
+		/// @param asset A pointer to the asset to remove.
+		void Remove(Asset* asset);
+		/// @brief Calls the given function for every asset with the given type, without taking any lock. Assets inserted or removed during the iteration may be skipped, and an asset moved by a concurrent removal may be visited twice.
+		/// @tparam F The type of the function.
+		/// @param typeIndex The index of the asset type.
+		/// @param func The function to call with a pointer to every asset.
+		template<class F>
+		void ForEach(size_t typeIndex, F&& func) const {
+			// Read the list's size once, then read every asset in its pages, which are never freed while the index exists
+			const TypeList& list = lists[typeIndex];
+			size_t count = list.count.load(std::memory_order_acquire);
+
+			for(size_t i = 0; i != count; ++i) {
+				const std::atomic<Asset*>* page = list.pages[i >> PAGE_SHIFT].load(std::memory_order_acquire);
+				Asset* asset = page[i & PAGE_MASK].load(std::memory_order_acquire);
+				if(asset)
+					func(asset);
+			}
+		}
+
+		/// @brief Gets the total time threads spent waiting for the index's lock.
+		/// @return The total wait time, in nanoseconds.
+		uint64_t GetLockWaitTime() const {
+			return mutex.GetWaitTime();
+		}
+
+		/// @brief Destroys the asset type index.
+		~AssetTypeIndex();
+	private:
+		static const size_t PAGE_SHIFT = 10;
+		static const size_t PAGE_MASK = PAGE_SIZE - 1;
+
+		struct TypeList {
+			std::atomic<std::atomic<Asset*>*> pages[MAX_PAGE_COUNT];
+			std::atomic<size_t> count;
+		};
+
+		void InternalInsert(Asset* asset, size_t typeIndex);
+		std::atomic<Asset*>& InternalGetEntry(TypeList& list, size_t index) {
+			return list.pages[index >> PAGE_SHIFT].load(std::memory_order_relaxed)[index & PAGE_MASK];
+		}
+
+		TypeList* lists;
+		size_t typeCount;
+
+		AssetMutex mutex;
+	};
+}
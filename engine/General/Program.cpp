@@ -1,8 +1,39 @@
 #include "Program.hpp"
 #include "ProjectInfo.hpp"
+#include "Renderer/Vulkan/VulkanRenderer.hpp"
 #include <unistd.h>
 
 namespace wfe {
+	// Constants
+	static const size_t HIGH_PRESSURE_TRIM_PERCENT = 75;
+	static const size_t CRITICAL_PRESSURE_TRIM_PERCENT = 50;
+	static const MemoryUsageType GPU_ASSET_MEMORY_USAGE_TYPE = MEMORY_USAGE_TYPE_RENDERER;
+
+	// Memory pressure callback
+	static void* MemoryPressureEventCallback(void* args, void* userData) {
+		// Exit the function if the renderer isn't using Vulkan
+		Program* program = (Program*)userData;
+		if(program->GetRenderer()->GetRendererBackendAPI() != Renderer::RENDERER_BACKEND_API_VULKAN)
+			return nullptr;
+
+		// Exit the function unless the heap's pressure rose, or if the heap isn't device local, since evicting assets frees no host-only heap memory
+		VulkanAllocator::MemoryPressureEventInfo* info = (VulkanAllocator::MemoryPressureEventInfo*)args;
+		if(info->newPressure <= info->oldPressure)
+			return nullptr;
+
+		const VulkanAllocator* allocator = ((VulkanRenderer*)program->GetRenderer()->GetRendererBackend())->GetAllocator();
+		if(!(allocator->GetMemoryProperties().memoryHeaps[info->heapIndex].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT))
+			return nullptr;
+
+		// Evict the unreferenced assets whose data lives in GPU memory once the heap's pressure rises to high or critical, so that the driver doesn't have to page GPU memory out
+		if(info->newPressure == VulkanAllocator::MEMORY_PRESSURE_CRITICAL)
+			program->GetAssetManager()->GetResidency().Trim(CRITICAL_PRESSURE_TRIM_PERCENT, GPU_ASSET_MEMORY_USAGE_TYPE);
+		else if(info->newPressure == VulkanAllocator::MEMORY_PRESSURE_HIGH)
+			program->GetAssetManager()->GetResidency().Trim(HIGH_PRESSURE_TRIM_PERCENT, GPU_ASSET_MEMORY_USAGE_TYPE);
+
+		return nullptr;
+	}
+
 	// Window close callback
 	static void* WindowCloseEventCallback(void* args, void* userData) {
 		// Close the current program
@@ -35,12 +66,13 @@ namespace wfe {
 		// Create the renderer
 		renderer = NewObject<Renderer>(window, true, logger);
 
-		// Create the asset manager and load the main asset dir
-		assetManager = NewObject<AssetManager>("assets/", this);
-		assetManager->LoadAssets("main/");
+		// Create the asset manager and start loading the main asset dir in the background
+		assetManager = NewObject<AssetManager>("assets/", jobManager);
+		mainAssetLoad = assetManager->LoadAssetsAsync("main/");
 
-		// Add the window close event callback
+		// Add the window close and memory pressure event callbacks
 		window->GetCloseEvent().AddListener(Event::Listener(WindowCloseEventCallback, this));
+		renderer->GetMemoryPressureEvent().AddListener(Event::Listener(MemoryPressureEventCallback, this));
 	}
 
 	int32_t Program::Run() {
@@ -49,6 +81,29 @@ namespace wfe {
 			// Poll the window's events
 			window->PollEvents();
 
+			// Check if the main asset dir finished loading
+			if(mainAssetLoad && mainAssetLoad->IsFinished()) {
+				size_t failedCount = mainAssetLoad->GetFailedCount();
+				DestroyObject(mainAssetLoad);
+				mainAssetLoad = nullptr;
+
+				if(failedCount)
+					throw Exception("Failed to load one or more assets from the main asset dir!");
+
+#ifdef WFE_ENABLE_HOT_RELOAD
+				// Start watching the asset dir for modified assets
+				assetManager->EnableHotReload();
+#endif
+			}
+
+#ifdef WFE_ENABLE_HOT_RELOAD
+			// Reload the modified assets
+			assetManager->PollHotReload();
+#endif
+
+			// Update the GPU memory budgets, shedding assets if the memory pressure rose
+			renderer->UpdateMemoryBudget();
+
 			sleep(0);
 		}
 
@@ -61,10 +116,13 @@ namespace wfe {
 	}
 
 	Program::~Program() {
-		// Remove the window close event callback
+		// Remove the window close and memory pressure event callbacks
 		window->GetCloseEvent().RemoveListener(Event::Listener(WindowCloseEventCallback, this));
+		renderer->GetMemoryPressureEvent().RemoveListener(Event::Listener(MemoryPressureEventCallback, this));
 
-		// Destroy all child objects
+		// Destroy all child objects, waiting for the main asset dir to finish loading first
+		if(mainAssetLoad)
+			DestroyObject(mainAssetLoad);
 		DestroyObject(assetManager);
 		DestroyObject(renderer);
 		DestroyObject(window);
@@ -7,6 +7,7 @@
 #include <Core.hpp>
 
 namespace wfe {
+	class AssetLoadHandle;
 	class AssetManager;
 
 	/// @brief A class containing an abstraction for the program and its components.
@@ -80,6 +81,17 @@ namespace wfe {
 			return assetManager;
 		}
 
+		/// @brief Gets the handle of the main asset directory's load.
+		/// @return A pointer to the main asset load's handle, or nullptr if the load already finished.
+		AssetLoadHandle* GetMainAssetLoad() {
+			return mainAssetLoad;
+		}
+		/// @brief Gets the handle of the main asset directory's load.
+		/// @return A const pointer to the main asset load's handle, or nullptr if the load already finished.
+		const AssetLoadHandle* GetMainAssetLoad() const {
+			return mainAssetLoad;
+		}
+
 		/// @brief Destroys the program and its components.
 		~Program();
 	private:
@@ -91,5 +103,6 @@ namespace wfe {
 		Window* window;
 		Renderer* renderer;
 		AssetManager* assetManager;
+		AssetLoadHandle* mainAssetLoad;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <Core.hpp>
+
+namespace wfe {
+	/// @brief Reads ranges of files asynchronously on a dedicated I/O thread, batching the opens and reads of many files so that they are in flight together. Small reads go into a pool of buffers registered with the operating system once, instead of being mapped on every read.
+	class AsyncFileReader {
+	public:
+		/// @brief A function called on the reader's I/O thread once a read finishes, which must return quickly, for example by submitting a job which uses the read data.
+		typedef void(*ReadCallback)(void* userData, void* buffer, size_t size, bool8_t success);
+
+		/// @brief The default maximum number of files being read at once.
+		static const size_t DEFAULT_QUEUE_DEPTH = 64;
+		/// @brief The size of every buffer in the reader's registered buffer pool.
+		static const size_t POOL_BUFFER_SIZE = 0x20000;
+		/// @brief The number of buffers in the reader's registered buffer pool.
+		static const size_t POOL_BUFFER_COUNT = 32;
+
+		/// @brief Creates an asynchronous file reader and starts its I/O thread.
+		/// @param queueDepth The maximum number of files being read at once, which must not be 0; readers with a queue depth of 0 are never opened.
+		AsyncFileReader(size_t queueDepth = DEFAULT_QUEUE_DEPTH);
+		AsyncFileReader(const AsyncFileReader&) = delete;
+		AsyncFileReader(AsyncFileReader&&) noexcept = delete;
+
+		AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+		AsyncFileReader& operator=(AsyncFileReader&&) = delete;
+
+		/// @brief Checks if the reader was started successfully. Asynchronous reads aren't supported on every platform and kernel.
+		/// @return True if the reader can read files, otherwise false.
+		bool8_t IsOpen() const {
+			return platformData != nullptr;
+		}
+		/// @brief Gets the maximum number of files being read at once.
+		/// @return The reader's queue depth.
+		size_t GetQueueDepth() const {
+			return queueDepth;
+		}
+
+		/// @brief Queues a read of the given range of a file. Reads are started in the order they were queued. The function can be called from any thread.
+		/// @param filePath The path of the file to read.
+		/// @param offset The offset of the range to read.
+		/// @param size The size of the range to read, which must not be 0.
+		/// @param callback The function called once the read finishes. On success, the callback must give the read buffer back using ReleaseBuffer or DetachBuffer.
+		/// @param userData The user data passed to the callback.
+		void Read(const string& filePath, uint64_t offset, size_t size, ReadCallback callback, void* userData);
+		/// @brief Gives a buffer passed to a read callback back to the reader.
+		/// @param buffer The buffer to give back.
+		void ReleaseBuffer(void* buffer);
+		/// @brief Takes ownership of a buffer passed to a read callback, copying it out of the reader's buffer pool if needed.
+		/// @param buffer The buffer to take ownership of.
+		/// @param size The size of the buffer.
+		/// @return A pointer to the buffer's data, which must be freed using FreeMemory.
+		void* DetachBuffer(void* buffer, size_t size);
+
+		/// @brief Waits for every queued read to finish and stops the reader's I/O thread.
+		~AsyncFileReader();
+	private:
+		size_t queueDepth;
+		void* platformData;
+	};
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <Core.hpp>
+
+namespace wfe {
+	/// @brief Describes an entry of a directory.
+	struct DirectoryEntry {
+		/// @brief The entry's name, without its directory's path.
+		string name;
+		/// @brief True if the entry is a directory, otherwise false.
+		bool8_t isDirectory;
+	};
+
+	/// @brief Creates the given directory, if it doesn't already exist. The directory's parent must exist.
+	/// @param dirPath The path of the directory to create.
+	/// @return True if the directory exists after the call, otherwise false.
+	bool8_t MakeDirectory(const string& dirPath);
+	/// @brief Reads the regular files and subdirectories of the given directory, without recursing into the subdirectories. Links to directories are skipped, so that walking a directory tree can't loop. The function can be called from any thread.
+	/// @param dirPath The path of the directory to read.
+	/// @param entries The vector the directory's entries will be appended to.
+	/// @return True if the directory was read, otherwise false.
+	bool8_t ReadDirectory(const string& dirPath, vector<DirectoryEntry>& entries);
+	/// @brief Renames the given file to the target path in a single step, replacing the target file if it exists. Readers see either the old or the new target file, never a partially written one, and existing mappings of the old target file stay valid where the platform allows replacing mapped files.
+	/// @param sourcePath The path of the file to rename.
+	/// @param targetPath The path of the file to replace.
+	/// @return True if the file was renamed, otherwise false.
+	bool8_t RenameFile(const string& sourcePath, const string& targetPath);
+}
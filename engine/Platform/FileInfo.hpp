@@ -0,0 +1,12 @@
+#pragma once
+
+#include <Core.hpp>
+
+namespace wfe {
+	/// @brief Gets the size and last modification time of the given file, without opening it.
+	/// @param filePath The path of the file.
+	/// @param size A reference to the variable in which the file's size will be written, in bytes.
+	/// @param modifiedTime A reference to the variable in which the file's last modification time will be written, in platform-specific units which only change when the file is modified.
+	/// @return True if the file exists and its info was read, otherwise false.
+	bool8_t GetFileInfo(const string& filePath, uint64_t& size, uint64_t& modifiedTime);
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <Core.hpp>
+
+namespace wfe {
+	/// @brief Hints the operating system that the given range of a file will be read soon, so that it can start reading it into the page cache in the background. The function doesn't wait for the range to be read.
+	/// @param filePath The path of the file to prefetch.
+	/// @param offset The offset of the range to prefetch, in bytes.
+	/// @param size The size of the range to prefetch, in bytes, or 0 to prefetch up to the end of the file.
+	/// @return True if the hint was given, otherwise false.
+	bool8_t PrefetchFileRange(const string& filePath, uint64_t offset, uint64_t size);
+}
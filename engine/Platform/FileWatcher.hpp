@@ -0,0 +1,47 @@
+#pragma once
+
+#include <Core.hpp>
+
+namespace wfe {
+	/// @brief Watches a directory and all of its subdirectories for modified files, reporting every file once its changes settled.
+	class FileWatcher {
+	public:
+		/// @brief The default time a file must stay unmodified before its change is reported, in milliseconds.
+		static const uint32_t DEFAULT_DEBOUNCE_TIME = 200;
+
+		/// @brief Starts watching the given directory.
+		/// @param dirPath The path of the directory to watch.
+		/// @param debounceTime The time a file must stay unmodified before its change is reported, in milliseconds.
+		FileWatcher(const string& dirPath, uint32_t debounceTime = DEFAULT_DEBOUNCE_TIME);
+
+		FileWatcher() = delete;
+		FileWatcher(const FileWatcher&) = delete;
+		FileWatcher(FileWatcher&&) noexcept = delete;
+
+		FileWatcher& operator=(const FileWatcher&) = delete;
+		FileWatcher& operator=(FileWatcher&&) = delete;
+
+		/// @brief Checks if the directory is being watched.
+		/// @return True if the watcher was started successfully, otherwise false.
+		bool8_t IsOpen() const {
+			return platformData != nullptr;
+		}
+		/// @brief Gets the path of the watched directory.
+		/// @return The watched directory's path, ending with a slash.
+		const string& GetDirPath() const {
+			return dirPath;
+		}
+
+		/// @brief Reads the pending change notifications without blocking and gets the files whose changes settled.
+		/// @param changedFiles A reference to the vector to append the paths of the changed files to, prefixed with the watched directory's path.
+		void PollChanges(vector<string>& changedFiles);
+
+		/// @brief Stops watching the directory.
+		~FileWatcher();
+	private:
+		string dirPath;
+		uint32_t debounceTime;
+		unordered_map<string, uint64_t> pendingFiles;
+		void* platformData;
+	};
+}
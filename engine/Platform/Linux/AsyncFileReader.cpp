@@ -0,0 +1,562 @@
+#include <BuildInfo.hpp>
+
+#ifdef WFE_PLATFORM_LINUX
+
+#include "Platform/AsyncFileReader.hpp"
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <mutex>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <thread>
+#include <unistd.h>
+
+namespace wfe {
+	// Constants
+	static const uint64_t WAKE_USER_DATA = 0;
+	static const size_t MAX_READ_SIZE = 0x7ffff000;
+	static const uint8_t REQUIRED_OPCODES[] = { IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_READ_FIXED, IORING_OP_CLOSE };
+
+	// Enums
+	enum ReadStage {
+		READ_STAGE_OPEN,
+		READ_STAGE_READ,
+		READ_STAGE_CLOSE
+	};
+
+	// Structs
+	struct ReadRequest {
+		string filePath;
+		uint64_t offset;
+		size_t size;
+		size_t readSize;
+		AsyncFileReader::ReadCallback callback;
+		void* userData;
+		char_t* buffer;
+		int32_t bufferIndex;
+		int32_t fileDescriptor;
+		size_t activeIndex;
+		ReadStage stage;
+	};
+	struct ReaderData {
+		int32_t ringDescriptor = -1;
+		void* sqRing = MAP_FAILED;
+		size_t sqRingSize = 0;
+		void* cqRing = MAP_FAILED;
+		size_t cqRingSize = 0;
+		io_uring_sqe* sqes = (io_uring_sqe*)MAP_FAILED;
+		size_t sqesSize = 0;
+
+		uint32_t* sqHead;
+		uint32_t* sqTail;
+		uint32_t* sqArray;
+		uint32_t sqMask;
+		uint32_t sqEntryCount;
+		uint32_t* cqHead;
+		uint32_t* cqTail;
+		io_uring_cqe* cqes;
+		uint32_t cqMask;
+		uint32_t pendingSubmitCount = 0;
+
+		int32_t eventDescriptor = -1;
+		uint64_t eventValue;
+
+		char_t* bufferPool = nullptr;
+		vector<int32_t> freeBuffers;
+
+		std::mutex mutex;
+		vector<ReadRequest*> queuedRequests;
+		size_t queuedBegin = 0;
+		vector<ReadRequest*> activeRequests;
+		vector<ReadRequest*> abandonedRequests;
+		bool8_t stopping = false;
+		bool8_t failed = false;
+		std::thread thread;
+	};
+
+	// Internal helper functions
+	static int32_t IOUringSetup(uint32_t entryCount, io_uring_params* params) {
+		return (int32_t)syscall(__NR_io_uring_setup, entryCount, params);
+	}
+	static int32_t IOUringEnter(int32_t ringDescriptor, uint32_t submitCount, uint32_t minCompleteCount, uint32_t flags) {
+		return (int32_t)syscall(__NR_io_uring_enter, ringDescriptor, submitCount, minCompleteCount, flags, nullptr, 0);
+	}
+	static int32_t IOUringRegister(int32_t ringDescriptor, uint32_t opcode, const void* args, uint32_t argCount) {
+		return (int32_t)syscall(__NR_io_uring_register, ringDescriptor, opcode, args, argCount);
+	}
+
+	static bool8_t SupportsRequiredOpcodes(int32_t ringDescriptor) {
+		// Probe the kernel's supported opcodes, which requires Linux 5.6, the same version which added the required opcodes
+		size_t probeSize = sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op);
+		io_uring_probe* probe = (io_uring_probe*)AllocMemory(probeSize);
+		if(!probe)
+			return false;
+		memset(probe, 0, probeSize);
+
+		bool8_t supported = IOUringRegister(ringDescriptor, IORING_REGISTER_PROBE, probe, 256) >= 0;
+		for(uint8_t opcode : REQUIRED_OPCODES)
+			supported = supported && opcode <= probe->last_op && (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED);
+
+		FreeMemory(probe);
+
+		return supported;
+	}
+	static void DestroyReaderData(ReaderData* data) {
+		// Unmap the ring, which stops any read of the wake event still in flight, and close the descriptors
+		if(data->sqes != MAP_FAILED)
+			munmap(data->sqes, data->sqesSize);
+		if(data->cqRing != MAP_FAILED && data->cqRing != data->sqRing)
+			munmap(data->cqRing, data->cqRingSize);
+		if(data->sqRing != MAP_FAILED)
+			munmap(data->sqRing, data->sqRingSize);
+		if(data->ringDescriptor != -1)
+			close(data->ringDescriptor);
+		if(data->eventDescriptor != -1)
+			close(data->eventDescriptor);
+
+		// Free the requests abandoned by a failed I/O thread, whose buffers may have been in use by the ring until it was closed
+		for(ReadRequest* request : data->abandonedRequests) {
+			if(request->bufferIndex == -1 && request->buffer)
+				FreeMemory(request->buffer);
+			DestroyObject(request);
+		}
+
+		// Unregister and unmap the buffer pool
+		if(data->bufferPool)
+			munmap(data->bufferPool, AsyncFileReader::POOL_BUFFER_SIZE * AsyncFileReader::POOL_BUFFER_COUNT);
+
+		DestroyObject(data);
+	}
+
+	static io_uring_sqe* GetSQE(ReaderData* data) {
+		// Get the next submission queue entry; the queue never fills, since every active request has at most one entry in flight
+		uint32_t tail = *data->sqTail;
+		uint32_t index = tail & data->sqMask;
+
+		io_uring_sqe* sqe = data->sqes + index;
+		memset(sqe, 0, sizeof(io_uring_sqe));
+		data->sqArray[index] = index;
+
+		// Publish the entry, which the kernel only reads once it is submitted
+		__atomic_store_n(data->sqTail, tail + 1, __ATOMIC_RELEASE);
+		++data->pendingSubmitCount;
+
+		return sqe;
+	}
+	static void PrepareWake(ReaderData* data) {
+		// Read the wake event, which completes once a read is queued or the reader is stopped
+		io_uring_sqe* sqe = GetSQE(data);
+		sqe->opcode = IORING_OP_READ;
+		sqe->fd = data->eventDescriptor;
+		sqe->addr = (uint64_t)&data->eventValue;
+		sqe->len = sizeof(uint64_t);
+		sqe->user_data = WAKE_USER_DATA;
+	}
+	static void PrepareOpen(ReaderData* data, ReadRequest* request) {
+		io_uring_sqe* sqe = GetSQE(data);
+		sqe->opcode = IORING_OP_OPENAT;
+		sqe->fd = AT_FDCWD;
+		sqe->addr = (uint64_t)request->filePath.c_str();
+		sqe->open_flags = O_RDONLY | O_CLOEXEC;
+		sqe->user_data = (uint64_t)request;
+
+		request->stage = READ_STAGE_OPEN;
+	}
+	static void PrepareRead(ReaderData* data, ReadRequest* request) {
+		// Read the rest of the range, using the registered buffer if the request has one. Every read is clamped to the most a single read transfers, since the length is 32-bit; larger ranges are read in multiple steps, like short reads
+		size_t remainingSize = request->size - request->readSize;
+
+		io_uring_sqe* sqe = GetSQE(data);
+		sqe->opcode = request->bufferIndex != -1 ? IORING_OP_READ_FIXED : IORING_OP_READ;
+		sqe->fd = request->fileDescriptor;
+		sqe->off = request->offset + request->readSize;
+		sqe->addr = (uint64_t)(request->buffer + request->readSize);
+		sqe->len = (uint32_t)(remainingSize < MAX_READ_SIZE ? remainingSize : MAX_READ_SIZE);
+		if(request->bufferIndex != -1)
+			sqe->buf_index = (uint16_t)request->bufferIndex;
+		sqe->user_data = (uint64_t)request;
+
+		request->stage = READ_STAGE_READ;
+	}
+	static void PrepareClose(ReaderData* data, ReadRequest* request) {
+		io_uring_sqe* sqe = GetSQE(data);
+		sqe->opcode = IORING_OP_CLOSE;
+		sqe->fd = request->fileDescriptor;
+		sqe->user_data = (uint64_t)request;
+
+		request->stage = READ_STAGE_CLOSE;
+	}
+
+	static void ReleaseRequestBuffer(ReaderData* data, ReadRequest* request) {
+		// Give the request's buffer back to the pool or free it
+		if(request->bufferIndex != -1) {
+			data->mutex.lock();
+			data->freeBuffers.push_back(request->bufferIndex);
+			data->mutex.unlock();
+		} else if(request->buffer) {
+			FreeMemory(request->buffer);
+		}
+		request->buffer = nullptr;
+	}
+	static void FinishRequest(ReaderData* data, ReadRequest* request) {
+		// Remove the request from the active requests, moving the last active request into its place, and destroy it
+		data->mutex.lock();
+		ReadRequest* lastRequest = data->activeRequests.back();
+		lastRequest->activeIndex = request->activeIndex;
+		data->activeRequests[request->activeIndex] = lastRequest;
+		data->activeRequests.pop_back();
+		data->mutex.unlock();
+
+		DestroyObject(request);
+	}
+	static void FailRequest(ReaderData* data, ReadRequest* request) {
+		// Free the request's buffer and call its callback with the failure
+		ReleaseRequestBuffer(data, request);
+		request->callback(request->userData, nullptr, request->size, false);
+	}
+
+	static void StartQueuedRequests(ReaderData* data, size_t queueDepth, bool8_t& exit) {
+		data->mutex.lock();
+
+		// Exit once the reader is stopped and every request finished
+		if(data->stopping && data->queuedBegin == data->queuedRequests.size() && data->activeRequests.empty()) {
+			data->mutex.unlock();
+			exit = true;
+			return;
+		}
+
+		// Start the queued requests in order, up to the queue depth
+		vector<ReadRequest*> failedRequests;
+		while(data->activeRequests.size() < queueDepth && data->queuedBegin != data->queuedRequests.size()) {
+			ReadRequest* request = data->queuedRequests[data->queuedBegin++];
+			request->activeIndex = data->activeRequests.size();
+			data->activeRequests.push_back(request);
+
+			// Read into a registered buffer if the range fits in one and one is free, otherwise allocate a buffer
+			if(request->size <= AsyncFileReader::POOL_BUFFER_SIZE && !data->freeBuffers.empty()) {
+				request->bufferIndex = data->freeBuffers.back();
+				request->buffer = data->bufferPool + (size_t)request->bufferIndex * AsyncFileReader::POOL_BUFFER_SIZE;
+				data->freeBuffers.pop_back();
+			} else {
+				request->buffer = (char_t*)AllocMemory(request->size);
+				if(!request->buffer) {
+					failedRequests.push_back(request);
+					continue;
+				}
+			}
+
+			PrepareOpen(data, request);
+		}
+		if(data->queuedBegin == data->queuedRequests.size()) {
+			data->queuedRequests.clear();
+			data->queuedBegin = 0;
+		}
+
+		data->mutex.unlock();
+
+		// Fail the requests whose buffers couldn't be allocated, outside of the lock
+		for(ReadRequest* request : failedRequests) {
+			FailRequest(data, request);
+			FinishRequest(data, request);
+		}
+	}
+	static void HandleCompletion(ReaderData* data, const io_uring_cqe& cqe) {
+		// Read the wake event again
+		if(cqe.user_data == WAKE_USER_DATA) {
+			PrepareWake(data);
+			return;
+		}
+
+		ReadRequest* request = (ReadRequest*)cqe.user_data;
+		switch(request->stage) {
+		case READ_STAGE_OPEN:
+			// Start reading the file, or fail the request if it couldn't be opened
+			if(cqe.res < 0) {
+				FailRequest(data, request);
+				FinishRequest(data, request);
+				break;
+			}
+
+			request->fileDescriptor = cqe.res;
+			request->readSize = 0;
+			PrepareRead(data, request);
+			break;
+		case READ_STAGE_READ:
+			// Fail the request if the read failed or the file ended before the range
+			if(cqe.res <= 0) {
+				FailRequest(data, request);
+				PrepareClose(data, request);
+				break;
+			}
+
+			// Read the rest of the range after a short read, or call the callback before the file is closed
+			request->readSize += (size_t)cqe.res;
+			if(request->readSize < request->size) {
+				PrepareRead(data, request);
+				break;
+			}
+
+			request->callback(request->userData, request->buffer, request->size, true);
+			PrepareClose(data, request);
+			break;
+		case READ_STAGE_CLOSE:
+			FinishRequest(data, request);
+			break;
+		}
+	}
+	static void FailReader(ReaderData* data) {
+		// Mark the reader as failed, so that new reads fail right away, and take every queued and active request
+		data->mutex.lock();
+
+		data->failed = true;
+		vector<ReadRequest*> queuedRequests;
+		for(size_t i = data->queuedBegin; i != data->queuedRequests.size(); ++i)
+			queuedRequests.push_back(data->queuedRequests[i]);
+		data->queuedRequests.clear();
+		data->queuedBegin = 0;
+
+		vector<ReadRequest*> activeRequests;
+		activeRequests.swap(data->activeRequests);
+
+		data->mutex.unlock();
+
+		// Fail the queued requests, which never reached the ring
+		for(ReadRequest* request : queuedRequests) {
+			request->callback(request->userData, nullptr, request->size, false);
+			DestroyObject(request);
+		}
+
+		// Fail the active requests whose callbacks weren't called yet. Their buffers and files may still be used by the ring, so the requests are only destroyed with the reader
+		for(ReadRequest* request : activeRequests)
+			if(request->stage != READ_STAGE_CLOSE)
+				request->callback(request->userData, nullptr, request->size, false);
+
+		data->mutex.lock();
+		for(ReadRequest* request : activeRequests)
+			data->abandonedRequests.push_back(request);
+		data->mutex.unlock();
+	}
+	static void ReaderThread(ReaderData* data, size_t queueDepth) {
+		// Start reading the wake event
+		PrepareWake(data);
+
+		bool8_t exit = false;
+		while(true) {
+			// Start the queued requests and exit if the reader was stopped
+			StartQueuedRequests(data, queueDepth, exit);
+			if(exit)
+				break;
+
+			// Submit every prepared entry in one call and wait for at least one completion
+			int32_t result = IOUringEnter(data->ringDescriptor, data->pendingSubmitCount, 1, IORING_ENTER_GETEVENTS);
+			if(result < 0) {
+				if(errno == EINTR || errno == EAGAIN || errno == EBUSY)
+					continue;
+
+				// Fail every request, whose users fall back to blocking reads, and stop the thread
+				FailReader(data);
+				break;
+			}
+			data->pendingSubmitCount -= (uint32_t)result;
+
+			// Handle every completion
+			uint32_t head = *data->cqHead;
+			uint32_t tail = __atomic_load_n(data->cqTail, __ATOMIC_ACQUIRE);
+			for(; head != tail; ++head)
+				HandleCompletion(data, data->cqes[head & data->cqMask]);
+
+			__atomic_store_n(data->cqHead, head, __ATOMIC_RELEASE);
+		}
+	}
+	static void Wake(ReaderData* data) {
+		// Signal the wake event
+		uint64_t value = 1;
+		ssize_t written = write(data->eventDescriptor, &value, sizeof(uint64_t));
+		(void)written;
+	}
+
+	// Public functions
+	AsyncFileReader::AsyncFileReader(size_t queueDepth) : queueDepth(queueDepth), platformData(nullptr) {
+		// Leave the reader closed if it couldn't have any request in flight
+		if(!queueDepth)
+			return;
+
+		ReaderData* data = NewObject<ReaderData>();
+
+		// Create the ring, with room for one entry per active request and one for the wake event
+		io_uring_params params;
+		memset(&params, 0, sizeof(io_uring_params));
+
+		data->ringDescriptor = IOUringSetup((uint32_t)queueDepth + 1, &params);
+		if(data->ringDescriptor < 0) {
+			data->ringDescriptor = -1;
+			DestroyReaderData(data);
+			return;
+		}
+		if(!SupportsRequiredOpcodes(data->ringDescriptor)) {
+			DestroyReaderData(data);
+			return;
+		}
+
+		// Map the submission and completion queues, which share one mapping on newer kernels
+		data->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+		data->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		bool8_t singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+		if(singleMap) {
+			if(data->cqRingSize > data->sqRingSize)
+				data->sqRingSize = data->cqRingSize;
+			data->cqRingSize = data->sqRingSize;
+		}
+
+		data->sqRing = mmap(nullptr, data->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, data->ringDescriptor, IORING_OFF_SQ_RING);
+		if(data->sqRing == MAP_FAILED) {
+			DestroyReaderData(data);
+			return;
+		}
+		if(singleMap)
+			data->cqRing = data->sqRing;
+		else
+			data->cqRing = mmap(nullptr, data->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, data->ringDescriptor, IORING_OFF_CQ_RING);
+
+		data->sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+		data->sqes = (io_uring_sqe*)mmap(nullptr, data->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, data->ringDescriptor, IORING_OFF_SQES);
+		if(data->cqRing == MAP_FAILED || data->sqes == MAP_FAILED) {
+			DestroyReaderData(data);
+			return;
+		}
+
+		char_t* sqRing = (char_t*)data->sqRing;
+		data->sqHead = (uint32_t*)(sqRing + params.sq_off.head);
+		data->sqTail = (uint32_t*)(sqRing + params.sq_off.tail);
+		data->sqArray = (uint32_t*)(sqRing + params.sq_off.array);
+		data->sqMask = *(uint32_t*)(sqRing + params.sq_off.ring_mask);
+		data->sqEntryCount = params.sq_entries;
+
+		char_t* cqRing = (char_t*)data->cqRing;
+		data->cqHead = (uint32_t*)(cqRing + params.cq_off.head);
+		data->cqTail = (uint32_t*)(cqRing + params.cq_off.tail);
+		data->cqes = (io_uring_cqe*)(cqRing + params.cq_off.cqes);
+		data->cqMask = *(uint32_t*)(cqRing + params.cq_off.ring_mask);
+
+		// Create the wake event
+		data->eventDescriptor = eventfd(0, EFD_CLOEXEC);
+		if(data->eventDescriptor == -1) {
+			DestroyReaderData(data);
+			return;
+		}
+
+		// Register the buffer pool, so that the kernel doesn't map the buffers on every read. The reader still works with allocated buffers if the pool can't be locked in memory
+		size_t poolSize = POOL_BUFFER_SIZE * POOL_BUFFER_COUNT;
+		void* bufferPool = mmap(nullptr, poolSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if(bufferPool != MAP_FAILED) {
+			iovec buffers[POOL_BUFFER_COUNT];
+			for(size_t i = 0; i != POOL_BUFFER_COUNT; ++i) {
+				buffers[i].iov_base = (char_t*)bufferPool + i * POOL_BUFFER_SIZE;
+				buffers[i].iov_len = POOL_BUFFER_SIZE;
+			}
+
+			if(IOUringRegister(data->ringDescriptor, IORING_REGISTER_BUFFERS, buffers, (uint32_t)POOL_BUFFER_COUNT) >= 0) {
+				data->bufferPool = (char_t*)bufferPool;
+				data->freeBuffers.reserve(POOL_BUFFER_COUNT);
+				for(size_t i = POOL_BUFFER_COUNT; i; --i)
+					data->freeBuffers.push_back((int32_t)(i - 1));
+			} else {
+				munmap(bufferPool, poolSize);
+			}
+		}
+
+		// Start the I/O thread
+		data->thread = std::thread(ReaderThread, data, queueDepth);
+
+		platformData = data;
+	}
+
+	void AsyncFileReader::Read(const string& filePath, uint64_t offset, size_t size, ReadCallback callback, void* userData) {
+		// Fail the read right away if the reader isn't open
+		ReaderData* data = (ReaderData*)platformData;
+		if(!data) {
+			callback(userData, nullptr, size, false);
+			return;
+		}
+
+		// Queue the read and wake the I/O thread
+		ReadRequest* request = NewObject<ReadRequest>();
+		request->filePath = filePath;
+		request->offset = offset;
+		request->size = size;
+		request->readSize = 0;
+		request->callback = callback;
+		request->userData = userData;
+		request->buffer = nullptr;
+		request->bufferIndex = -1;
+		request->fileDescriptor = -1;
+
+		data->mutex.lock();
+		bool8_t failed = data->failed;
+		if(!failed)
+			data->queuedRequests.push_back(request);
+		data->mutex.unlock();
+
+		// Fail the read right away if the I/O thread failed and stopped
+		if(failed) {
+			DestroyObject(request);
+			callback(userData, nullptr, size, false);
+			return;
+		}
+
+		Wake(data);
+	}
+	void AsyncFileReader::ReleaseBuffer(void* buffer) {
+		// Give pool buffers back to the pool and free every other buffer
+		ReaderData* data = (ReaderData*)platformData;
+		char_t* poolBuffer = (char_t*)buffer;
+
+		if(data && data->bufferPool && poolBuffer >= data->bufferPool && poolBuffer < data->bufferPool + POOL_BUFFER_SIZE * POOL_BUFFER_COUNT) {
+			data->mutex.lock();
+			data->freeBuffers.push_back((int32_t)((size_t)(poolBuffer - data->bufferPool) / POOL_BUFFER_SIZE));
+			data->mutex.unlock();
+		} else {
+			FreeMemory(buffer);
+		}
+	}
+	void* AsyncFileReader::DetachBuffer(void* buffer, size_t size) {
+		// Give allocated buffers to the caller unchanged
+		ReaderData* data = (ReaderData*)platformData;
+		char_t* poolBuffer = (char_t*)buffer;
+
+		if(!data || !data->bufferPool || poolBuffer < data->bufferPool || poolBuffer >= data->bufferPool + POOL_BUFFER_SIZE * POOL_BUFFER_COUNT)
+			return buffer;
+
+		// Copy pool buffers to new memory and give them back to the pool
+		void* detached = AllocMemory(size ? size : 1);
+		if(!detached)
+			throw BadAllocException("Failed to allocate detached read buffer memory!");
+		memcpy(detached, buffer, size);
+
+		ReleaseBuffer(buffer);
+
+		return detached;
+	}
+
+	AsyncFileReader::~AsyncFileReader() {
+		// Exit the function if the reader was never opened
+		ReaderData* data = (ReaderData*)platformData;
+		if(!data)
+			return;
+
+		// Stop the I/O thread once every queued read finished and wait for it
+		data->mutex.lock();
+		data->stopping = true;
+		data->mutex.unlock();
+
+		Wake(data);
+		data->thread.join();
+
+		DestroyReaderData(data);
+	}
+}
+
+#endif
@@ -0,0 +1,92 @@
+#include <BuildInfo.hpp>
+
+#ifdef WFE_PLATFORM_LINUX
+
+#include "Platform/Directory.hpp"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace wfe {
+	// Types
+	struct LinuxDirent64 {
+		uint64_t inode;
+		int64_t offset;
+		uint16_t recordLength;
+		uint8_t type;
+		char_t name[];
+	};
+
+	// Constants
+	static const size_t DIRENT_BUFFER_SIZE = 0x8000;
+
+	// Public functions
+	bool8_t MakeDirectory(const string& dirPath) {
+		// Create the directory, accepting directories which already exist
+		return mkdir(dirPath.c_str(), 0755) == 0 || errno == EEXIST;
+	}
+	bool8_t ReadDirectory(const string& dirPath, vector<DirectoryEntry>& entries) {
+		// Open the directory
+		int32_t dirFile = open(dirPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+		if(dirFile == -1)
+			return false;
+
+		// Read the directory's entries in large batches using getdents64, which skips the per-entry overhead of readdir
+		alignas(LinuxDirent64) char_t buffer[DIRENT_BUFFER_SIZE];
+
+		while(true) {
+			long readSize = syscall(SYS_getdents64, dirFile, buffer, DIRENT_BUFFER_SIZE);
+			if(readSize < 0) {
+				close(dirFile);
+				return false;
+			}
+			if(!readSize)
+				break;
+
+			for(long offset = 0; offset < readSize;) {
+				const LinuxDirent64* entry = (const LinuxDirent64*)(buffer + offset);
+				offset += entry->recordLength;
+
+				if(!strcmp(entry->name, ".") || !strcmp(entry->name, ".."))
+					continue;
+
+				// Get the entry's type, following links to files and asking the file system if the type wasn't reported
+				uint8_t type = entry->type;
+				if(type == DT_UNKNOWN || type == DT_LNK) {
+					struct stat fileStat;
+					if(fstatat(dirFile, entry->name, &fileStat, type == DT_LNK ? 0 : AT_SYMLINK_NOFOLLOW))
+						continue;
+
+					if(S_ISREG(fileStat.st_mode))
+						type = DT_REG;
+					else if(S_ISDIR(fileStat.st_mode) && type != DT_LNK)
+						type = DT_DIR;
+					else
+						continue;
+				}
+				if(type != DT_REG && type != DT_DIR)
+					continue;
+
+				DirectoryEntry dirEntry;
+				dirEntry.name = entry->name;
+				dirEntry.isDirectory = type == DT_DIR;
+				entries.push_back(dirEntry);
+			}
+		}
+
+		close(dirFile);
+		return true;
+	}
+	bool8_t RenameFile(const string& sourcePath, const string& targetPath) {
+		// Rename the file over the target, which only unlinks the target's old inode, so any mapping of it stays valid
+		return rename(sourcePath.c_str(), targetPath.c_str()) == 0;
+	}
+}
+
+#endif
@@ -0,0 +1,25 @@
+#include <BuildInfo.hpp>
+
+#ifdef WFE_PLATFORM_LINUX
+
+#include "Platform/FileInfo.hpp"
+
+#include <sys/stat.h>
+
+namespace wfe {
+	// Public functions
+	bool8_t GetFileInfo(const string& filePath, uint64_t& size, uint64_t& modifiedTime) {
+		// Get the file's status
+		struct stat fileStat;
+		if(stat(filePath.c_str(), &fileStat))
+			return false;
+
+		// Get the file's size and modification time in nanoseconds
+		size = (uint64_t)fileStat.st_size;
+		modifiedTime = (uint64_t)fileStat.st_mtim.tv_sec * 1000000000 + (uint64_t)fileStat.st_mtim.tv_nsec;
+
+		return true;
+	}
+}
+
+#endif
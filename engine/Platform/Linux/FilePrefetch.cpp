@@ -0,0 +1,28 @@
+#include <BuildInfo.hpp>
+
+#ifdef WFE_PLATFORM_LINUX
+
+#include "Platform/FilePrefetch.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace wfe {
+	// Public functions
+	bool8_t PrefetchFileRange(const string& filePath, uint64_t offset, uint64_t size) {
+		// Open the file
+		int32_t fileDescriptor = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+		if(fileDescriptor == -1)
+			return false;
+
+		// Start the kernel's readahead of the range, which reads it into the page cache asynchronously
+		int32_t result = posix_fadvise(fileDescriptor, (off_t)offset, (off_t)size, POSIX_FADV_WILLNEED);
+
+		// Close the file descriptor, since the page cache keeps the read pages
+		close(fileDescriptor);
+
+		return !result;
+	}
+}
+
+#endif
@@ -0,0 +1,141 @@
+#include <BuildInfo.hpp>
+
+#ifdef WFE_PLATFORM_LINUX
+
+#include "Platform/FileWatcher.hpp"
+
+#include <dirent.h>
+#include <errno.h>
+#include <sys/inotify.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace wfe {
+	// Constants
+	static const uint32_t WATCH_MASK = IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR;
+	static const size_t EVENT_BUFFER_SIZE = 0x4000;
+
+	// Structs
+	struct WatcherData {
+		int32_t fileDescriptor;
+		unordered_map<int32_t, string> watchDirs;
+	};
+
+	// Internal helper functions
+	static uint64_t GetMonotonicTime() {
+		// Get the monotonic clock's time in milliseconds
+		struct timespec time;
+		clock_gettime(CLOCK_MONOTONIC, &time);
+
+		return (uint64_t)time.tv_sec * 1000 + (uint64_t)time.tv_nsec / 1000000;
+	}
+	static void AddWatch(WatcherData* data, const string& dirPath) {
+		// Watch the directory itself, since inotify watches aren't recursive
+		int32_t watchDescriptor = inotify_add_watch(data->fileDescriptor, dirPath.c_str(), WATCH_MASK);
+		if(watchDescriptor == -1)
+			return;
+		data->watchDirs[watchDescriptor] = dirPath;
+
+		// Watch every subdirectory
+		DIR* dir = opendir(dirPath.c_str());
+		if(!dir)
+			return;
+
+		for(struct dirent* entry = readdir(dir); entry; entry = readdir(dir)) {
+			if(entry->d_type != DT_DIR || !strcmp(entry->d_name, ".") || !strcmp(entry->d_name, ".."))
+				continue;
+
+			AddWatch(data, dirPath + entry->d_name + "/");
+		}
+
+		closedir(dir);
+	}
+
+	// Public functions
+	FileWatcher::FileWatcher(const string& dirPath, uint32_t debounceTime) : dirPath(dirPath), debounceTime(debounceTime), platformData(nullptr) {
+		// Make sure the directory's path ends with a slash
+		if(!this->dirPath.empty() && this->dirPath.back() != '/')
+			this->dirPath.push_back('/');
+
+		// Create the inotify instance
+		int32_t fileDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if(fileDescriptor == -1)
+			return;
+
+		WatcherData* data = NewObject<WatcherData>();
+		data->fileDescriptor = fileDescriptor;
+
+		// Watch the directory tree
+		AddWatch(data, this->dirPath);
+		if(data->watchDirs.empty()) {
+			close(fileDescriptor);
+			DestroyObject(data);
+			return;
+		}
+
+		platformData = data;
+	}
+
+	void FileWatcher::PollChanges(vector<string>& changedFiles) {
+		// Exit the function if the watcher isn't open
+		if(!platformData)
+			return;
+		WatcherData* data = (WatcherData*)platformData;
+
+		// Read every pending inotify event
+		alignas(struct inotify_event) char_t buffer[EVENT_BUFFER_SIZE];
+		uint64_t time = GetMonotonicTime();
+
+		while(true) {
+			ssize_t readSize = read(data->fileDescriptor, buffer, EVENT_BUFFER_SIZE);
+			if(readSize <= 0)
+				break;
+
+			for(ssize_t offset = 0; offset < readSize;) {
+				const struct inotify_event* event = (const struct inotify_event*)(buffer + offset);
+				offset += sizeof(struct inotify_event) + event->len;
+
+				// Forget the watch if its directory was removed
+				if(event->mask & IN_IGNORED) {
+					data->watchDirs.erase(event->wd);
+					continue;
+				}
+
+				// Get the path of the event's file
+				auto watchDir = data->watchDirs.find(event->wd);
+				if(watchDir == data->watchDirs.end() || !event->len)
+					continue;
+				string filePath = watchDir->second + event->name;
+
+				// Start watching new directories, otherwise mark the file as changed
+				if(event->mask & IN_ISDIR) {
+					if(event->mask & (IN_CREATE | IN_MOVED_TO))
+						AddWatch(data, filePath + "/");
+				} else if(event->mask & (IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO))
+					pendingFiles[filePath] = time;
+			}
+		}
+
+		// Report the files which weren't modified for the debounce time
+		vector<string> settledFiles;
+		for(const auto& pendingFile : pendingFiles)
+			if(time - pendingFile.second >= debounceTime)
+				settledFiles.push_back(pendingFile.first);
+
+		for(const auto& settledFile : settledFiles) {
+			pendingFiles.erase(settledFile);
+			changedFiles.push_back(settledFile);
+		}
+	}
+
+	FileWatcher::~FileWatcher() {
+		// Close the inotify instance, which removes all of its watches
+		if(platformData) {
+			WatcherData* data = (WatcherData*)platformData;
+			close(data->fileDescriptor);
+			DestroyObject(data);
+		}
+	}
+}
+
+#endif
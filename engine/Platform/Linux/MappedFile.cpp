@@ -0,0 +1,52 @@
+#include <BuildInfo.hpp>
+
+#ifdef WFE_PLATFORM_LINUX
+
+#include "Platform/MappedFile.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace wfe {
+	// Public functions
+	MappedFile::MappedFile(const string& filePath) : data(nullptr), size(0), open(false) {
+		// Open the file
+		int32_t fileDescriptor = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+		if(fileDescriptor == -1)
+			return;
+		
+		// Get the file's size
+		struct stat fileStat;
+		if(fstat(fileDescriptor, &fileStat) == -1) {
+			close(fileDescriptor);
+			return;
+		}
+		size = (size_t)fileStat.st_size;
+
+		// Map the file's contents, if it isn't empty
+		if(size) {
+			void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+			if(mapped == MAP_FAILED) {
+				close(fileDescriptor);
+				size = 0;
+				return;
+			}
+			data = mapped;
+		}
+
+		// Close the file descriptor, since the mapping keeps its own reference to the file
+		close(fileDescriptor);
+
+		open = true;
+	}
+
+	MappedFile::~MappedFile() {
+		// Unmap the file's contents
+		if(data)
+			munmap(data, size);
+	}
+}
+
+#endif
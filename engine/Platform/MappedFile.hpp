@@ -0,0 +1,43 @@
+#pragma once
+
+#include <Core.hpp>
+
+namespace wfe {
+	/// @brief A read-only view of a file's contents mapped into the process' memory.
+	class MappedFile {
+	public:
+		/// @brief Maps the given file into memory.
+		/// @param filePath The path of the file to map.
+		MappedFile(const string& filePath);
+
+		MappedFile() = delete;
+		MappedFile(const MappedFile&) = delete;
+		MappedFile(MappedFile&&) noexcept = delete;
+
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile& operator=(MappedFile&&) = delete;
+
+		/// @brief Checks if the file was mapped successfully.
+		/// @return True if the file is mapped, otherwise false.
+		bool8_t IsOpen() const {
+			return open;
+		}
+		/// @brief Gets the file's mapped contents.
+		/// @return A const pointer to the start of the file's mapped contents, or nullptr if the file is empty or not mapped.
+		const void* GetData() const {
+			return data;
+		}
+		/// @brief Gets the size of the mapped file.
+		/// @return The size of the mapped file, in bytes.
+		size_t GetSize() const {
+			return size;
+		}
+
+		/// @brief Unmaps the file.
+		~MappedFile();
+	private:
+		void* data;
+		size_t size;
+		bool8_t open;
+	};
+}
@@ -0,0 +1,29 @@
+#include <BuildInfo.hpp>
+
+#ifdef WFE_PLATFORM_WINDOWS
+
+#include "Platform/AsyncFileReader.hpp"
+
+namespace wfe {
+	// Public functions
+	AsyncFileReader::AsyncFileReader(size_t queueDepth) : queueDepth(queueDepth), platformData(nullptr) {
+		// Asynchronous reads aren't implemented on Windows yet, so the reader is never opened and its users read files synchronously
+	}
+
+	void AsyncFileReader::Read(const string& filePath, uint64_t offset, size_t size, ReadCallback callback, void* userData) {
+		// Fail the read right away
+		callback(userData, nullptr, size, false);
+	}
+	void AsyncFileReader::ReleaseBuffer(void* buffer) {
+		// Free the buffer
+		FreeMemory(buffer);
+	}
+	void* AsyncFileReader::DetachBuffer(void* buffer, size_t size) {
+		// Give the buffer to the caller unchanged
+		return buffer;
+	}
+
+	AsyncFileReader::~AsyncFileReader() = default;
+}
+
+#endif
@@ -0,0 +1,54 @@
+#include <BuildInfo.hpp>
+
+#ifdef WFE_PLATFORM_WINDOWS
+
+#include "Platform/Directory.hpp"
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include <string.h>
+
+namespace wfe {
+	// Public functions
+	bool8_t MakeDirectory(const string& dirPath) {
+		// Create the directory, accepting directories which already exist
+		return CreateDirectoryA(dirPath.c_str(), nullptr) || GetLastError() == ERROR_ALREADY_EXISTS;
+	}
+	bool8_t ReadDirectory(const string& dirPath, vector<DirectoryEntry>& entries) {
+		// Start searching the directory, skipping the short names which FindFirstFile looks up by default
+		string searchPath = dirPath;
+		if(!searchPath.empty() && searchPath.back() != '/' && searchPath.back() != '\\')
+			searchPath.push_back('/');
+		searchPath.push_back('*');
+
+		WIN32_FIND_DATAA findData;
+		HANDLE findHandle = FindFirstFileExA(searchPath.c_str(), FindExInfoBasic, &findData, FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+		if(findHandle == INVALID_HANDLE_VALUE)
+			return GetLastError() == ERROR_FILE_NOT_FOUND;
+
+		do {
+			if(!strcmp(findData.cFileName, ".") || !strcmp(findData.cFileName, ".."))
+				continue;
+
+			// Skip links to directories, so that walking a directory tree can't loop
+			bool8_t isDirectory = findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY;
+			if(isDirectory && (findData.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT))
+				continue;
+
+			DirectoryEntry dirEntry;
+			dirEntry.name = findData.cFileName;
+			dirEntry.isDirectory = isDirectory;
+			entries.push_back(dirEntry);
+		} while(FindNextFileA(findHandle, &findData));
+
+		FindClose(findHandle);
+		return true;
+	}
+	bool8_t RenameFile(const string& sourcePath, const string& targetPath) {
+		// Move the file over the target, flushing it first so that the target is never left partially written
+		return MoveFileExA(sourcePath.c_str(), targetPath.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+	}
+}
+
+#endif
@@ -0,0 +1,26 @@
+#include <BuildInfo.hpp>
+
+#ifdef WFE_PLATFORM_WINDOWS
+
+#include "Platform/FileInfo.hpp"
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+namespace wfe {
+	// Public functions
+	bool8_t GetFileInfo(const string& filePath, uint64_t& size, uint64_t& modifiedTime) {
+		// Get the file's attributes
+		WIN32_FILE_ATTRIBUTE_DATA fileData;
+		if(!GetFileAttributesExA(filePath.c_str(), GetFileExInfoStandard, &fileData))
+			return false;
+
+		// Get the file's size and its last write time in 100-nanosecond intervals
+		size = ((uint64_t)fileData.nFileSizeHigh << 32) | (uint64_t)fileData.nFileSizeLow;
+		modifiedTime = ((uint64_t)fileData.ftLastWriteTime.dwHighDateTime << 32) | (uint64_t)fileData.ftLastWriteTime.dwLowDateTime;
+
+		return true;
+	}
+}
+
+#endif
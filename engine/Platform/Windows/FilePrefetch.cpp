@@ -0,0 +1,53 @@
+#include <BuildInfo.hpp>
+
+#ifdef WFE_PLATFORM_WINDOWS
+
+#include "Platform/FilePrefetch.hpp"
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+namespace wfe {
+	// Public functions
+	bool8_t PrefetchFileRange(const string& filePath, uint64_t offset, uint64_t size) {
+		// Open the file
+		HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if(file == INVALID_HANDLE_VALUE)
+			return false;
+
+		// Clamp the range to the file's size
+		LARGE_INTEGER fileSize;
+		if(!GetFileSizeEx(file, &fileSize) || offset >= (uint64_t)fileSize.QuadPart) {
+			CloseHandle(file);
+			return false;
+		}
+		if(!size || size > (uint64_t)fileSize.QuadPart - offset)
+			size = (uint64_t)fileSize.QuadPart - offset;
+
+		// Map a view of the range, starting at the allocation granularity boundary before its offset
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(file);
+		if(!mapping)
+			return false;
+
+		SYSTEM_INFO systemInfo;
+		GetSystemInfo(&systemInfo);
+		uint64_t viewOffset = offset - offset % systemInfo.dwAllocationGranularity;
+		SIZE_T viewSize = (SIZE_T)(size + offset - viewOffset);
+
+		void* view = MapViewOfFile(mapping, FILE_MAP_READ, (DWORD)(viewOffset >> 32), (DWORD)viewOffset, viewSize);
+		CloseHandle(mapping);
+		if(!view)
+			return false;
+
+		// Ask the memory manager to read the view's pages in the background. The pages stay in the standby list after the view is unmapped
+		WIN32_MEMORY_RANGE_ENTRY range { view, viewSize };
+		BOOL result = PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+
+		UnmapViewOfFile(view);
+
+		return result != 0;
+	}
+}
+
+#endif
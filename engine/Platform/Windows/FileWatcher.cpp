@@ -0,0 +1,141 @@
+#include <BuildInfo.hpp>
+
+#ifdef WFE_PLATFORM_WINDOWS
+
+#include "Platform/FileWatcher.hpp"
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+namespace wfe {
+	// Constants
+	static const DWORD NOTIFY_FILTER = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE;
+	static const size_t EVENT_BUFFER_SIZE = 0x4000;
+
+	// Structs
+	struct WatcherData {
+		HANDLE dir;
+		HANDLE event;
+		OVERLAPPED overlapped;
+		DWORD buffer[EVENT_BUFFER_SIZE / sizeof(DWORD)];
+		bool8_t pending;
+	};
+
+	// Internal helper functions
+	static bool8_t IssueRead(WatcherData* data) {
+		// Start an asynchronous read of the directory tree's changes
+		ZeroMemory(&data->overlapped, sizeof(OVERLAPPED));
+		data->overlapped.hEvent = data->event;
+
+		return ReadDirectoryChangesW(data->dir, data->buffer, (DWORD)EVENT_BUFFER_SIZE, TRUE, NOTIFY_FILTER, nullptr, &data->overlapped, nullptr);
+	}
+
+	// Public functions
+	FileWatcher::FileWatcher(const string& dirPath, uint32_t debounceTime) : dirPath(dirPath), debounceTime(debounceTime), platformData(nullptr) {
+		// Make sure the directory's path ends with a slash
+		if(!this->dirPath.empty() && this->dirPath.back() != '/' && this->dirPath.back() != '\\')
+			this->dirPath.push_back('/');
+
+		// Open the directory for overlapped change notifications
+		HANDLE dir = CreateFileA(this->dirPath.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+		if(dir == INVALID_HANDLE_VALUE)
+			return;
+
+		HANDLE event = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+		if(!event) {
+			CloseHandle(dir);
+			return;
+		}
+
+		WatcherData* data = NewObject<WatcherData>();
+		data->dir = dir;
+		data->event = event;
+
+		// Start the first read
+		data->pending = IssueRead(data);
+		if(!data->pending) {
+			CloseHandle(event);
+			CloseHandle(dir);
+			DestroyObject(data);
+			return;
+		}
+
+		platformData = data;
+	}
+
+	void FileWatcher::PollChanges(vector<string>& changedFiles) {
+		// Exit the function if the watcher isn't open
+		if(!platformData)
+			return;
+		WatcherData* data = (WatcherData*)platformData;
+
+		// Process every completed read, without waiting for pending ones
+		uint64_t time = GetTickCount64();
+
+		while(data->pending) {
+			DWORD readSize;
+			if(!GetOverlappedResult(data->dir, &data->overlapped, &readSize, FALSE)) {
+				if(GetLastError() != ERROR_IO_INCOMPLETE)
+					data->pending = false;
+				break;
+			}
+
+			// Mark every added, modified or renamed file as changed
+			const char_t* buffer = (const char_t*)data->buffer;
+			for(DWORD offset = 0; offset < readSize;) {
+				const FILE_NOTIFY_INFORMATION* info = (const FILE_NOTIFY_INFORMATION*)(buffer + offset);
+
+				if(info->Action == FILE_ACTION_ADDED || info->Action == FILE_ACTION_MODIFIED || info->Action == FILE_ACTION_RENAMED_NEW_NAME) {
+					// Convert the file's name to UTF-8, using forward slashes
+					int32_t nameLength = (int32_t)(info->FileNameLength / sizeof(WCHAR));
+					int32_t nameSize = WideCharToMultiByte(CP_UTF8, 0, info->FileName, nameLength, nullptr, 0, nullptr, nullptr);
+
+					string fileName(nameSize, '\0');
+					WideCharToMultiByte(CP_UTF8, 0, info->FileName, nameLength, &fileName[0], nameSize, nullptr, nullptr);
+					for(char_t& c : fileName)
+						if(c == '\\')
+							c = '/';
+
+					pendingFiles[dirPath + fileName] = time;
+				}
+
+				if(!info->NextEntryOffset)
+					break;
+				offset += info->NextEntryOffset;
+			}
+
+			// Start the next read
+			data->pending = IssueRead(data);
+		}
+
+		// Report the files which weren't modified for the debounce time
+		vector<string> settledFiles;
+		for(const auto& pendingFile : pendingFiles)
+			if(time - pendingFile.second >= debounceTime)
+				settledFiles.push_back(pendingFile.first);
+
+		for(const auto& settledFile : settledFiles) {
+			pendingFiles.erase(settledFile);
+			changedFiles.push_back(settledFile);
+		}
+	}
+
+	FileWatcher::~FileWatcher() {
+		// Cancel the pending read and close the directory's handles
+		if(platformData) {
+			WatcherData* data = (WatcherData*)platformData;
+
+			if(data->pending) {
+				DWORD readSize;
+				CancelIoEx(data->dir, &data->overlapped);
+				GetOverlappedResult(data->dir, &data->overlapped, &readSize, TRUE);
+			}
+
+			CloseHandle(data->event);
+			CloseHandle(data->dir);
+			DestroyObject(data);
+		}
+	}
+}
+
+#endif
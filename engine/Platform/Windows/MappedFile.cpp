@@ -0,0 +1,60 @@
+#include <BuildInfo.hpp>
+
+#ifdef WFE_PLATFORM_WINDOWS
+
+#include "Platform/MappedFile.hpp"
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+namespace wfe {
+	// Public functions
+	MappedFile::MappedFile(const string& filePath) : data(nullptr), size(0), open(false) {
+		// Open the file
+		HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if(file == INVALID_HANDLE_VALUE)
+			return;
+		
+		// Get the file's size
+		LARGE_INTEGER fileSize;
+		if(!GetFileSizeEx(file, &fileSize)) {
+			CloseHandle(file);
+			return;
+		}
+		size = (size_t)fileSize.QuadPart;
+
+		// Map the file's contents, if it isn't empty
+		if(size) {
+			HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if(!mapping) {
+				CloseHandle(file);
+				size = 0;
+				return;
+			}
+
+			data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+			// Close the mapping handle, since the view keeps its own reference to the mapping
+			CloseHandle(mapping);
+
+			if(!data) {
+				CloseHandle(file);
+				size = 0;
+				return;
+			}
+		}
+
+		// Close the file handle
+		CloseHandle(file);
+
+		open = true;
+	}
+
+	MappedFile::~MappedFile() {
+		// Unmap the file's contents
+		if(data)
+			UnmapViewOfFile(data);
+	}
+}
+
+#endif
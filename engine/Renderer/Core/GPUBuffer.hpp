@@ -8,6 +8,28 @@ namespace wfe {
 	/// @brief An implementation of a GPU memory buffer.
 	class GPUBuffer {
 	public:
+		/// @brief All possible transient buffer memory types.
+		typedef enum {
+			/// @brief GPU memory that is directly visible from the CPU, used for data read by the GPU during a single frame, such as uniforms and dynamic vertices.
+			TRANSIENT_MEMORY_TYPE_DYNAMIC,
+			/// @brief CPU memory that is directly visible from the GPU, used for staging data copied to other buffers and images.
+			TRANSIENT_MEMORY_TYPE_STAGING
+		} TransientMemoryType;
+
+		/// @brief Starts the given frame in flight, freeing every transient buffer's memory allocated the last time the frame was used. Must only be called once the GPU finished all of the frame's work.
+		/// @param renderer The renderer whose transient memory to reset.
+		/// @param frameIndex The index of the frame in flight, which must be lower than Renderer::MAX_FRAMES_IN_FLIGHT.
+		static void ResetTransientBuffers(Renderer* renderer, size_t frameIndex) {
+			// Call the reset function for the renderer's API
+			switch(renderer->GetRendererBackendAPI()) {
+			case Renderer::RENDERER_BACKEND_API_VULKAN:
+				((VulkanRenderer*)renderer->GetRendererBackend())->GetAllocator()->ResetTransientMemory(frameIndex);
+				break;
+			default:
+				throw Exception("Invalid renderer API!");
+			}
+		}
+
 		/// @brief Creates a GPU memory buffer.
 		/// @param renderer The renderer to create the buffer in.
 		/// @param size The size of the buffer.
@@ -23,6 +45,21 @@ namespace wfe {
 			}
 		}
 
+		/// @brief Creates a transient GPU memory buffer, which views the renderer's persistently mapped transient memory. Creating a transient buffer only bumps an offset and destroying it does nothing, but the buffer is only valid until the current frame in flight is reset.
+		/// @param renderer The renderer to create the buffer in.
+		/// @param size The size of the buffer.
+		/// @param transientMemoryType The type of transient memory to use for the buffer.
+		GPUBuffer(Renderer* renderer, uint64_t size, TransientMemoryType transientMemoryType) : api(renderer->GetRendererBackendAPI()) {
+			// Use the constructor based on the renderer's API
+			switch(api) {
+			case Renderer::RENDERER_BACKEND_API_VULKAN:
+				new(internalData) VulkanBuffer((VulkanRenderer*)renderer->GetRendererBackend(), (VkDeviceSize)size, transientMemoryType == TRANSIENT_MEMORY_TYPE_DYNAMIC ? VulkanAllocator::MEMORY_TYPE_GPU_CPU_VISIBLE : VulkanAllocator::MEMORY_TYPE_CPU_GPU_VISIBLE, true);
+				break;
+			default:
+				throw Exception("Invalid renderer API!");
+			}
+		}
+
 		GPUBuffer() = delete;
 		GPUBuffer(const GPUBuffer&) = delete;
 		GPUBuffer(GPUBuffer&&) noexcept = delete;
@@ -41,6 +78,17 @@ namespace wfe {
 				throw Exception("Invalid renderer API!");
 			}
 		}
+		/// @brief Checks if the buffer is transient.
+		/// @return True if the buffer views the renderer's transient memory, otherwise false.
+		bool8_t IsTransient() const {
+			// Call the is transient function for the renderer's API
+			switch(api) {
+			case Renderer::RENDERER_BACKEND_API_VULKAN:
+				return ((const VulkanBuffer*)internalData)->IsTransient();
+			default:
+				throw Exception("Invalid renderer API!");
+			}
+		}
 		/// @brief Gets the buffer's mapped memory.
 		/// @return A pointer to the buffer's mapped memory, or nullptr if the buffer isn't mapped.
 		void* GetMappedMemory() {
@@ -28,6 +28,26 @@ namespace wfe {
 		}
 	}
 
+	void Renderer::UpdateMemoryBudget() {
+		// Update the memory budgets of the renderer's API
+		switch(rendererBackendAPI) {
+		case RENDERER_BACKEND_API_VULKAN:
+			((VulkanRenderer*)rendererBackend)->GetAllocator()->UpdateMemoryBudget();
+			break;
+		default:
+			throw Exception("Invalid renderer API!");
+		}
+	}
+	Event& Renderer::GetMemoryPressureEvent() {
+		// Get the memory pressure event of the renderer's API
+		switch(rendererBackendAPI) {
+		case RENDERER_BACKEND_API_VULKAN:
+			return ((VulkanRenderer*)rendererBackend)->GetAllocator()->GetMemoryPressureEvent();
+		default:
+			throw Exception("Invalid renderer API!");
+		}
+	}
+
 	Renderer::~Renderer() {
 		// Destroy the renderer backend based on its API
 		switch(rendererBackendAPI) {
@@ -91,6 +91,12 @@ namespace wfe {
 		/// @param fence A pointer to the fence to signal once all command buffers finish execution, or nullptr if no fence will be signaled.
 		void RunCommandBuffers(size_t submitCount, const GPUCommandBufferSubmitInfo* submits, GPUFence* fence);
 
+		/// @brief Updates the budgets of the GPU's memory heaps, calling the memory pressure event for every heap whose pressure level changed. Should be called once per frame.
+		void UpdateMemoryBudget();
+		/// @brief Gets the GPU memory pressure event, which is called by UpdateMemoryBudget with a pointer to the backend's memory pressure info, a VulkanAllocator::MemoryPressureEventInfo for the Vulkan backend.
+		/// @return A reference to the memory pressure event.
+		Event& GetMemoryPressureEvent();
+
 		/// @brief Destroys the renderer.
 		~Renderer();
 	private:
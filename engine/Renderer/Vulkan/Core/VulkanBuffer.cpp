@@ -3,8 +3,11 @@
 #include <vulkan/vk_enum_string_helper.h>
 
 namespace wfe {
+	// Constants
+	static const VkDeviceSize TRANSIENT_BUFFER_MIN_ALIGNMENT = 16;
+
 	// Internal helper functions
-	void VulkanBuffer::CreateBuffer(VulkanAllocator::MemoryType memoryType) {
+	VkResult VulkanBuffer::CreateVkBuffer(VkBuffer& newBuffer) const {
 		// Save all of the device's queue families to an array
 		VulkanDevice::QueueFamilyIndices indices = renderer->GetDevice()->GetQueueFamilyIndices();
 		uint32_t indicesArr[4], indicesCount = 0;
@@ -32,7 +35,11 @@ namespace wfe {
 		};
 
 		// Create the buffer
-		VkResult result = renderer->GetLoader()->vkCreateBuffer(renderer->GetDevice()->GetDevice(), &createInfo, &VulkanRenderer::VULKAN_ALLOC_CALLBACKS, &buffer);
+		return renderer->GetLoader()->vkCreateBuffer(renderer->GetDevice()->GetDevice(), &createInfo, &VulkanRenderer::VULKAN_ALLOC_CALLBACKS, &newBuffer);
+	}
+	void VulkanBuffer::CreateBuffer(VulkanAllocator::MemoryType memoryType) {
+		// Create the buffer
+		VkResult result = CreateVkBuffer(buffer);
 		if(result != VK_SUCCESS)
 			throw Exception("Failed to create Vulkan buffer! Error code: %s", string_VkResult(result));
 		
@@ -45,10 +52,44 @@ namespace wfe {
 		result = renderer->GetAllocator()->BindBufferMemories(1, &buffer, &bufferMemory);
 		if(result != VK_SUCCESS)
 			throw Exception("Failed to bind Vulkan buffer memory! Error code: %s", string_VkResult(result));
+		
+		// Let the allocator's defragmenter move the buffer, if its memory isn't visible from the CPU
+		if(memoryType == VulkanAllocator::MEMORY_TYPE_GPU)
+			renderer->GetAllocator()->SetRelocationCallback(bufferMemory, RelocateBuffer, this);
+	}
+	bool8_t VulkanBuffer::RelocateBuffer(void* userData, VkCommandBuffer commandBuffer, const VulkanAllocator::MemoryBlock& newMemoryBlock, VulkanAllocator::RetiredResource& retiredResource) {
+		VulkanBuffer* vulkanBuffer = (VulkanBuffer*)userData;
+		VulkanRenderer* renderer = vulkanBuffer->renderer;
+
+		// Create the new buffer and bind it to the new memory block
+		VkBuffer newBuffer;
+		if(vulkanBuffer->CreateVkBuffer(newBuffer) != VK_SUCCESS)
+			return false;
+		
+		VkResult result = renderer->GetAllocator()->BindBufferMemories(1, &newBuffer, &newMemoryBlock);
+		if(result != VK_SUCCESS) {
+			renderer->GetLoader()->vkDestroyBuffer(renderer->GetDevice()->GetDevice(), newBuffer, &VulkanRenderer::VULKAN_ALLOC_CALLBACKS);
+			return false;
+		}
+
+		// Record the copy of the buffer's contents to the new buffer
+		VkBufferCopy copyRegion {
+			.srcOffset = 0,
+			.dstOffset = 0,
+			.size = vulkanBuffer->size
+		};
+		renderer->GetLoader()->vkCmdCopyBuffer(commandBuffer, vulkanBuffer->buffer, newBuffer, 1, &copyRegion);
+
+		// Retire the old buffer and switch to the new one
+		retiredResource.buffer = vulkanBuffer->buffer;
+		vulkanBuffer->buffer = newBuffer;
+		vulkanBuffer->bufferMemory = newMemoryBlock;
+
+		return true;
 	}
 
 	// Public functions
-	VulkanBuffer::VulkanBuffer(Renderer* renderer, uint64_t size, bool8_t canMap) : renderer((VulkanRenderer*)renderer->GetRendererBackend()), size(size) {
+	VulkanBuffer::VulkanBuffer(Renderer* renderer, uint64_t size, bool8_t canMap) : renderer((VulkanRenderer*)renderer->GetRendererBackend()), offset(0), size(size), mapped(nullptr), transient(false) {
 		// Set the memory type based on if the buffer can be mapped
 		VulkanAllocator::MemoryType memoryType;
 		if(canMap) {
@@ -60,12 +101,39 @@ namespace wfe {
 		// Create the buffer
 		CreateBuffer(memoryType);
 	}
-	VulkanBuffer::VulkanBuffer(VulkanRenderer* renderer, VkDeviceSize size, VulkanAllocator::MemoryType memoryType) : renderer(renderer), size(size) {
-		// Create the buffer
-		CreateBuffer(memoryType);
+	VulkanBuffer::VulkanBuffer(VulkanRenderer* renderer, VkDeviceSize size, VulkanAllocator::MemoryType memoryType, bool8_t transient) : renderer(renderer), offset(0), size(size), mapped(nullptr), transient(transient) {
+		// Create the buffer and exit the function if it isn't transient
+		if(!transient) {
+			CreateBuffer(memoryType);
+			return;
+		}
+
+		// Align the block for any use of the buffer's data as a uniform, storage, vertex or index buffer
+		const VkPhysicalDeviceLimits& limits = renderer->GetDevice()->GetDeviceProperties().limits;
+		VkDeviceSize alignment = TRANSIENT_BUFFER_MIN_ALIGNMENT;
+		if(limits.minUniformBufferOffsetAlignment > alignment)
+			alignment = limits.minUniformBufferOffsetAlignment;
+		if(limits.minStorageBufferOffsetAlignment > alignment)
+			alignment = limits.minStorageBufferOffsetAlignment;
+
+		// Allocate the buffer's transient memory block
+		VulkanAllocator::TransientBlock transientBlock;
+		VkResult result = renderer->GetAllocator()->AllocTransientMemory(memoryType, size, alignment, transientBlock);
+		if(result != VK_SUCCESS)
+			throw Exception("Failed to allocate Vulkan transient buffer memory! Error code: %s", string_VkResult(result));
+
+		// Set the buffer's info, leaving its memory block empty since the buffer doesn't own any memory
+		buffer = transientBlock.buffer;
+		offset = transientBlock.offset;
+		mapped = transientBlock.mapped;
+		bufferMemory = {};
 	}
 
 	VulkanBuffer::~VulkanBuffer() {
+		// Exit the function if the buffer is transient, since its memory is freed when its frame is reset
+		if(transient)
+			return;
+
 		// Destroy the buffer
 		renderer->GetLoader()->vkDestroyBuffer(renderer->GetDevice()->GetDevice(), buffer, &VulkanRenderer::VULKAN_ALLOC_CALLBACKS);
 
@@ -19,7 +19,8 @@ namespace wfe {
 		/// @param renderer The renderer to create the buffer in.
 		/// @param size The size of the buffer.
 		/// @param memoryType The memory type of the memory binded to the buffer.
-		VulkanBuffer(VulkanRenderer* renderer, VkDeviceSize size, VulkanAllocator::MemoryType memoryType);
+		/// @param transient True if the buffer should view a block of the allocator's transient memory, which is only valid until the current frame in flight is reset, otherwise false. Transient buffers must use MEMORY_TYPE_GPU_CPU_VISIBLE or MEMORY_TYPE_CPU_GPU_VISIBLE.
+		VulkanBuffer(VulkanRenderer* renderer, VkDeviceSize size, VulkanAllocator::MemoryType memoryType, bool8_t transient = false);
 
 		VulkanBuffer() = delete;
 		VulkanBuffer(const VulkanBuffer&) = delete;
@@ -35,30 +36,49 @@ namespace wfe {
 		VulkanAllocator::MemoryBlock GetBufferMemory() {
 			return bufferMemory;
 		}
+		/// @brief Gets the offset in the internal Vulkan buffer at which the buffer's data starts, which is only non-zero for transient buffers.
+		/// @return The buffer's offset in the internal Vulkan buffer.
+		VkDeviceSize GetOffset() const {
+			return offset;
+		}
 		/// @brief Gets the buffer's size.
 		/// @return The buffer's size.
 		VkDeviceSize GetSize() const {
 			return size;
 		}
+		/// @brief Checks if the buffer is transient.
+		/// @return True if the buffer views the allocator's transient memory, otherwise false.
+		bool8_t IsTransient() const {
+			return transient;
+		}
 		/// @brief Gets the buffer's mapped memory.
 		/// @return A pointer to the buffer's mapped memory, or nullptr if the buffer isn't mapped.
 		void* GetMappedMemory() {
+			if(transient)
+				return mapped;
 			return renderer->GetAllocator()->GetMappedMemory(bufferMemory);
 		}
 		/// @brief Gets the buffer's mapped memory.
 		/// @return A const pointer to the buffer's mapped memory, or nullptr if the buffer isn't mapped.
 		const void* GetMappedMemory() const {
+			if(transient)
+				return mapped;
 			return renderer->GetAllocator()->GetMappedMemory(bufferMemory);
 		}
 
 		/// @brief Destroys the Vulkan GPU memory buffer.
 		~VulkanBuffer();
 	private:
+		VkResult CreateVkBuffer(VkBuffer& newBuffer) const;
 		void CreateBuffer(VulkanAllocator::MemoryType memoryType);
+		static bool8_t RelocateBuffer(void* userData, VkCommandBuffer commandBuffer, const VulkanAllocator::MemoryBlock& newMemoryBlock, VulkanAllocator::RetiredResource& retiredResource);
 
 		VulkanRenderer* renderer;
 		VkBuffer buffer;
 		VulkanAllocator::MemoryBlock bufferMemory;
+		VkDeviceSize offset;
 		VkDeviceSize size;
+		void* mapped;
+		bool8_t transient;
 	};
 }
\ No newline at end of file
@@ -215,12 +215,14 @@ namespace wfe {
 		renderer->GetLoader()->vkCmdClearDepthStencilImage(commandBuffer, vulkanImage->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clearDepthStencilValue, 1, &subresourceRange);
 	}
 	void VulkanCommandBuffer::CmdFillBuffer(GPUBuffer& buffer, uint64_t offset, uint64_t size, uint32_t data) {
-		// Record the fill command
-		renderer->GetLoader()->vkCmdFillBuffer(commandBuffer, ((VulkanBuffer*)buffer.GetInternalData())->GetBuffer(), (VkDeviceSize)offset, (VkDeviceSize)size, data);
+		// Record the fill command, offsetting it by the buffer's offset in its internal buffer
+		VulkanBuffer* vulkanBuffer = (VulkanBuffer*)buffer.GetInternalData();
+		renderer->GetLoader()->vkCmdFillBuffer(commandBuffer, vulkanBuffer->GetBuffer(), vulkanBuffer->GetOffset() + (VkDeviceSize)offset, (VkDeviceSize)size, data);
 	}
 	void VulkanCommandBuffer::CmdUpdateBuffer(GPUBuffer& buffer, uint64_t offset, uint64_t size, void* data) {
-		// Record the update command
-		renderer->GetLoader()->vkCmdUpdateBuffer(commandBuffer, ((VulkanBuffer*)buffer.GetInternalData())->GetBuffer(), (VkDeviceSize)offset, (VkDeviceSize)size, data);
+		// Record the update command, offsetting it by the buffer's offset in its internal buffer
+		VulkanBuffer* vulkanBuffer = (VulkanBuffer*)buffer.GetInternalData();
+		renderer->GetLoader()->vkCmdUpdateBuffer(commandBuffer, vulkanBuffer->GetBuffer(), vulkanBuffer->GetOffset() + (VkDeviceSize)offset, (VkDeviceSize)size, data);
 	}
 	void VulkanCommandBuffer::CmdCopyBuffer(GPUBuffer& srcBuffer, GPUBuffer& dstBuffer, size_t regionCount, const GPUBufferCopyRegion* regions) {
 		// Allocate the copy region array
@@ -230,15 +232,17 @@ namespace wfe {
 		if(!copyRegions)
 			throw BadAllocException("Failed to allocate Vulkan buffer copy regions array!");
 		
-		// Set the buffer copy regions
+		// Set the buffer copy regions, offset by the buffers' offsets in their internal buffers
+		VulkanBuffer* vulkanSrcBuffer = (VulkanBuffer*)srcBuffer.GetInternalData();
+		VulkanBuffer* vulkanDstBuffer = (VulkanBuffer*)dstBuffer.GetInternalData();
 		for(size_t i = 0; i != regionCount; ++i) {
-			copyRegions[i].srcOffset = (VkDeviceSize)regions[i].srcOffset;
-			copyRegions[i].dstOffset = (VkDeviceSize)regions[i].dstOffset;
+			copyRegions[i].srcOffset = vulkanSrcBuffer->GetOffset() + (VkDeviceSize)regions[i].srcOffset;
+			copyRegions[i].dstOffset = vulkanDstBuffer->GetOffset() + (VkDeviceSize)regions[i].dstOffset;
 			copyRegions[i].size = (VkDeviceSize)regions[i].size;
 		}
 
 		// Record the copy command
-		renderer->GetLoader()->vkCmdCopyBuffer(commandBuffer, ((VulkanBuffer*)srcBuffer.GetInternalData())->GetBuffer(), ((VulkanBuffer*)dstBuffer.GetInternalData())->GetBuffer(), (uint32_t)regionCount, copyRegions);
+		renderer->GetLoader()->vkCmdCopyBuffer(commandBuffer, vulkanSrcBuffer->GetBuffer(), vulkanDstBuffer->GetBuffer(), (uint32_t)regionCount, copyRegions);
 
 		// Free the copy region array
 		FreeMemory(copyRegions);
@@ -345,9 +349,10 @@ namespace wfe {
 		if(!copyRegions)
 			throw BadAllocException("Failed to allocate Vulkan buffer image copy regions array!");
 
-		// Set the copy regions
+		// Set the copy regions, offset by the buffer's offset in its internal buffer
+		VulkanBuffer* vulkanBuffer = (VulkanBuffer*)buffer.GetInternalData();
 		for(size_t i = 0; i != regionCount; ++i) {
-			copyRegions[i].bufferOffset = (VkDeviceSize)regions[i].bufferOffset;
+			copyRegions[i].bufferOffset = vulkanBuffer->GetOffset() + (VkDeviceSize)regions[i].bufferOffset;
 			copyRegions[i].bufferRowLength = 0;
 			copyRegions[i].bufferImageHeight = 0;
 			copyRegions[i].imageSubresource = {
@@ -369,7 +374,7 @@ namespace wfe {
 		}
 
 		// Record the copy command
-		renderer->GetLoader()->vkCmdCopyBufferToImage(commandBuffer, ((VulkanBuffer*)buffer.GetInternalData())->GetBuffer(), vulkanImage->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t)regionCount, copyRegions);
+		renderer->GetLoader()->vkCmdCopyBufferToImage(commandBuffer, vulkanBuffer->GetBuffer(), vulkanImage->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t)regionCount, copyRegions);
 
 		// Free the copy region array
 		FreeMemory(copyRegions);
@@ -386,9 +391,10 @@ namespace wfe {
 		if(!copyRegions)
 			throw BadAllocException("Failed to allocate Vulkan buffer image copy regions array!");
 
-		// Set the copy regions
+		// Set the copy regions, offset by the buffer's offset in its internal buffer
+		VulkanBuffer* vulkanBuffer = (VulkanBuffer*)buffer.GetInternalData();
 		for(size_t i = 0; i != regionCount; ++i) {
-			copyRegions[i].bufferOffset = (VkDeviceSize)regions[i].bufferOffset;
+			copyRegions[i].bufferOffset = vulkanBuffer->GetOffset() + (VkDeviceSize)regions[i].bufferOffset;
 			copyRegions[i].bufferRowLength = 0;
 			copyRegions[i].bufferImageHeight = 0;
 			copyRegions[i].imageSubresource = {
@@ -410,7 +416,7 @@ namespace wfe {
 		}
 
 		// Record the copy command
-		renderer->GetLoader()->vkCmdCopyImageToBuffer(commandBuffer, vulkanImage->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, ((VulkanBuffer*)buffer.GetInternalData())->GetBuffer(), (uint32_t)regionCount, copyRegions);
+		renderer->GetLoader()->vkCmdCopyImageToBuffer(commandBuffer, vulkanImage->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, vulkanBuffer->GetBuffer(), (uint32_t)regionCount, copyRegions);
 
 		// Free the copy region array
 		FreeMemory(copyRegions);
@@ -3,8 +3,11 @@
 #include <vulkan/vk_enum_string_helper.h>
 
 namespace wfe {
+	// Internal static variables
+	static AtomicMutex transferMutex;
+
 	// Internal helper functions
-	void VulkanImage::CreateImage(VkImageType imageType, VkFormat format, uint32_t mipLevels, uint32_t arrayLayers, VkSampleCountFlagBits samples, VkImageTiling tiling, VkImageViewType viewType, VulkanAllocator::MemoryType memoryType) {
+	VkResult VulkanImage::CreateVkImage(VkImage& newImage) const {
 		// Save all of the device's queue families to an array
 		VulkanDevice::QueueFamilyIndices indices = renderer->GetDevice()->GetQueueFamilyIndices();
 		uint32_t indicesArr[4], indicesCount = 0;
@@ -27,8 +30,8 @@ namespace wfe {
 			.imageType = imageType,
 			.format = format,
 			.extent = imageExtent,
-			.mipLevels = mipLevels,
-			.arrayLayers = arrayLayers,
+			.mipLevels = subresourceRange.levelCount,
+			.arrayLayers = subresourceRange.layerCount,
 			.samples = samples,
 			.tiling = tiling,
 			.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT,
@@ -39,19 +42,36 @@ namespace wfe {
 		};
 
 		// Create the image
-		VkResult result = renderer->GetLoader()->vkCreateImage(renderer->GetDevice()->GetDevice(), &imageInfo, &VulkanRenderer::VULKAN_ALLOC_CALLBACKS, &image);
-		if(result != VK_SUCCESS)
-			throw Exception("Failed to create Vulkan image! Error code: %s", string_VkResult(result));
-		
-		// Allocate the image's memory
-		result = renderer->GetAllocator()->AllocImageMemory(image, memoryType, imageMemory);
-		if(result != VK_SUCCESS)
-			throw Exception("Failed to allocate Vulkan image memory! Error code: %s", string_VkResult(result));
+		return renderer->GetLoader()->vkCreateImage(renderer->GetDevice()->GetDevice(), &imageInfo, &VulkanRenderer::VULKAN_ALLOC_CALLBACKS, &newImage);
+	}
+	VkResult VulkanImage::CreateVkImageView(VkImage newImage, VkImageView& newImageView) const {
+		// Set the image view create info
+		VkImageViewCreateInfo imageViewInfo {
+			.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.image = newImage,
+			.viewType = viewType,
+			.format = format,
+			.components = {
+				.r = VK_COMPONENT_SWIZZLE_IDENTITY,
+				.g = VK_COMPONENT_SWIZZLE_IDENTITY,
+				.b = VK_COMPONENT_SWIZZLE_IDENTITY,
+				.a = VK_COMPONENT_SWIZZLE_IDENTITY
+			},
+			.subresourceRange = subresourceRange
+		};
 
-		// Bind the image's memory
-		result = renderer->GetAllocator()->BindImageMemories(1, &image, &imageMemory);
-		if(result != VK_SUCCESS)
-			throw Exception("Failed to bind Vulkan image memory! Error code: %s", string_VkResult(result));
+		// Create the image view
+		return renderer->GetLoader()->vkCreateImageView(renderer->GetDevice()->GetDevice(), &imageViewInfo, &VulkanRenderer::VULKAN_ALLOC_CALLBACKS, &newImageView);
+	}
+	void VulkanImage::CreateImage(VkImageType imageType, VkFormat format, uint32_t mipLevels, uint32_t arrayLayers, VkSampleCountFlagBits samples, VkImageTiling tiling, VkImageViewType viewType, VulkanAllocator::MemoryType memoryType) {
+		// Save the image's create parameters, which are needed to recreate it when it's relocated
+		this->imageType = imageType;
+		this->format = format;
+		this->samples = samples;
+		this->tiling = tiling;
+		this->viewType = viewType;
 
 		// Set the image aspect mask based on the image's format
 		VkImageAspectFlags aspectMask;
@@ -73,26 +93,24 @@ namespace wfe {
 			.baseArrayLayer = 0,
 			.layerCount = arrayLayers
 		};
+
+		// Create the image
+		VkResult result = CreateVkImage(image);
+		if(result != VK_SUCCESS)
+			throw Exception("Failed to create Vulkan image! Error code: %s", string_VkResult(result));
 		
-		// Set the image view create info
-		VkImageViewCreateInfo imageViewInfo {
-			.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-			.pNext = nullptr,
-			.flags = 0,
-			.image = image,
-			.viewType = viewType,
-			.format = format,
-			.components = {
-				.r = VK_COMPONENT_SWIZZLE_IDENTITY,
-				.g = VK_COMPONENT_SWIZZLE_IDENTITY,
-				.b = VK_COMPONENT_SWIZZLE_IDENTITY,
-				.a = VK_COMPONENT_SWIZZLE_IDENTITY
-			},
-			.subresourceRange = subresourceRange
-		};
+		// Allocate the image's memory
+		result = renderer->GetAllocator()->AllocImageMemory(image, memoryType, imageMemory);
+		if(result != VK_SUCCESS)
+			throw Exception("Failed to allocate Vulkan image memory! Error code: %s", string_VkResult(result));
+
+		// Bind the image's memory
+		result = renderer->GetAllocator()->BindImageMemories(1, &image, &imageMemory);
+		if(result != VK_SUCCESS)
+			throw Exception("Failed to bind Vulkan image memory! Error code: %s", string_VkResult(result));
 
 		// Create the image view
-		result = renderer->GetLoader()->vkCreateImageView(renderer->GetDevice()->GetDevice(), &imageViewInfo, &VulkanRenderer::VULKAN_ALLOC_CALLBACKS, &imageView);
+		result = CreateVkImageView(image, imageView);
 		if(result != VK_SUCCESS)
 			throw Exception("Failed to create Vulkan image view! Error code: %s", string_VkResult(result));
 
@@ -105,11 +123,14 @@ namespace wfe {
 			.commandBufferCount = 1
 		};
 
-		// Allocate the command buffer
+		// Allocate the command buffer, locking the transfer command pool and queue until the command buffer is submitted, so that images can be created from multiple threads
+		transferMutex.Lock();
 		VkCommandBuffer commandBuffer;
 		result = renderer->GetLoader()->vkAllocateCommandBuffers(renderer->GetDevice()->GetDevice(), &allocInfo, &commandBuffer);
-		if(result != VK_SUCCESS)
+		if(result != VK_SUCCESS) {
+			transferMutex.Unlock();
 			throw Exception("Failed to allocate Vulkan command buffer! Error code: %s", string_VkResult(result));
+		}
 		
 		// Set the command buffer begin info
 		VkCommandBufferBeginInfo beginInfo {
@@ -121,8 +142,10 @@ namespace wfe {
 
 		// Begin recording the command buffer
 		result = renderer->GetLoader()->vkBeginCommandBuffer(commandBuffer, &beginInfo);
-		if(result != VK_SUCCESS)
+		if(result != VK_SUCCESS) {
+			transferMutex.Unlock();
 			throw Exception("Failed to begin recording Vulkan command buffer! Error code: %s", string_VkResult(result));
+		}
 		
 		// Set the image memory barrier info
 		VkImageMemoryBarrier memoryBarrier {
@@ -149,8 +172,10 @@ namespace wfe {
 
 		// End recording the command buffer
 		result = renderer->GetLoader()->vkEndCommandBuffer(commandBuffer);
-		if(result != VK_SUCCESS)
+		if(result != VK_SUCCESS) {
+			transferMutex.Unlock();
 			throw Exception("Failed to end recording Vulkan command buffer! Error code: %s", string_VkResult(result));
+		}
 		
 		// Set the fence create info
 		VkFenceCreateInfo fenceInfo {
@@ -162,8 +187,10 @@ namespace wfe {
 		// Create the fence
 		VkFence fence;
 		result = renderer->GetLoader()->vkCreateFence(renderer->GetDevice()->GetDevice(), &fenceInfo, &VulkanRenderer::VULKAN_ALLOC_CALLBACKS, &fence);
-		if(result != VK_SUCCESS)
+		if(result != VK_SUCCESS) {
+			transferMutex.Unlock();
 			throw Exception("Failed to create Vulkan fence! Error code: %s", string_VkResult(result));
+		}
 		
 		// Set the command buffer submit info
 		VkSubmitInfo submitInfo {
@@ -180,6 +207,7 @@ namespace wfe {
 
 		// Submit the command buffer
 		result = renderer->GetLoader()->vkQueueSubmit(renderer->GetDevice()->GetTransferQueue(), 1, &submitInfo, fence);
+		transferMutex.Unlock();
 		if(result != VK_SUCCESS)
 			throw Exception("Failed to submit Vulkan command buffer! Error code: %s", string_VkResult(result));
 		
@@ -190,7 +218,92 @@ namespace wfe {
 		
 		// Destroy the fence and free the command buffer
 		renderer->GetLoader()->vkDestroyFence(renderer->GetDevice()->GetDevice(), fence, &VulkanRenderer::VULKAN_ALLOC_CALLBACKS);
+
+		transferMutex.Lock();
 		renderer->GetLoader()->vkFreeCommandBuffers(renderer->GetDevice()->GetDevice(), renderer->GetTransferCommandPool()->GetCommandPool(), 1, &commandBuffer);
+		transferMutex.Unlock();
+
+		// Let the allocator's defragmenter move the image, if its memory isn't visible from the CPU
+		if(memoryType == VulkanAllocator::MEMORY_TYPE_GPU)
+			renderer->GetAllocator()->SetRelocationCallback(imageMemory, RelocateImage, this);
+	}
+	bool8_t VulkanImage::RelocateImage(void* userData, VkCommandBuffer commandBuffer, const VulkanAllocator::MemoryBlock& newMemoryBlock, VulkanAllocator::RetiredResource& retiredResource) {
+		VulkanImage* vulkanImage = (VulkanImage*)userData;
+		VulkanRenderer* renderer = vulkanImage->renderer;
+
+		// Create the new image, bind it to the new memory block and create its view
+		VkImage newImage;
+		if(vulkanImage->CreateVkImage(newImage) != VK_SUCCESS)
+			return false;
+		
+		VkImageView newImageView;
+		VkResult result = renderer->GetAllocator()->BindImageMemories(1, &newImage, &newMemoryBlock);
+		if(result == VK_SUCCESS)
+			result = vulkanImage->CreateVkImageView(newImage, newImageView);
+		if(result != VK_SUCCESS) {
+			renderer->GetLoader()->vkDestroyImage(renderer->GetDevice()->GetDevice(), newImage, &VulkanRenderer::VULKAN_ALLOC_CALLBACKS);
+			return false;
+		}
+
+		// Record the new image's transition to the general layout, which every image is kept in between command buffers
+		VkImageMemoryBarrier memoryBarrier {
+			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+			.pNext = nullptr,
+			.srcAccessMask = 0,
+			.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+			.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+			.newLayout = VK_IMAGE_LAYOUT_GENERAL,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.image = newImage,
+			.subresourceRange = vulkanImage->subresourceRange
+		};
+		renderer->GetLoader()->vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &memoryBarrier);
+
+		// Set a copy region for every mip level of the image
+		PushMemoryUsageType(MEMORY_USAGE_TYPE_COMMAND);
+		VkImageCopy* copyRegions = (VkImageCopy*)AllocMemory(sizeof(VkImageCopy) * vulkanImage->subresourceRange.levelCount);
+		PopMemoryUsageType();
+		if(!copyRegions) {
+			renderer->GetLoader()->vkDestroyImageView(renderer->GetDevice()->GetDevice(), newImageView, &VulkanRenderer::VULKAN_ALLOC_CALLBACKS);
+			renderer->GetLoader()->vkDestroyImage(renderer->GetDevice()->GetDevice(), newImage, &VulkanRenderer::VULKAN_ALLOC_CALLBACKS);
+			return false;
+		}
+
+		for(uint32_t i = 0; i != vulkanImage->subresourceRange.levelCount; ++i) {
+			VkImageSubresourceLayers subresource {
+				.aspectMask = vulkanImage->subresourceRange.aspectMask,
+				.mipLevel = i,
+				.baseArrayLayer = 0,
+				.layerCount = vulkanImage->subresourceRange.layerCount
+			};
+			VkExtent3D extent {
+				.width = vulkanImage->imageExtent.width >> i ? vulkanImage->imageExtent.width >> i : 1,
+				.height = vulkanImage->imageExtent.height >> i ? vulkanImage->imageExtent.height >> i : 1,
+				.depth = vulkanImage->imageExtent.depth >> i ? vulkanImage->imageExtent.depth >> i : 1
+			};
+
+			copyRegions[i] = {
+				.srcSubresource = subresource,
+				.srcOffset = { 0, 0, 0 },
+				.dstSubresource = subresource,
+				.dstOffset = { 0, 0, 0 },
+				.extent = extent
+			};
+		}
+
+		// Record the copy of the image's contents to the new image
+		renderer->GetLoader()->vkCmdCopyImage(commandBuffer, vulkanImage->image, VK_IMAGE_LAYOUT_GENERAL, newImage, VK_IMAGE_LAYOUT_GENERAL, vulkanImage->subresourceRange.levelCount, copyRegions);
+		FreeMemory(copyRegions);
+
+		// Retire the old image and view and switch to the new ones
+		retiredResource.image = vulkanImage->image;
+		retiredResource.imageView = vulkanImage->imageView;
+		vulkanImage->image = newImage;
+		vulkanImage->imageView = newImageView;
+		vulkanImage->imageMemory = newMemoryBlock;
+
+		return true;
 	}
 
 	// Public functions
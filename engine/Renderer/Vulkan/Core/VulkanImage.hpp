@@ -106,7 +106,10 @@ namespace wfe {
 		/// @brief Destroys the Vulkan GPU image.
 		~VulkanImage();
 	private:
+		VkResult CreateVkImage(VkImage& newImage) const;
+		VkResult CreateVkImageView(VkImage newImage, VkImageView& newImageView) const;
 		void CreateImage(VkImageType imageType, VkFormat format, uint32_t mipLevels, uint32_t arrayLayers, VkSampleCountFlagBits samples, VkImageTiling tiling, VkImageViewType viewType, VulkanAllocator::MemoryType memoryType);
+		static bool8_t RelocateImage(void* userData, VkCommandBuffer commandBuffer, const VulkanAllocator::MemoryBlock& newMemoryBlock, VulkanAllocator::RetiredResource& retiredResource);
 
 		VulkanRenderer* renderer;
 		VkImage image;
@@ -114,5 +117,11 @@ namespace wfe {
 		VulkanAllocator::MemoryBlock imageMemory;
 		VkExtent3D imageExtent;
 		VkImageSubresourceRange subresourceRange;
+
+		VkImageType imageType;
+		VkFormat format;
+		VkSampleCountFlagBits samples;
+		VkImageTiling tiling;
+		VkImageViewType viewType;
     };
 }
\ No newline at end of file
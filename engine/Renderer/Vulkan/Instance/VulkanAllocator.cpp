@@ -1,6 +1,8 @@
 #include "VulkanAllocator.hpp"
 #include "Renderer/Vulkan/VulkanRenderer.hpp"
 
+#include <bit>
+
 namespace wfe {
 	// Constants
 	static const VkDeviceSize MEMORY_BLOCK_SIZES[] {
@@ -15,45 +17,284 @@ namespace wfe {
 		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, // MEMORY_TYPE_GPU_CPU_VISIBLE
 		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT                                        // MEMORY_TYPE_CPU_GPU_VISIBLE
 	};
-	static const size_t FREE_BLOCK_START_COUNT = 16;
+	static const VkDeviceSize TRANSIENT_RING_SIZES[] {
+		0,         // MEMORY_TYPE_GPU_LAZY
+		0,         // MEMORY_TYPE_GPU
+		0x1000000, // MEMORY_TYPE_GPU_CPU_VISIBLE
+		0x1000000  // MEMORY_TYPE_CPU_GPU_VISIBLE
+	};
+	static const VkDeviceSize DEFRAGMENT_USAGE_DIVISOR = 2; // Only memory blocks at most half used are drained
+	static const VkDeviceSize MEMORY_PRESSURE_THRESHOLDS[] {
+		0,  // MEMORY_PRESSURE_NONE
+		75, // MEMORY_PRESSURE_MODERATE
+		90, // MEMORY_PRESSURE_HIGH
+		100 // MEMORY_PRESSURE_CRITICAL
+	};
+	static const VkDeviceSize MEMORY_PRESSURE_HYSTERESIS = 5; // A heap's pressure only drops once its usage is 5% of its budget below the level's threshold
+	static const VkDeviceSize FALLBACK_BUDGET_PERCENTAGE = 80; // Without VK_EXT_memory_budget, 80% of every heap's size is used as its budget
+	static const uint32_t MAX_MEMORY_BLOCK_SIZE_SHIFT = 3; // New memory blocks are shrunk down to an eighth of their size when their heap is near its budget
 
 	// Internal helper functions
-	size_t VulkanAllocator::InternalAllocFreeListBlock() {
-		// Check if there are no unused free blocks
-		if(freeBlockList.first == SIZE_T_MAX) {
-			// Save the old free block count
-			size_t oldSize = freeBlocks.size();
-
-			// Double the free block count
-			freeBlocks.resize(freeBlocks.size() << 1);
-
-			// Set the new values
-			freeBlocks[oldSize].prev = SIZE_T_MAX;
-			for(size_t i = oldSize; i != freeBlocks.size() - 1; ++i) {
-				freeBlocks[i].next = i + 1;
-				freeBlocks[i + 1].prev = i;
-			}
-			freeBlocks[freeBlocks.size() - 1].next = SIZE_T_MAX;
-
-			// Set the free list's new start and end
-			freeBlockList.first = oldSize;
-			freeBlockList.last = freeBlocks.size() - 1;
+	void VulkanAllocator::InternalGetSizeClass(VkDeviceSize size, uint32_t& firstLevel, uint32_t& secondLevel) {
+		// Map small sizes directly to the first level's classes
+		if(size < SECOND_LEVEL_COUNT) {
+			firstLevel = 0;
+			secondLevel = (uint32_t)size;
+			return;
 		}
 
-		// Save the first free block's index
-		size_t freeBlockIndex = freeBlockList.first;
+		// Split the size's power of two range into equally sized second level classes
+		uint32_t sizeLog2 = (uint32_t)std::bit_width(size) - 1;
+		firstLevel = sizeLog2 - SECOND_LEVEL_SHIFT + 1;
+		secondLevel = (uint32_t)(size >> (sizeLog2 - SECOND_LEVEL_SHIFT)) - SECOND_LEVEL_COUNT;
+	}
+	VkDeviceSize VulkanAllocator::InternalGetHeapUsage(const HeapInfo& heapInfo) {
+		// Add the device memory allocated since the last query to the queried usage
+		if(heapInfo.allocatedSize < heapInfo.queriedAllocatedSize) {
+			VkDeviceSize freedSize = heapInfo.queriedAllocatedSize - heapInfo.allocatedSize;
+			return heapInfo.queriedUsage > freedSize ? heapInfo.queriedUsage - freedSize : 0;
+		}
 		
-		// Remove the block from the free block list
-		freeBlockList.first = freeBlocks[freeBlockIndex].next;
-		if(freeBlocks[freeBlockIndex].next != SIZE_T_MAX) {
-			freeBlocks[freeBlocks[freeBlockIndex].next].prev = SIZE_T_MAX;
-		} else {
-			freeBlockList.last = SIZE_T_MAX;
+		return heapInfo.queriedUsage + heapInfo.allocatedSize - heapInfo.queriedAllocatedSize;
+	}
+	VulkanAllocator::MemoryPressure VulkanAllocator::InternalGetMemoryPressure(VkDeviceSize usage, VkDeviceSize budget, MemoryPressure oldPressure) {
+		// Find the highest level whose threshold the usage reached
+		MemoryPressure pressure = MEMORY_PRESSURE_NONE;
+		for(uint32_t i = 1; i != (uint32_t)MEMORY_PRESSURE_COUNT; ++i)
+			if(usage * 100 >= budget * MEMORY_PRESSURE_THRESHOLDS[i])
+				pressure = (MemoryPressure)i;
+		
+		// Keep the old level if the usage didn't drop far enough below its threshold, so that the pressure doesn't flicker around it
+		if(pressure < oldPressure && (usage + budget * MEMORY_PRESSURE_HYSTERESIS / 100) * 100 >= budget * MEMORY_PRESSURE_THRESHOLDS[oldPressure])
+			return oldPressure;
+		
+		return pressure;
+	}
+	bool8_t VulkanAllocator::InternalReserveNodes(BlockPool& pool, size_t count) {
+		// Exit the function if the pool already has enough unused nodes
+		size_t unusedCount = 0;
+		for(size_t index = pool.unusedNodes; index != SIZE_T_MAX && unusedCount != count; index = InternalGetNode(index).nextFree)
+			++unusedCount;
+		if(unusedCount == count)
+			return true;
+
+		// Allocate a new page of nodes; pages are never moved, so other pools can keep using their nodes without taking this lock
+		nodeMutex.Lock();
+		if(nodePageCount == MAX_NODE_PAGE_COUNT) {
+			nodeMutex.Unlock();
+			return false;
+		}
+
+		BlockNode* page = (BlockNode*)AllocMemory(sizeof(BlockNode) * NODE_PAGE_SIZE);
+		if(!page) {
+			nodeMutex.Unlock();
+			return false;
+		}
+
+		size_t pageIndex = nodePageCount++;
+		nodePages[pageIndex] = page;
+		nodeMutex.Unlock();
+
+		// Add the page's nodes to the start of the pool's unused node list
+		for(size_t i = 0; i != NODE_PAGE_SIZE - 1; ++i)
+			page[i].nextFree = (pageIndex << NODE_PAGE_SHIFT) + i + 1;
+		page[NODE_PAGE_SIZE - 1].nextFree = pool.unusedNodes;
+
+		pool.unusedNodes = pageIndex << NODE_PAGE_SHIFT;
+
+		return true;
+	}
+	size_t VulkanAllocator::InternalAllocNode(BlockPool& pool) {
+		// Remove the first unused node from the list; the caller must have reserved it
+		size_t index = pool.unusedNodes;
+		pool.unusedNodes = InternalGetNode(index).nextFree;
+
+		return index;
+	}
+	void VulkanAllocator::InternalFreeNode(BlockPool& pool, size_t index) {
+		// Add the node to the pool's unused node list
+		InternalGetNode(index).nextFree = pool.unusedNodes;
+		pool.unusedNodes = index;
+	}
+	void VulkanAllocator::InternalInsertFreeNode(BlockPool& pool, size_t index) {
+		// Get the node's size class
+		uint32_t firstLevel, secondLevel;
+		InternalGetSizeClass(InternalGetNode(index).size, firstLevel, secondLevel);
+
+		// Add the node to the start of its class's free list
+		size_t& first = pool.freeLists[firstLevel][secondLevel];
+		size_t next = (pool.secondLevelBitmaps[firstLevel] & (1u << secondLevel)) ? first : SIZE_T_MAX;
+
+		InternalGetNode(index).free = true;
+		InternalGetNode(index).prevFree = SIZE_T_MAX;
+		InternalGetNode(index).nextFree = next;
+		if(next != SIZE_T_MAX)
+			InternalGetNode(next).prevFree = index;
+		first = index;
+
+		// Mark the class as non-empty
+		pool.firstLevelBitmap |= 1u << firstLevel;
+		pool.secondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+	}
+	void VulkanAllocator::InternalRemoveFreeNode(BlockPool& pool, size_t index) {
+		// Remove the node from its class's free list
+		BlockNode& node = InternalGetNode(index);
+		node.free = false;
+
+		if(node.nextFree != SIZE_T_MAX)
+			InternalGetNode(node.nextFree).prevFree = node.prevFree;
+		if(node.prevFree != SIZE_T_MAX) {
+			InternalGetNode(node.prevFree).nextFree = node.nextFree;
+			return;
+		}
+
+		// Set the list's new start, marking the class as empty if no nodes are left
+		uint32_t firstLevel, secondLevel;
+		InternalGetSizeClass(node.size, firstLevel, secondLevel);
+
+		pool.freeLists[firstLevel][secondLevel] = node.nextFree;
+		if(node.nextFree == SIZE_T_MAX) {
+			pool.secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+			if(!pool.secondLevelBitmaps[firstLevel])
+				pool.firstLevelBitmap &= ~(1u << firstLevel);
+		}
+	}
+	size_t VulkanAllocator::InternalFindFreeNode(const BlockPool& pool, VkDeviceSize size) const {
+		// Round the size up to the next class, so that every node in the found class is large enough
+		if(size >= SECOND_LEVEL_COUNT)
+			size += ((VkDeviceSize)1 << (std::bit_width(size) - 1 - SECOND_LEVEL_SHIFT)) - 1;
+
+		uint32_t firstLevel, secondLevel;
+		InternalGetSizeClass(size, firstLevel, secondLevel);
+		if(firstLevel >= FIRST_LEVEL_COUNT)
+			return SIZE_T_MAX;
+
+		// Look for a non-empty class in the size's first level, then in the larger first levels
+		uint32_t secondLevelBitmap = pool.secondLevelBitmaps[firstLevel] & (UINT32_T_MAX << secondLevel);
+		if(!secondLevelBitmap) {
+			uint32_t firstLevelBitmap = firstLevel + 1 != FIRST_LEVEL_COUNT ? pool.firstLevelBitmap & (UINT32_T_MAX << (firstLevel + 1)) : 0;
+			if(!firstLevelBitmap)
+				return SIZE_T_MAX;
+
+			firstLevel = (uint32_t)std::countr_zero(firstLevelBitmap);
+			secondLevelBitmap = pool.secondLevelBitmaps[firstLevel];
+		}
+
+		return pool.freeLists[firstLevel][std::countr_zero(secondLevelBitmap)];
+	}
+	bool8_t VulkanAllocator::InternalAllocFromNode(BlockPool& pool, size_t index, const VkMemoryRequirements& memRequirements, MemoryBlock& memoryBlock) {
+		// Reserve the nodes for the alignment padding and the leftover space before changing the pool, so that running out of nodes leaves it untouched
+		if(!InternalReserveNodes(pool, 2))
+			return false;
+
+		// Remove the node from its free list
+		InternalRemoveFreeNode(pool, index);
+
+		// Get the required alignment for the requested resource and the remaining size after it
+		VkDeviceSize alignedOffset = (InternalGetNode(index).offset + memRequirements.alignment - 1) & ~(memRequirements.alignment - 1);
+		VkDeviceSize alignment = alignedOffset - InternalGetNode(index).offset;
+		VkDeviceSize leftoverFreeSize = InternalGetNode(index).size - alignment - memRequirements.size;
+
+		// Keep the alignment padding as a free node and split the resource into a new node after it
+		size_t allocIndex = index;
+		if(alignment) {
+			allocIndex = InternalAllocNode(pool);
+
+			InternalGetNode(allocIndex).offset = alignedOffset;
+			InternalGetNode(allocIndex).memory = InternalGetNode(index).memory;
+			InternalGetNode(allocIndex).memoryInfo = InternalGetNode(index).memoryInfo;
+			InternalGetNode(allocIndex).prevPhysical = index;
+			InternalGetNode(allocIndex).nextPhysical = InternalGetNode(index).nextPhysical;
+			if(InternalGetNode(index).nextPhysical != SIZE_T_MAX)
+				InternalGetNode(InternalGetNode(index).nextPhysical).prevPhysical = allocIndex;
+			InternalGetNode(index).nextPhysical = allocIndex;
+
+			InternalGetNode(index).size = alignment;
+			InternalInsertFreeNode(pool, index);
+		}
+
+		InternalGetNode(allocIndex).size = memRequirements.size;
+		InternalGetNode(allocIndex).alignment = memRequirements.alignment;
+		InternalGetNode(allocIndex).relocationCallback = nullptr;
+		InternalGetNode(allocIndex).relocationUserData = nullptr;
+		InternalGetNode(allocIndex).free = false;
+
+		// Split the remaining size into a new free node after the resource
+		if(leftoverFreeSize) {
+			size_t freeIndex = InternalAllocNode(pool);
+
+			InternalGetNode(freeIndex).offset = alignedOffset + memRequirements.size;
+			InternalGetNode(freeIndex).size = leftoverFreeSize;
+			InternalGetNode(freeIndex).memory = InternalGetNode(allocIndex).memory;
+			InternalGetNode(freeIndex).memoryInfo = InternalGetNode(allocIndex).memoryInfo;
+			InternalGetNode(freeIndex).prevPhysical = allocIndex;
+			InternalGetNode(freeIndex).nextPhysical = InternalGetNode(allocIndex).nextPhysical;
+			if(InternalGetNode(allocIndex).nextPhysical != SIZE_T_MAX)
+				InternalGetNode(InternalGetNode(allocIndex).nextPhysical).prevPhysical = freeIndex;
+			InternalGetNode(allocIndex).nextPhysical = freeIndex;
+
+			InternalInsertFreeNode(pool, freeIndex);
+		}
+
+		// Set the memory block's info
+		memoryBlock.offset = alignedOffset;
+		memoryBlock.size = memRequirements.size;
+		memoryBlock.memory = InternalGetNode(allocIndex).memory;
+		memoryBlock.allocIndex = allocIndex;
+
+		// Add the resource to the memory's usage, pinning it until a relocation callback is set
+		MemoryBlockInfo* memoryInfo = InternalGetNode(allocIndex).memoryInfo;
+		memoryInfo->usedSize += memRequirements.size;
+		++memoryInfo->pinnedCount;
+
+		return true;
+	}
+	void VulkanAllocator::InternalReleaseNode(size_t index) {
+		// Get the pool the node is in and remove the node's resource from the memory's usage
+		MemoryBlockInfo& memoryInfo = *InternalGetNode(index).memoryInfo;
+		BlockPool& pool = typeInfos[memoryInfo.memoryTypeIndex].pools[memoryInfo.resourceType];
+
+		memoryInfo.usedSize -= InternalGetNode(index).size;
+		if(!InternalGetNode(index).relocationCallback)
+			--memoryInfo.pinnedCount;
+
+		// Merge the next node into the freed node, if it's free; a drained memory's free nodes aren't in the pool
+		size_t nextIndex = InternalGetNode(index).nextPhysical;
+		if(nextIndex != SIZE_T_MAX && InternalGetNode(nextIndex).free) {
+			if(!memoryInfo.draining)
+				InternalRemoveFreeNode(pool, nextIndex);
+
+			InternalGetNode(index).size += InternalGetNode(nextIndex).size;
+			InternalGetNode(index).nextPhysical = InternalGetNode(nextIndex).nextPhysical;
+			if(InternalGetNode(nextIndex).nextPhysical != SIZE_T_MAX)
+				InternalGetNode(InternalGetNode(nextIndex).nextPhysical).prevPhysical = index;
+
+			InternalFreeNode(pool, nextIndex);
 		}
 
-		return freeBlockIndex;
+		// Merge the freed node into the previous node, if it's free
+		size_t prevIndex = InternalGetNode(index).prevPhysical;
+		if(prevIndex != SIZE_T_MAX && InternalGetNode(prevIndex).free) {
+			if(!memoryInfo.draining)
+				InternalRemoveFreeNode(pool, prevIndex);
+
+			InternalGetNode(prevIndex).size += InternalGetNode(index).size;
+			InternalGetNode(prevIndex).nextPhysical = InternalGetNode(index).nextPhysical;
+			if(InternalGetNode(index).nextPhysical != SIZE_T_MAX)
+				InternalGetNode(InternalGetNode(index).nextPhysical).prevPhysical = prevIndex;
+
+			InternalFreeNode(pool, index);
+			index = prevIndex;
+		}
+
+		// Add the final node to its free list, unless the memory is being drained
+		if(memoryInfo.draining) {
+			InternalGetNode(index).free = true;
+		} else {
+			InternalInsertFreeNode(pool, index);
+		}
 	}
-	VkResult VulkanAllocator::InternalAllocDeviceMemory(VkDeviceSize size, VkDeviceSize freeSize, uint32_t memoryTypeIndex, ResourceType resourceType, VkBuffer dedicatedBuffer, VkImage dedicatedImage, VkDeviceMemory& memory) {
+	VkResult VulkanAllocator::InternalAllocDeviceMemory(VkDeviceSize size, uint32_t memoryTypeIndex, ResourceType resourceType, VkBuffer dedicatedBuffer, VkImage dedicatedImage, VkDeviceMemory& memory, MemoryBlockInfo*& memoryInfo) {
 		// Set the alloc info
 		VkMemoryAllocateInfo allocInfo {
 			.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
@@ -87,72 +328,53 @@ namespace wfe {
 			mapped = nullptr;
 		}
 		
-		// Set the free block's info, if any free memory is available
-		size_t freeBlockIndex;
-		if(freeSize) {
-			// Allocate the free block
-			freeBlockIndex = InternalAllocFreeListBlock();
-
-			// Set its info
-			freeBlocks[freeBlockIndex].offset = size - freeSize;
-			freeBlocks[freeBlockIndex].size = freeSize;
-			freeBlocks[freeBlockIndex].prev = SIZE_T_MAX;
-			freeBlocks[freeBlockIndex].next = SIZE_T_MAX;
-		} else {
-			freeBlockIndex = SIZE_T_MAX;
-		}
-
-		// Set the memory block's info
-		MemoryBlockInfo memoryInfo {
-			.freeList = {
-				.first = freeBlockIndex,
-				.last = freeBlockIndex
-			},
+		// Set the memory block's info; the first node of a memory that isn't dedicated is added by the caller, while holding its pool's lock
+		MemoryBlockInfo newMemoryInfo {
+			.firstNode = SIZE_T_MAX,
 			.mapped = mapped,
 			.memoryTypeIndex = memoryTypeIndex,
+			.size = size,
+			.usedSize = 0,
+			.pinnedCount = 0,
 			.resourceType = resourceType,
-			.dedicated = dedicatedBuffer || dedicatedImage
+			.dedicated = dedicatedBuffer || dedicatedImage,
+			.draining = false
 		};
 
-		// Add the memory block to the map
-		memoryInfos.insert({ memory, memoryInfo });
+		// Add the memory block to the map, whose elements never move, and to its heap's allocated size
+		HeapInfo& heapInfo = heapInfos[memoryProperties.memoryTypes[typeInfos[memoryTypeIndex].realTypeIndex].heapIndex];
 
-		// Add the memory block to the type's info
-		typeInfos[memoryTypeIndex].memoryBlocks[resourceType].push_back(memory);
+		memoryMutex.Lock();
+		memoryInfo = &memoryInfos.insert({ memory, newMemoryInfo }).first->second;
+		heapInfo.allocatedSize += size;
+		++heapInfo.memoryCount;
+		memoryMutex.Unlock();
 
 		return VK_SUCCESS;
 	}
 	void VulkanAllocator::InternalFreeDeviceMemory(VkDeviceMemory memory) {
-		// Get the memory block's info and remove it from the map
-		MemoryBlockInfo memoryInfo = memoryInfos[memory];
+		// Get the memory block's info and remove it from the map and from its heap's allocated size
+		memoryMutex.Lock();
+		MemoryBlockInfo memoryInfo = memoryInfos.at(memory);
 		memoryInfos.erase(memory);
 
-		// Find and remove the memory block from the type's info
-		vector<VkDeviceMemory>& typeMemoryVector = typeInfos[memoryInfo.memoryTypeIndex].memoryBlocks[memoryInfo.resourceType];
-		for(auto iter = typeMemoryVector.begin(); iter != typeMemoryVector.end(); ++iter) {
-			if(*iter == memory) {
-				typeMemoryVector.erase(iter);
-				break;
-			}
-		}
+		HeapInfo& heapInfo = heapInfos[memoryProperties.memoryTypes[typeInfos[memoryInfo.memoryTypeIndex].realTypeIndex].heapIndex];
+		heapInfo.allocatedSize -= memoryInfo.size;
+		--heapInfo.memoryCount;
+		memoryMutex.Unlock();
 
-		// Add all previous blocks to the free block list
-		for(size_t index = memoryInfo.freeList.first; index != SIZE_T_MAX;) {
+		// Remove all of the memory's nodes from the type's pool and free them
+		BlockPool& pool = typeInfos[memoryInfo.memoryTypeIndex].pools[memoryInfo.resourceType];
+		for(size_t index = memoryInfo.firstNode; index != SIZE_T_MAX;) {
 			// Save the next index
-			size_t nextIndex = freeBlocks[index].next;
-
-			// Add the block to the free block list
-			freeBlocks[index].prev = SIZE_T_MAX;
-			freeBlocks[index].next = freeBlockList.first;
+			size_t nextIndex = InternalGetNode(index).nextPhysical;
 
-			if(freeBlockList.first != SIZE_T_MAX) {
-				freeBlocks[freeBlockList.first].prev = index;
-			} else {
-				freeBlockList.last = index;
-			}
-			freeBlockList.first = index;
+			// Free the node, removing it from the pool unless the memory was being drained
+			if(InternalGetNode(index).free && !memoryInfo.draining)
+				InternalRemoveFreeNode(pool, index);
+			InternalFreeNode(pool, index);
 
-			// Move on to the next block
+			// Move on to the next node
 			index = nextIndex;
 		}
 
@@ -179,113 +401,247 @@ namespace wfe {
 		// Check if the current memory block is too large for the allocator's blocks
 		if(memRequirements.size >= MEMORY_BLOCK_SIZES[typeInfo.memoryType]) {
 			// Allocate a dedicated memory block
-			VkResult result = InternalAllocDeviceMemory(memRequirements.size, 0, memoryTypeIndex, resourceType, buffer, VK_NULL_HANDLE, memoryBlock.memory);
+			MemoryBlockInfo* memoryInfo;
+			VkResult result = InternalAllocDeviceMemory(memRequirements.size, memoryTypeIndex, resourceType, buffer, image, memoryBlock.memory, memoryInfo);
 			if(result != VK_SUCCESS)
 				return result;
 			
 			// Set the memory block's info and exit the function
 			memoryBlock.offset = 0;
 			memoryBlock.size = memRequirements.size;
+			memoryBlock.allocIndex = SIZE_T_MAX;
 
 			return VK_SUCCESS;
 		}
 
-		// Loop through the current type's memory blocks
-		for(auto memory : typeInfo.memoryBlocks[resourceType]) {
-			// Get the corresponding memory block info
-			MemoryBlockInfo& memoryInfo = memoryInfos.at(memory);
+		// Find a free node large enough for the resource and its worst case alignment
+		BlockPool& pool = typeInfo.pools[resourceType];
+		pool.mutex.Lock();
+		size_t index = InternalFindFreeNode(pool, memRequirements.size + memRequirements.alignment - 1);
 
-			// Loop through the current memory block's free blocks
-			for(size_t index = memoryInfo.freeList.first; index != SIZE_T_MAX; index = freeBlocks[index].next) {
-				// Get the required alignment for the requested resource
-				VkDeviceSize alignedOffset = (freeBlocks[index].offset + memRequirements.alignment - 1) & ~(memRequirements.alignment - 1);
-				VkDeviceSize alignment = alignedOffset - freeBlocks[index].offset;
+		// Allocate a new memory block if no suitable node was found, without holding the pool's lock during the allocation
+		if(index == SIZE_T_MAX) {
+			pool.mutex.Unlock();
 
-				// Check if the current free block has enough room for the resource and its alignment
-				if(freeBlocks[index].size < alignment + memRequirements.size)
-					continue;
-				
-				// Set the memory block's info
-				memoryBlock.memory = memory;
-				memoryBlock.offset = alignedOffset;
-				memoryBlock.size = memRequirements.size;
-				
-				// Calculate the remaining size for the free block after the allocated resource
-				VkDeviceSize leftoverFreeSize = freeBlocks[index].size - alignment - memRequirements.size;
-
-				// Rearrange the free block for the current case
-				if(alignment && leftoverFreeSize) {
-					// Allocate a brand new free list block
-					size_t newIndex = InternalAllocFreeListBlock();
-
-					// Insert the free block right after the current free block
-					size_t nextIndex = freeBlocks[index].next;
-
-					freeBlocks[newIndex].prev = index;
-					freeBlocks[newIndex].next = nextIndex;
-
-					freeBlocks[index].next = newIndex;
-					if(nextIndex != SIZE_T_MAX) {
-						freeBlocks[nextIndex].prev = newIndex;
-					} else {
-						memoryInfo.freeList.last = newIndex;
-					}
-
-					// Set the two free blocks' infos
-					freeBlocks[index].size = alignment;
-					freeBlocks[newIndex].offset = alignedOffset + memRequirements.size;
-					freeBlocks[newIndex].size = leftoverFreeSize;
-				} else if(alignment) {
-					// Set the free block's new info
-					freeBlocks[index].size = alignment;
-				} else if(leftoverFreeSize) {
-					// Set the free block's new info
-					freeBlocks[index].offset += memRequirements.size;
-					freeBlocks[index].size = leftoverFreeSize;
-				} else {
-					// Remove the free block from its free list
-					if(freeBlocks[index].prev != SIZE_T_MAX) {
-						freeBlocks[freeBlocks[index].prev].next = freeBlocks[index].next;
-					} else {
-						memoryInfo.freeList.first = freeBlocks[index].next;
-					}
-					if(freeBlocks[index].next != SIZE_T_MAX) {
-						freeBlocks[freeBlocks[index].next].prev = freeBlocks[index].prev;
-					} else {
-						memoryInfo.freeList.last = freeBlocks[index].prev;
-					}
-					
-					// Add the free block to the free block list
-					freeBlocks[index].prev = SIZE_T_MAX;
-					freeBlocks[index].next = freeBlockList.first;
-
-					if(freeBlockList.first != SIZE_T_MAX) {
-						freeBlocks[freeBlockList.first].prev = index;
-					} else {
-						freeBlockList.last = index;
-					}
-					freeBlockList.first = index;
-				}
+			VkDeviceMemory memory;
+			MemoryBlockInfo* memoryInfo;
+			VkDeviceSize blockSize = InternalGetMemoryBlockSize(memoryTypeIndex, memRequirements.size + memRequirements.alignment - 1);
+			VkResult result = InternalAllocDeviceMemory(blockSize, memoryTypeIndex, resourceType, VK_NULL_HANDLE, VK_NULL_HANDLE, memory, memoryInfo);
+			if(result != VK_SUCCESS)
+				return result;
+			
+			// Add a free node spanning the entire memory to the pool, reserving the nodes the resource's split needs as well, and free the memory if the nodes couldn't be allocated
+			pool.mutex.Lock();
+			if(!InternalReserveNodes(pool, 3)) {
+				InternalFreeDeviceMemory(memory);
+				pool.mutex.Unlock();
 
-				// Exit the function
-				return VK_SUCCESS;
+				return VK_ERROR_OUT_OF_HOST_MEMORY;
 			}
+
+			index = InternalAllocNode(pool);
+
+			BlockNode& node = InternalGetNode(index);
+			node.offset = 0;
+			node.size = blockSize;
+			node.memory = memory;
+			node.memoryInfo = memoryInfo;
+			node.prevPhysical = SIZE_T_MAX;
+			node.nextPhysical = SIZE_T_MAX;
+
+			memoryInfo->firstNode = index;
+			InternalInsertFreeNode(pool, index);
 		}
 
-		// No suitable memory was found; allocate a new memory block
-		VkResult result = InternalAllocDeviceMemory(MEMORY_BLOCK_SIZES[typeInfo.memoryType], MEMORY_BLOCK_SIZES[typeInfo.memoryType] - memRequirements.size, memoryTypeIndex, resourceType, VK_NULL_HANDLE, VK_NULL_HANDLE, memoryBlock.memory);
-		if(result != VK_SUCCESS)
+		// Allocate the resource from the node
+		if(!InternalAllocFromNode(pool, index, memRequirements, memoryBlock)) {
+			pool.mutex.Unlock();
+			return VK_ERROR_OUT_OF_HOST_MEMORY;
+		}
+		pool.mutex.Unlock();
+
+		return VK_SUCCESS;
+	}
+	VkResult VulkanAllocator::InternalCreateTransientRing(MemoryType memoryType) {
+		// Save all of the device's queue families to an array
+		VulkanDevice::QueueFamilyIndices indices = device->GetQueueFamilyIndices();
+		uint32_t indicesArr[4], indicesCount = 0;
+
+		// Insert all unique indices into the index array; simple ifs should work here
+		if(indices.graphicsIndex != UINT32_T_MAX)
+			indicesArr[indicesCount++] = indices.graphicsIndex;
+		if(indices.presentIndex != UINT32_T_MAX && indices.presentIndex != indices.graphicsIndex)
+			indicesArr[indicesCount++] = indices.presentIndex;
+		if(indices.transferIndex != UINT32_T_MAX && indices.transferIndex != indices.graphicsIndex && indices.transferIndex != indices.presentIndex)
+			indicesArr[indicesCount++] = indices.transferIndex;
+		if(indices.computeIndex != UINT32_T_MAX && indices.computeIndex != indices.graphicsIndex && indices.computeIndex != indices.presentIndex && indices.computeIndex != indices.transferIndex)
+			indicesArr[indicesCount++] = indices.computeIndex;
+
+		// Set the ring buffer's create info
+		VkBufferCreateInfo createInfo {
+			.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.size = TRANSIENT_RING_SIZES[memoryType],
+			.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+			.sharingMode = indicesCount > 1 ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+			.queueFamilyIndexCount = indicesCount,
+			.pQueueFamilyIndices = indicesArr
+		};
+
+		// Create the ring buffer
+		TransientRing& ring = transientRings[memoryType];
+		VkResult result = device->GetLoader()->vkCreateBuffer(device->GetDevice(), &createInfo, &VulkanRenderer::VULKAN_ALLOC_CALLBACKS, &ring.buffer);
+		if(result != VK_SUCCESS) {
+			ring.buffer = VK_NULL_HANDLE;
 			return result;
-		
-		// Set the memory block's remaining info
-		memoryBlock.offset = 0;
-		memoryBlock.size = memRequirements.size;
+		}
+
+		// Allocate and bind the ring buffer's memory, which stays mapped for the allocator's lifetime
+		result = AllocBufferMemory(ring.buffer, memoryType, ring.memoryBlock);
+		if(result == VK_SUCCESS) {
+			result = BindBufferMemories(1, &ring.buffer, &ring.memoryBlock);
+			if(result != VK_SUCCESS)
+				FreeMemory(ring.memoryBlock);
+		}
+		if(result != VK_SUCCESS) {
+			device->GetLoader()->vkDestroyBuffer(device->GetDevice(), ring.buffer, &VulkanRenderer::VULKAN_ALLOC_CALLBACKS);
+			ring.buffer = VK_NULL_HANDLE;
+			return result;
+		}
+
+		// Set the ring's initial state
+		ring.mapped = (char_t*)GetMappedMemory(ring.memoryBlock);
+		ring.head = 0;
+		ring.usedSize = 0;
+		for(size_t i = 0; i != Renderer::MAX_FRAMES_IN_FLIGHT; ++i)
+			ring.frameSizes[i] = 0;
 
 		return VK_SUCCESS;
 	}
+	VkDeviceSize VulkanAllocator::InternalGetMemoryBlockSize(uint32_t memoryTypeIndex, VkDeviceSize minSize) {
+		// Get the heap's estimated usage and budget
+		HeapInfo& heapInfo = heapInfos[memoryProperties.memoryTypes[typeInfos[memoryTypeIndex].realTypeIndex].heapIndex];
+
+		memoryMutex.Lock();
+		VkDeviceSize usage = InternalGetHeapUsage(heapInfo);
+		VkDeviceSize budget = heapInfo.budget;
+		memoryMutex.Unlock();
+
+		// Halve the type's block size while the new block would exceed the heap's budget, as long as it can still hold the resource
+		VkDeviceSize blockSize = MEMORY_BLOCK_SIZES[typeInfos[memoryTypeIndex].memoryType];
+		for(uint32_t i = 0; i != MAX_MEMORY_BLOCK_SIZE_SHIFT && usage + blockSize > budget && (blockSize >> 1) >= minSize; ++i)
+			blockSize >>= 1;
+		
+		return blockSize;
+	}
+	void VulkanAllocator::InternalQueryMemoryBudget() {
+		// Query the heaps' budgets and usages from the driver, if supported
+		VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties {
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT,
+			.pNext = nullptr
+		};
+		if(memoryBudgetSupported) {
+			VkPhysicalDeviceMemoryProperties2KHR memoryProperties2 {
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2_KHR,
+				.pNext = &budgetProperties
+			};
+
+			if(device->GetDeviceProperties().apiVersion >= VK_API_VERSION_1_1) {
+				device->GetLoader()->vkGetPhysicalDeviceMemoryProperties2(device->GetPhysicalDevice(), &memoryProperties2);
+			} else {
+				device->GetLoader()->vkGetPhysicalDeviceMemoryProperties2KHR(device->GetPhysicalDevice(), &memoryProperties2);
+			}
+		}
+
+		// Save every heap's budget, falling back to a fraction of the heap's size and the allocator's own usage
+		memoryMutex.Lock();
+		for(uint32_t i = 0; i != memoryProperties.memoryHeapCount; ++i) {
+			HeapInfo& heapInfo = heapInfos[i];
+			if(memoryBudgetSupported) {
+				heapInfo.budget = budgetProperties.heapBudget[i];
+				heapInfo.queriedUsage = budgetProperties.heapUsage[i];
+				heapInfo.queriedAllocatedSize = heapInfo.allocatedSize;
+			} else {
+				heapInfo.budget = memoryProperties.memoryHeaps[i].size / 100 * FALLBACK_BUDGET_PERCENTAGE;
+				heapInfo.queriedUsage = 0;
+				heapInfo.queriedAllocatedSize = 0;
+			}
+		}
+		memoryMutex.Unlock();
+	}
+	VkDeviceMemory VulkanAllocator::InternalFindSparseMemory(MemoryBlockInfo*& sparseInfo) {
+		// Find the least used GPU memory block with no pinned resources, skipping empty blocks which are freed by Trim
+		VkDeviceMemory sparseMemory = VK_NULL_HANDLE;
+		VkDeviceSize sparseUsedSize = UINT64_T_MAX;
+
+		for(auto& memory : memoryInfos) {
+			MemoryBlockInfo& memoryInfo = memory.second;
+			if(memoryInfo.dedicated || memoryInfo.pinnedCount || !memoryInfo.usedSize || memoryInfo.usedSize > memoryInfo.size / DEFRAGMENT_USAGE_DIVISOR || typeInfos[memoryInfo.memoryTypeIndex].memoryType != MEMORY_TYPE_GPU)
+				continue;
+			
+			if(memoryInfo.usedSize < sparseUsedSize) {
+				sparseMemory = memory.first;
+				sparseInfo = &memoryInfo;
+				sparseUsedSize = memoryInfo.usedSize;
+			}
+		}
+
+		return sparseMemory;
+	}
+	void VulkanAllocator::InternalStartDrain(VkDeviceMemory memory, MemoryBlockInfo* memoryInfo) {
+		// Mark the memory as drained
+		BlockPool& pool = typeInfos[memoryInfo->memoryTypeIndex].pools[memoryInfo->resourceType];
+		memoryInfo->draining = true;
+		drainMemory = memory;
+		drainInfo = memoryInfo;
+
+		// Remove the memory's free nodes from the pool, so that no new resources are allocated in it
+		for(size_t index = memoryInfo->firstNode; index != SIZE_T_MAX; index = InternalGetNode(index).nextPhysical) {
+			if(InternalGetNode(index).free) {
+				InternalRemoveFreeNode(pool, index);
+				InternalGetNode(index).free = true;
+			}
+		}
+	}
+	void VulkanAllocator::InternalStopDrain() {
+		// Add the drained memory's free nodes back to the pool
+		BlockPool& pool = typeInfos[drainInfo->memoryTypeIndex].pools[drainInfo->resourceType];
+
+		for(size_t index = drainInfo->firstNode; index != SIZE_T_MAX; index = InternalGetNode(index).nextPhysical)
+			if(InternalGetNode(index).free)
+				InternalInsertFreeNode(pool, index);
+
+		drainInfo->draining = false;
+		drainMemory = VK_NULL_HANDLE;
+		drainInfo = nullptr;
+	}
+	void VulkanAllocator::InternalSetRelocationCallback(BlockNode& node, RelocationCallback callback, void* userData) {
+		// Update the memory's pinned resource count and set the node's callback
+		if(!node.relocationCallback && callback) {
+			--node.memoryInfo->pinnedCount;
+		} else if(node.relocationCallback && !callback) {
+			++node.memoryInfo->pinnedCount;
+		}
+
+		node.relocationCallback = callback;
+		node.relocationUserData = userData;
+	}
+	void VulkanAllocator::InternalLockPools() {
+		// Lock every pool, always in the same order
+		for(uint32_t i = 0; i != typeCount; ++i)
+			for(uint32_t j = 0; j != (uint32_t)RESOURCE_TYPE_COUNT; ++j)
+				typeInfos[i].pools[j].mutex.Lock();
+	}
+	void VulkanAllocator::InternalUnlockPools() {
+		// Unlock every pool
+		for(uint32_t i = 0; i != typeCount; ++i)
+			for(uint32_t j = 0; j != (uint32_t)RESOURCE_TYPE_COUNT; ++j)
+				typeInfos[i].pools[j].mutex.Unlock();
+	}
 
 	// Public functions
-	VulkanAllocator::VulkanAllocator(VulkanDevice* device) : device(device), freeBlocks(FREE_BLOCK_START_COUNT) {
+	VulkanAllocator::VulkanAllocator(VulkanDevice* device) : device(device), typeInfos(nullptr), typeCount(0), heapInfos{}, nodePageCount(0), transientRings{}, transientFrame(0), drainMemory(VK_NULL_HANDLE), drainInfo(nullptr) {
 		// Get the device's memory properties 
 		device->GetLoader()->vkGetPhysicalDeviceMemoryProperties(device->GetPhysicalDevice(), &memoryProperties);
 
@@ -293,7 +649,13 @@ namespace wfe {
 		dedicatedAllocSupported = device->GetDeviceProperties().apiVersion >= VK_API_VERSION_1_1 || (device->GetEnabledExtensions().count(VK_KHR_GET_MEMORY_REQUIREMENTS_2_EXTENSION_NAME) && device->GetEnabledExtensions().count(VK_KHR_DEDICATED_ALLOCATION_EXTENSION_NAME));
 		bind2Supported = device->GetDeviceProperties().apiVersion >= VK_API_VERSION_1_1 || device->GetEnabledExtensions().count(VK_KHR_BIND_MEMORY_2_EXTENSION_NAME);
 
+		// Check for memory budget support and get the heaps' initial budgets
+		memoryBudgetSupported = device->GetEnabledExtensions().count(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+		InternalQueryMemoryBudget();
+
 		// Assign a memory type to every device memory type
+		MemoryType memoryTypes[VK_MAX_MEMORY_TYPES];
+		uint32_t realTypeIndices[VK_MAX_MEMORY_TYPES];
 		for(uint32_t i = 0; i != memoryProperties.memoryTypeCount; ++i) {
 			// Loop through the memory types and set the first type which has all flags satisfied
 			MemoryType memoryType = MEMORY_TYPE_COUNT;
@@ -308,31 +670,36 @@ namespace wfe {
 			if(memoryType == MEMORY_TYPE_COUNT)
 				continue;
 			
-			// Add the new memory type to the vector
-			TypeInfo typeInfo {
-				.memoryType = memoryType,
-				.realTypeIndex = i
-			};
-			typeInfos.push_back(typeInfo);
+			// Save the new memory type
+			memoryTypes[typeCount] = memoryType;
+			realTypeIndices[typeCount] = i;
+			++typeCount;
 		}
 
-		// Initialize the free block free list
-		freeBlockList.first = 0;
-		freeBlockList.last = freeBlocks.size() - 1;
-
-		freeBlocks[0].prev = SIZE_T_MAX;
-		for(size_t i = 0; i != freeBlocks.size() - 1; ++i) {
-			freeBlocks[i].next = i + 1;
-			freeBlocks[i + 1].prev = i;
+		// Create the type infos, with every pool empty and unlocked; the type infos are never moved, since every pool holds its own lock
+		if(!typeCount)
+			return;
+		
+		typeInfos = NewArray<TypeInfo>(typeCount);
+		for(uint32_t i = 0; i != typeCount; ++i) {
+			typeInfos[i].memoryType = memoryTypes[i];
+			typeInfos[i].realTypeIndex = realTypeIndices[i];
+
+			for(uint32_t j = 0; j != (uint32_t)RESOURCE_TYPE_COUNT; ++j) {
+				BlockPool& pool = typeInfos[i].pools[j];
+				pool.firstLevelBitmap = 0;
+				for(uint32_t k = 0; k != FIRST_LEVEL_COUNT; ++k)
+					pool.secondLevelBitmaps[k] = 0;
+				pool.unusedNodes = SIZE_T_MAX;
+			}
 		}
-		freeBlocks[freeBlocks.size() - 1].next = SIZE_T_MAX;
 	}
 
 	uint32_t VulkanAllocator::GetMemoryTypeIndex(MemoryType memoryType, uint32_t memoryTypeBits) const {
 		// Consider all memory types with all required functionality
 		for(; memoryType != MEMORY_TYPE_COUNT; memoryType = (MemoryType)((uint32_t)memoryType + 1)) {
 			// Loop through all memory types
-			for(uint32_t i = 0; i != (uint32_t)typeInfos.size(); ++i) {
+			for(uint32_t i = 0; i != typeCount; ++i) {
 				// Check if the current memory type's real index is in the given mask
 				if(!((1 << typeInfos[i].realTypeIndex) & memoryTypeBits))
 					continue;
@@ -394,13 +761,15 @@ namespace wfe {
 				};
 
 				// Allocate the buffer's memory
-				VkResult result = InternalAllocDeviceMemory(memoryRequirements.memoryRequirements.size, 0, memoryTypeIndex, RESOURCE_TYPE_BUFFER, buffer, VK_NULL_HANDLE, memoryBlock.memory);
+				MemoryBlockInfo* memoryInfo;
+				VkResult result = InternalAllocDeviceMemory(memoryRequirements.memoryRequirements.size, memoryTypeIndex, RESOURCE_TYPE_BUFFER, buffer, VK_NULL_HANDLE, memoryBlock.memory, memoryInfo);
 				if(result != VK_SUCCESS)
 					return result;
 				
 				// Set the memory block's remaining info and exit the function
 				memoryBlock.offset = 0;
 				memoryBlock.size = memoryRequirements.memoryRequirements.size;
+				memoryBlock.allocIndex = SIZE_T_MAX;
 
 				return VK_SUCCESS;
 			} else {
@@ -468,13 +837,15 @@ namespace wfe {
 				};
 
 				// Allocate the image's memory
-				VkResult result = InternalAllocDeviceMemory(memoryRequirements.memoryRequirements.size, 0, memoryTypeIndex, RESOURCE_TYPE_BUFFER, VK_NULL_HANDLE, image, memoryBlock.memory);
+				MemoryBlockInfo* memoryInfo;
+				VkResult result = InternalAllocDeviceMemory(memoryRequirements.memoryRequirements.size, memoryTypeIndex, RESOURCE_TYPE_BUFFER, VK_NULL_HANDLE, image, memoryBlock.memory, memoryInfo);
 				if(result != VK_SUCCESS)
 					return result;
 				
 				// Set the memory block's remaining info and exit the function
 				memoryBlock.offset = 0;
 				memoryBlock.size = memoryRequirements.memoryRequirements.size;
+				memoryBlock.allocIndex = SIZE_T_MAX;
 
 				return VK_SUCCESS;
 			} else {
@@ -495,80 +866,20 @@ namespace wfe {
 		return InternalAllocMemory(memRequirements, memoryTypeIndex, VK_NULL_HANDLE, image, memoryBlock);
 	}
 	void VulkanAllocator::FreeMemory(const MemoryBlock& memoryBlock) {
-		// Get the memory block's info
-		MemoryBlockInfo& memoryInfo = memoryInfos[memoryBlock.memory];
-
 		// Check if the memory block is a dedicated allocation
-		if(memoryInfo.dedicated) {
+		if(memoryBlock.allocIndex == SIZE_T_MAX) {
 			// Simply free the memory block and exit the function
 			InternalFreeDeviceMemory(memoryBlock.memory);
 			return;
 		}
 
-		// Find the free blocks before and after the given memory block
-		size_t prevIndex = SIZE_T_MAX;
-		size_t nextIndex = memoryInfo.freeList.first;
-		for(; nextIndex != SIZE_T_MAX && freeBlocks[nextIndex].offset < memoryBlock.offset; nextIndex = freeBlocks[nextIndex].next) {
-			// Set the new previous index
-			prevIndex = nextIndex;
-		}
-
-		// Check if any of those blocks are adjacent to the freed block
-		bool8_t prevAdjacent = prevIndex != SIZE_T_MAX && freeBlocks[prevIndex].offset + freeBlocks[prevIndex].size == memoryBlock.offset;
-		bool8_t nextAdjacent = nextIndex != SIZE_T_MAX && memoryBlock.offset + memoryBlock.size == freeBlocks[nextIndex].offset;
-
-		if(prevAdjacent && nextAdjacent) {
-			// Set the new free block's info
-			freeBlocks[prevIndex].size += memoryBlock.size + freeBlocks[nextIndex].size;
-
-			// Remove the next free block from the free list
-			freeBlocks[prevIndex].next = freeBlocks[nextIndex].next;
-			if(freeBlocks[nextIndex].next != SIZE_T_MAX) {
-				freeBlocks[freeBlocks[nextIndex].next].prev = prevIndex;
-			} else {
-				memoryInfo.freeList.last = prevIndex;
-			}
-
-			// Add the free block to the free block list
-			freeBlocks[nextIndex].prev = SIZE_T_MAX;
-			freeBlocks[nextIndex].next = freeBlockList.first;
-
-			if(freeBlockList.first != SIZE_T_MAX) {
-				freeBlocks[freeBlockList.first].prev = nextIndex;
-			} else {
-				freeBlockList.last = nextIndex;
-			}
-			freeBlockList.first = nextIndex;
-		} else if(prevAdjacent) {
-			// Set the new free block's info
-			freeBlocks[prevIndex].size += memoryBlock.size;
-		} else if(nextAdjacent) {
-			// Set the new free block's info
-			freeBlocks[nextIndex].offset = memoryBlock.offset;
-			freeBlocks[nextIndex].size += memoryBlock.size;
-		} else {
-			// Aloocate a new free block
-			size_t newIndex = InternalAllocFreeListBlock();
-
-			// Set the new free block's info
-			freeBlocks[newIndex].offset = memoryBlock.offset;
-			freeBlocks[newIndex].size = memoryBlock.size;
+		// Free the memory block's node, merging it with its free neighbours, while holding its pool's lock
+		const MemoryBlockInfo* memoryInfo = InternalGetNode(memoryBlock.allocIndex).memoryInfo;
+		BlockPool& pool = typeInfos[memoryInfo->memoryTypeIndex].pools[memoryInfo->resourceType];
 
-			// Insert the new free block in the free list
-			freeBlocks[newIndex].prev = prevIndex;
-			freeBlocks[newIndex].next = nextIndex;
-
-			if(prevIndex != SIZE_T_MAX) {
-				freeBlocks[prevIndex].next = newIndex;
-			} else {
-				memoryInfo.freeList.first = newIndex;
-			}
-			if(nextIndex != SIZE_T_MAX) {
-				freeBlocks[nextIndex].prev = newIndex;
-			} else {
-				memoryInfo.freeList.last = newIndex;
-			}
-		}
+		pool.mutex.Lock();
+		InternalReleaseNode(memoryBlock.allocIndex);
+		pool.mutex.Unlock();
 	}
 
 	VkResult VulkanAllocator::BindBufferMemories(size_t bufferCount, VkBuffer* buffers, const MemoryBlock* memoryBlocks) const {
@@ -647,8 +958,15 @@ namespace wfe {
 	}
 
 	void* VulkanAllocator::GetMappedMemory(const MemoryBlock& memoryBlock) {
-		// Get the parent device memory's mapped memory
-		void* mapped = memoryInfos[memoryBlock.memory].mapped;
+		// Get the parent device memory's mapped memory, which never changes, from the block's node, or from the map if the memory is dedicated
+		void* mapped;
+		if(memoryBlock.allocIndex != SIZE_T_MAX) {
+			mapped = InternalGetNode(memoryBlock.allocIndex).memoryInfo->mapped;
+		} else {
+			memoryMutex.Lock();
+			mapped = memoryInfos.at(memoryBlock.memory).mapped;
+			memoryMutex.Unlock();
+		}
 
 		// Exit the function if the parent device memory isn't mapped
 		if(!mapped)
@@ -658,28 +976,327 @@ namespace wfe {
 		return (char_t*)mapped + memoryBlock.offset;
 	}
 
+	VkResult VulkanAllocator::AllocTransientMemory(MemoryType memoryType, VkDeviceSize size, VkDeviceSize alignment, TransientBlock& transientBlock) {
+		// Exit the function if the memory type can't be persistently mapped
+		if(memoryType != MEMORY_TYPE_GPU_CPU_VISIBLE && memoryType != MEMORY_TYPE_CPU_GPU_VISIBLE)
+			return VK_ERROR_FEATURE_NOT_PRESENT;
+
+		// Create the memory type's ring on first use
+		transientMutex.Lock();
+		TransientRing& ring = transientRings[memoryType];
+		if(!ring.buffer) {
+			VkResult result = InternalCreateTransientRing(memoryType);
+			if(result != VK_SUCCESS) {
+				transientMutex.Unlock();
+				return result;
+			}
+		}
+
+		// Align the ring's head, wrapping around to the ring's start if the block doesn't fit before its end
+		VkDeviceSize ringSize = TRANSIENT_RING_SIZES[memoryType];
+		VkDeviceSize offset = (ring.head + alignment - 1) & ~(alignment - 1);
+		VkDeviceSize consumedSize;
+		if(offset > ringSize || size > ringSize - offset) {
+			offset = 0;
+			consumedSize = ringSize - ring.head + size;
+		} else {
+			consumedSize = offset - ring.head + size;
+		}
+
+		// Exit the function if the block would overwrite memory still used by a frame in flight
+		if(consumedSize > ringSize - ring.usedSize) {
+			transientMutex.Unlock();
+			return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+		}
+
+		// Bump the ring's head and add the consumed size to the current frame
+		ring.head = offset + size;
+		ring.usedSize += consumedSize;
+		ring.frameSizes[transientFrame] += consumedSize;
+
+		// Set the transient block's info
+		transientBlock.buffer = ring.buffer;
+		transientBlock.offset = offset;
+		transientBlock.size = size;
+		transientBlock.mapped = ring.mapped + offset;
+		transientMutex.Unlock();
+
+		return VK_SUCCESS;
+	}
+	void VulkanAllocator::ResetTransientMemory(size_t frameIndex) {
+		// Free the memory the frame allocated from every ring, which is always the oldest memory in the ring
+		transientMutex.Lock();
+		for(size_t i = 0; i != (size_t)MEMORY_TYPE_COUNT; ++i) {
+			TransientRing& ring = transientRings[i];
+			ring.usedSize -= ring.frameSizes[frameIndex];
+			ring.frameSizes[frameIndex] = 0;
+
+			// Move the head back to the ring's start if the ring is empty
+			if(!ring.usedSize)
+				ring.head = 0;
+		}
+
+		// Set the current frame
+		transientFrame = frameIndex;
+		transientMutex.Unlock();
+	}
+
+	void VulkanAllocator::SetRelocationCallback(const MemoryBlock& memoryBlock, RelocationCallback callback, void* userData) {
+		// Exit the function if the memory block has its own device memory, which is never defragmented
+		if(memoryBlock.allocIndex == SIZE_T_MAX)
+			return;
+		
+		// Set the node's callback while holding its pool's lock
+		BlockNode& node = InternalGetNode(memoryBlock.allocIndex);
+		BlockPool& pool = typeInfos[node.memoryInfo->memoryTypeIndex].pools[node.memoryInfo->resourceType];
+
+		pool.mutex.Lock();
+		InternalSetRelocationCallback(node, callback, userData);
+		pool.mutex.Unlock();
+	}
+	VkDeviceSize VulkanAllocator::Defragment(VkCommandBuffer commandBuffer, VkDeviceSize maxMoveSize) {
+		// Exit the function if the last step wasn't finished yet
+		if(!pendingMoves.empty())
+			return 0;
+		
+		// Start draining the sparsest memory block if no memory is being drained, holding every lock while comparing the memory blocks
+		if(!drainMemory) {
+			InternalLockPools();
+			memoryMutex.Lock();
+
+			MemoryBlockInfo* memoryInfo;
+			VkDeviceMemory memory = InternalFindSparseMemory(memoryInfo);
+
+			memoryMutex.Unlock();
+			if(memory)
+				InternalStartDrain(memory, memoryInfo);
+			InternalUnlockPools();
+
+			if(!memory)
+				return 0;
+		}
+
+		// Lock the drained memory's pool for the rest of the step
+		BlockPool& pool = typeInfos[drainInfo->memoryTypeIndex].pools[drainInfo->resourceType];
+		pool.mutex.Lock();
+
+		// Free the drained memory if all of its resources were freed since the last step
+		if(!drainInfo->usedSize) {
+			VkDeviceMemory memory = drainMemory;
+			drainMemory = VK_NULL_HANDLE;
+			drainInfo = nullptr;
+			InternalFreeDeviceMemory(memory);
+
+			pool.mutex.Unlock();
+			return 0;
+		}
+
+		// Stop draining the memory if one of its resources was pinned since the last step
+		if(drainInfo->pinnedCount) {
+			InternalStopDrain();
+			pool.mutex.Unlock();
+			return 0;
+		}
+
+		// Set the memory barrier info, making all previous writes visible to the copies
+		VkMemoryBarrier memoryBarrier {
+			.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+			.pNext = nullptr,
+			.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT,
+			.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT
+		};
+		device->GetLoader()->vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+		// Move the memory's resources, in order, until the step's budget is used up
+		VkDeviceSize movedSize = 0;
+		for(size_t index = drainInfo->firstNode; index != SIZE_T_MAX; index = InternalGetNode(index).nextPhysical) {
+			// Skip free nodes and stop once the next resource would exceed the budget
+			if(InternalGetNode(index).free)
+				continue;
+			if(movedSize && movedSize + InternalGetNode(index).size > maxMoveSize)
+				break;
+			
+			// Find a free node in another memory block, stopping the drain if the resource doesn't fit anywhere
+			size_t freeIndex = InternalFindFreeNode(pool, InternalGetNode(index).size + InternalGetNode(index).alignment - 1);
+			if(freeIndex == SIZE_T_MAX) {
+				if(!movedSize)
+					InternalStopDrain();
+				break;
+			}
+
+			// Allocate the resource's new memory block
+			VkMemoryRequirements memRequirements {
+				.size = InternalGetNode(index).size,
+				.alignment = InternalGetNode(index).alignment,
+				.memoryTypeBits = 0
+			};
+
+			MemoryBlock newMemoryBlock;
+			if(!InternalAllocFromNode(pool, freeIndex, memRequirements, newMemoryBlock)) {
+				if(!movedSize)
+					InternalStopDrain();
+				break;
+			}
+
+			// Let the resource's owner move it, stopping the drain if it can't
+			RetiredResource retiredResource { VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE };
+			if(!InternalGetNode(index).relocationCallback(InternalGetNode(index).relocationUserData, commandBuffer, newMemoryBlock, retiredResource)) {
+				InternalReleaseNode(newMemoryBlock.allocIndex);
+				InternalStopDrain();
+				break;
+			}
+
+			// Move the callback to the new memory block; the old one is freed once the step is finished
+			InternalSetRelocationCallback(InternalGetNode(newMemoryBlock.allocIndex), InternalGetNode(index).relocationCallback, InternalGetNode(index).relocationUserData);
+			pendingMoves.push_back({ index, retiredResource });
+			movedSize += InternalGetNode(index).size;
+		}
+
+		// Make the copies visible to all later work
+		if(movedSize) {
+			memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			memoryBarrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+			device->GetLoader()->vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+		}
+		pool.mutex.Unlock();
+
+		return movedSize;
+	}
+	void VulkanAllocator::FinishDefragment() {
+		// Get the pool every old memory block is in, which is the drained memory's pool, and lock it
+		const MemoryBlockInfo* memoryInfo;
+		if(!pendingMoves.empty()) {
+			memoryInfo = InternalGetNode(pendingMoves[0].oldIndex).memoryInfo;
+		} else if(drainInfo) {
+			memoryInfo = drainInfo;
+		} else {
+			return;
+		}
+
+		BlockPool& pool = typeInfos[memoryInfo->memoryTypeIndex].pools[memoryInfo->resourceType];
+		pool.mutex.Lock();
+
+		// Destroy every moved resource's old handles and free its old memory block
+		for(const auto& move : pendingMoves) {
+			if(move.retiredResource.imageView)
+				device->GetLoader()->vkDestroyImageView(device->GetDevice(), move.retiredResource.imageView, &VulkanRenderer::VULKAN_ALLOC_CALLBACKS);
+			if(move.retiredResource.image)
+				device->GetLoader()->vkDestroyImage(device->GetDevice(), move.retiredResource.image, &VulkanRenderer::VULKAN_ALLOC_CALLBACKS);
+			if(move.retiredResource.buffer)
+				device->GetLoader()->vkDestroyBuffer(device->GetDevice(), move.retiredResource.buffer, &VulkanRenderer::VULKAN_ALLOC_CALLBACKS);
+			
+			InternalReleaseNode(move.oldIndex);
+		}
+		pendingMoves.clear();
+
+		// Free the drained memory once all of its resources were moved
+		if(drainMemory && !drainInfo->usedSize) {
+			VkDeviceMemory memory = drainMemory;
+			drainMemory = VK_NULL_HANDLE;
+			drainInfo = nullptr;
+			InternalFreeDeviceMemory(memory);
+		}
+
+		pool.mutex.Unlock();
+	}
+
+	void VulkanAllocator::UpdateMemoryBudget() {
+		// Query the heaps' new budgets
+		InternalQueryMemoryBudget();
+
+		// Update every heap's pressure level, saving the changed levels' event infos
+		MemoryPressureEventInfo eventInfos[VK_MAX_MEMORY_HEAPS];
+		uint32_t eventCount = 0;
+
+		memoryMutex.Lock();
+		for(uint32_t i = 0; i != memoryProperties.memoryHeapCount; ++i) {
+			HeapInfo& heapInfo = heapInfos[i];
+			VkDeviceSize usage = InternalGetHeapUsage(heapInfo);
+			MemoryPressure pressure = InternalGetMemoryPressure(usage, heapInfo.budget, heapInfo.pressure);
+			if(pressure == heapInfo.pressure)
+				continue;
+			
+			eventInfos[eventCount++] = {
+				.heapIndex = i,
+				.oldPressure = heapInfo.pressure,
+				.newPressure = pressure,
+				.budget = heapInfo.budget,
+				.usage = usage
+			};
+			heapInfo.pressure = pressure;
+		}
+		memoryMutex.Unlock();
+
+		// Call the memory pressure event for every changed heap, without holding any lock, so that the listeners can free memory
+		for(uint32_t i = 0; i != eventCount; ++i)
+			memoryPressureEvent.CallEvent(eventInfos + i);
+	}
+	VulkanAllocator::HeapStats VulkanAllocator::GetHeapStats(uint32_t heapIndex) {
+		// Get the heap's stats
+		memoryMutex.Lock();
+		const HeapInfo& heapInfo = heapInfos[heapIndex];
+		HeapStats heapStats {
+			.budget = heapInfo.budget,
+			.usage = InternalGetHeapUsage(heapInfo),
+			.allocatedSize = heapInfo.allocatedSize,
+			.memoryCount = heapInfo.memoryCount,
+			.pressure = heapInfo.pressure
+		};
+		memoryMutex.Unlock();
+
+		return heapStats;
+	}
+
 	void VulkanAllocator::Trim() {
-		// Loop through all memory blocks and find the empty ones
-		vector<VkDeviceMemory> emptyMemories;
+		// Loop through all memory blocks and find the empty ones, holding every lock
+		InternalLockPools();
+		memoryMutex.Lock();
 
-		for(auto memory : memoryInfos) {
-			// Check if the current memory block is empty (has a free block that spans the entire memory block)
-			if(memory.second.freeList.first != SIZE_T_MAX && freeBlocks[memory.second.freeList.first].size == MEMORY_BLOCK_SIZES[typeInfos[memory.second.memoryTypeIndex].memoryType]) {
+		vector<VkDeviceMemory> emptyMemories;
+		for(const auto& memory : memoryInfos) {
+			// Check if the current memory block is empty (has a free node that spans the entire memory block)
+			size_t firstNode = memory.second.firstNode;
+			if(memory.first != drainMemory && firstNode != SIZE_T_MAX && InternalGetNode(firstNode).free && InternalGetNode(firstNode).size == memory.second.size) {
 				// Add the current memory block to the empty block vector
 				emptyMemories.push_back(memory.first);
 			}
 		}
 
+		memoryMutex.Unlock();
+
 		// Free the empty memory blocks
 		for(VkDeviceMemory memory : emptyMemories)
 			InternalFreeDeviceMemory(memory);
+		
+		InternalUnlockPools();
 	}
 
 	VulkanAllocator::~VulkanAllocator() {
+		// Destroy the old handles of every resource moved in an unfinished defragmentation step
+		for(const auto& move : pendingMoves) {
+			if(move.retiredResource.imageView)
+				device->GetLoader()->vkDestroyImageView(device->GetDevice(), move.retiredResource.imageView, &VulkanRenderer::VULKAN_ALLOC_CALLBACKS);
+			if(move.retiredResource.image)
+				device->GetLoader()->vkDestroyImage(device->GetDevice(), move.retiredResource.image, &VulkanRenderer::VULKAN_ALLOC_CALLBACKS);
+			if(move.retiredResource.buffer)
+				device->GetLoader()->vkDestroyBuffer(device->GetDevice(), move.retiredResource.buffer, &VulkanRenderer::VULKAN_ALLOC_CALLBACKS);
+		}
+
+		// Destroy every transient ring's buffer
+		for(size_t i = 0; i != (size_t)MEMORY_TYPE_COUNT; ++i)
+			if(transientRings[i].buffer)
+				device->GetLoader()->vkDestroyBuffer(device->GetDevice(), transientRings[i].buffer, &VulkanRenderer::VULKAN_ALLOC_CALLBACKS);
+
 		// Free every single memory block
 		for(auto memory : memoryInfos) {
 			// Free the current memory block
 			device->GetLoader()->vkFreeMemory(device->GetDevice(), memory.first, &VulkanRenderer::VULKAN_ALLOC_CALLBACKS);
 		}
+
+		// Free every node page and the type infos
+		for(size_t i = 0; i != nodePageCount; ++i)
+			wfe::FreeMemory(nodePages[i]);
+		if(typeInfos)
+			DestroyArray(typeInfos, typeCount);
 	}
 }
\ No newline at end of file
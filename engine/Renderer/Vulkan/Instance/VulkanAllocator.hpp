@@ -1,13 +1,14 @@
 #pragma once
 
 #include "VulkanDevice.hpp"
+#include "Renderer/Renderer.hpp"
 
 #include <Core.hpp>
 #include <vulkan/vk_platform.h>
 #include <vulkan/vulkan_core.h>
 
 namespace wfe {
-	/// @brief An implementation of an efficient Vulkan device memory allocator.
+	/// @brief An implementation of an efficient Vulkan device memory allocator, which sub-allocates device memory blocks using a two-level segregated fit allocator with constant time allocations and frees. Memory can be allocated and freed from multiple threads, with every memory type's buffer and image pools having their own lock. Every memory heap's budget and usage are tracked, with pressure events letting resource owners shed memory before the budget is exceeded.
 	class VulkanAllocator {
 	public:
 		/// @brief An enum containing all supported memory types.
@@ -23,6 +24,19 @@ namespace wfe {
 			/// @brief The number of memory types.
 			MEMORY_TYPE_COUNT
 		};
+		/// @brief An enum containing all memory pressure levels of a memory heap.
+		enum MemoryPressure {
+			/// @brief The heap's usage is below 75% of its budget.
+			MEMORY_PRESSURE_NONE,
+			/// @brief The heap's usage reached 75% of its budget. Optional resources should stop growing.
+			MEMORY_PRESSURE_MODERATE,
+			/// @brief The heap's usage reached 90% of its budget. Streamed and cached resources should be evicted.
+			MEMORY_PRESSURE_HIGH,
+			/// @brief The heap's usage reached its budget. New allocations may fail or be paged out by the driver.
+			MEMORY_PRESSURE_CRITICAL,
+			/// @brief The number of memory pressure levels.
+			MEMORY_PRESSURE_COUNT
+		};
 		/// @brief A scruct containing the current memory block's necessary info.
 		struct MemoryBlock {
 			/// @brief The offset from the start of the device memory the current block starts at.
@@ -31,7 +45,62 @@ namespace wfe {
 			VkDeviceSize size;
 			/// @brief The device memory the current memory block is in.
 			VkDeviceMemory memory;
+			/// @brief The index of the memory block's node in the allocator, used to free it in constant time, or SIZE_T_MAX if the block has its own device memory.
+			size_t allocIndex;
+		};
+		/// @brief A struct containing the info of a transient memory block, which is only valid until its frame in flight is reset.
+		struct TransientBlock {
+			/// @brief The transient ring's Vulkan buffer the memory block is in.
+			VkBuffer buffer;
+			/// @brief The offset from the start of the Vulkan buffer the memory block starts at.
+			VkDeviceSize offset;
+			/// @brief The size of the memory block.
+			VkDeviceSize size;
+			/// @brief The memory block's persistently mapped memory.
+			void* mapped;
+		};
+		/// @brief A struct containing the old handles of a relocated resource, which are destroyed by the allocator once the GPU finished copying from them.
+		struct RetiredResource {
+			/// @brief The resource's old Vulkan buffer, or VK_NULL_HANDLE if the resource isn't a buffer.
+			VkBuffer buffer;
+			/// @brief The resource's old Vulkan image, or VK_NULL_HANDLE if the resource isn't an image.
+			VkImage image;
+			/// @brief The resource's old Vulkan image view, or VK_NULL_HANDLE if the resource has no view.
+			VkImageView imageView;
 		};
+		/// @brief A struct containing a memory heap's budget and usage.
+		struct HeapStats {
+			/// @brief The heap's budget, which the process can use without degrading performance.
+			VkDeviceSize budget;
+			/// @brief The heap's estimated usage by the whole process.
+			VkDeviceSize usage;
+			/// @brief The total size of the device memory allocated by the allocator in the heap.
+			VkDeviceSize allocatedSize;
+			/// @brief The number of device memories allocated by the allocator in the heap.
+			size_t memoryCount;
+			/// @brief The heap's current memory pressure level.
+			MemoryPressure pressure;
+		};
+		/// @brief A struct containing the info packed with memory pressure events.
+		struct MemoryPressureEventInfo {
+			/// @brief The index of the memory heap whose pressure changed.
+			uint32_t heapIndex;
+			/// @brief The heap's old memory pressure level.
+			MemoryPressure oldPressure;
+			/// @brief The heap's new memory pressure level.
+			MemoryPressure newPressure;
+			/// @brief The heap's budget.
+			VkDeviceSize budget;
+			/// @brief The heap's estimated usage.
+			VkDeviceSize usage;
+		};
+		/// @brief A callback called by the defragmenter to move a resource to a new memory block. The owner must create a new resource bound to the new memory block, record a copy of its data from the old resource into the given command buffer, use the new resource from then on and write its old handles to the retired resource. The callback is called while the resource's pool is locked, so it must not allocate or free memory from the allocator.
+		/// @param userData The user data the callback was set with.
+		/// @param commandBuffer The command buffer to record the copy into.
+		/// @param newMemoryBlock The memory block to move the resource to.
+		/// @param retiredResource A reference to the struct in which the resource's old handles must be written.
+		/// @return True if the resource was moved, otherwise false.
+		typedef bool8_t(*RelocationCallback)(void* userData, VkCommandBuffer commandBuffer, const MemoryBlock& newMemoryBlock, RetiredResource& retiredResource);
 
 		/// @brief Creates a Vulkan allocator.
 		/// @param device The Vulkan device to create the allocator for.
@@ -73,6 +142,11 @@ namespace wfe {
 		bool8_t IsBind2Supported() const {
 			return bind2Supported;
 		}
+		/// @brief Checks if the heaps' budgets are queried from the driver using VK_EXT_memory_budget.
+		/// @return True if memory budgets are supported, otherwise false, in which case the budgets are estimated from the heaps' sizes.
+		bool8_t IsMemoryBudgetSupported() const {
+			return memoryBudgetSupported;
+		}
 
 		/// @brief Gets the best memory type index in the given bitmask.
 		/// @param memoryType The memory type whose index to get.
@@ -114,6 +188,42 @@ namespace wfe {
 		/// @return A void pointer to the block's mapped memory, or nullptr if the given memory block isn't mapped.
 		void* GetMappedMemory(const MemoryBlock& memoryBlock);
 
+		/// @brief Allocates a transient memory block from the given memory type's ring, which is freed when the current frame in flight is reset. Allocations only bump the ring's offset and need no freeing.
+		/// @param memoryType The memory type required for the block. Must be MEMORY_TYPE_GPU_CPU_VISIBLE or MEMORY_TYPE_CPU_GPU_VISIBLE.
+		/// @param size The size of the block.
+		/// @param alignment The required alignment of the block's offset. Must be a power of two.
+		/// @param transientBlock A reference to the variable in which the transient block's info will be written.
+		/// @return VK_SUCCESS if the operation was completed successfully, VK_ERROR_OUT_OF_DEVICE_MEMORY if the ring is full, otherwise a corresponding error code.
+		VkResult AllocTransientMemory(MemoryType memoryType, VkDeviceSize size, VkDeviceSize alignment, TransientBlock& transientBlock);
+		/// @brief Starts the given frame in flight, freeing all transient memory allocated the last time the frame was used. Must only be called once the GPU finished all of the frame's work.
+		/// @param frameIndex The index of the frame in flight, which must be lower than Renderer::MAX_FRAMES_IN_FLIGHT.
+		void ResetTransientMemory(size_t frameIndex);
+
+		/// @brief Sets the callback the defragmenter uses to move the given memory block's resource. Memory blocks without a callback are never moved and keep their device memory from being defragmented.
+		/// @param memoryBlock The memory block whose callback to set.
+		/// @param callback The relocation callback, or nullptr to pin the memory block.
+		/// @param userData The user data to pass to the callback.
+		void SetRelocationCallback(const MemoryBlock& memoryBlock, RelocationCallback callback, void* userData);
+		/// @brief Records the next incremental defragmentation step into the given command buffer, moving resources out of the sparsest GPU memory block into other blocks. No new device memory is allocated for the moves. Must not be called while other threads use or destroy resources which can be moved.
+		/// @param commandBuffer The command buffer to record the resources' copies into, which must be submitted before any later work that uses the moved resources.
+		/// @param maxMoveSize The maximum total size of the resources to move in this step. At least one resource is always moved, if any is left.
+		/// @return The total size of the moved resources, or 0 if nothing was moved.
+		VkDeviceSize Defragment(VkCommandBuffer commandBuffer, VkDeviceSize maxMoveSize);
+		/// @brief Finishes the last defragmentation step, destroying the moved resources' old handles, freeing their old memory blocks and freeing the defragmented device memory once it's empty. Must only be called once the GPU finished the last step's command buffer.
+		void FinishDefragment();
+
+		/// @brief Queries every memory heap's budget and usage, calling the memory pressure event for every heap whose pressure level changed. Should be called once per frame.
+		void UpdateMemoryBudget();
+		/// @brief Gets the given memory heap's budget and usage, including all allocations made since the last budget update.
+		/// @param heapIndex The index of the memory heap, which must be lower than the memory properties' heap count.
+		/// @return The struct containing the heap's stats.
+		HeapStats GetHeapStats(uint32_t heapIndex);
+		/// @brief Gets the memory pressure event, which is called with a MemoryPressureEventInfo pointer by UpdateMemoryBudget, without any of the allocator's locks held.
+		/// @return A reference to the memory pressure event.
+		Event& GetMemoryPressureEvent() {
+			return memoryPressureEvent;
+		}
+
 		/// @brief Trims the allocator, freeing all unused resources.
 		void Trim();
 
@@ -125,48 +235,134 @@ namespace wfe {
 			RESOURCE_TYPE_IMAGE,
 			RESOURCE_TYPE_COUNT
 		};
-		struct FreeBlock {
+		static const uint32_t SECOND_LEVEL_SHIFT = 5;
+		static const uint32_t SECOND_LEVEL_COUNT = 1 << SECOND_LEVEL_SHIFT;
+		static const uint32_t FIRST_LEVEL_COUNT = 32;
+		static const size_t NODE_PAGE_SHIFT = 10;
+		static const size_t NODE_PAGE_SIZE = (size_t)1 << NODE_PAGE_SHIFT;
+		static const size_t NODE_PAGE_MASK = NODE_PAGE_SIZE - 1;
+		static const size_t MAX_NODE_PAGE_COUNT = 0x4000;
+
+		struct MemoryBlockInfo;
+
+		struct BlockNode {
 			VkDeviceSize offset;
 			VkDeviceSize size;
-			size_t prev;
-			size_t next;
+			VkDeviceMemory memory;
+			MemoryBlockInfo* memoryInfo;
+			size_t prevPhysical;
+			size_t nextPhysical;
+			size_t prevFree;
+			size_t nextFree;
+			VkDeviceSize alignment;
+			RelocationCallback relocationCallback;
+			void* relocationUserData;
+			bool8_t free;
 		};
-		struct FreeList {
-			size_t first = SIZE_T_MAX;
-			size_t last = SIZE_T_MAX;
+		struct BlockPool {
+			uint32_t firstLevelBitmap;
+			uint32_t secondLevelBitmaps[FIRST_LEVEL_COUNT];
+			size_t freeLists[FIRST_LEVEL_COUNT][SECOND_LEVEL_COUNT];
+			size_t unusedNodes;
+			AtomicMutex mutex;
 		};
 		struct TypeInfo {
 			MemoryType memoryType;
 			uint32_t realTypeIndex;
-			vector<VkDeviceMemory> memoryBlocks[RESOURCE_TYPE_COUNT];
+			BlockPool pools[RESOURCE_TYPE_COUNT];
 		};
 		struct MemoryBlockInfo {
-			FreeList freeList;
+			size_t firstNode;
 			void* mapped;
 			uint32_t memoryTypeIndex;
+			VkDeviceSize size;
+			VkDeviceSize usedSize;
+			size_t pinnedCount;
 
 			ResourceType resourceType;
 			bool8_t dedicated;
+			bool8_t draining;
+		};
+		struct PendingMove {
+			size_t oldIndex;
+			RetiredResource retiredResource;
+		};
+		struct HeapInfo {
+			VkDeviceSize budget;
+			VkDeviceSize queriedUsage;
+			VkDeviceSize queriedAllocatedSize;
+			VkDeviceSize allocatedSize;
+			size_t memoryCount;
+			MemoryPressure pressure;
+		};
+		struct TransientRing {
+			VkBuffer buffer;
+			MemoryBlock memoryBlock;
+			char_t* mapped;
+			VkDeviceSize head;
+			VkDeviceSize usedSize;
+			VkDeviceSize frameSizes[Renderer::MAX_FRAMES_IN_FLIGHT];
 		};
 		struct MemoryHash {
-			bool8_t operator()(const VkDeviceMemory& memory) {
+			size_t operator()(const VkDeviceMemory& memory) const {
 				return Hash<uint64_t>()((uint64_t)memory);
 			}
 		};
 
-		size_t InternalAllocFreeListBlock();
-		VkResult InternalAllocDeviceMemory(VkDeviceSize size, VkDeviceSize freeSize, uint32_t memoryTypeIndex, ResourceType resourceType, VkBuffer dedicatedBuffer, VkImage dedicatedImage, VkDeviceMemory& memory);
+		static void InternalGetSizeClass(VkDeviceSize size, uint32_t& firstLevel, uint32_t& secondLevel);
+		static VkDeviceSize InternalGetHeapUsage(const HeapInfo& heapInfo);
+		static MemoryPressure InternalGetMemoryPressure(VkDeviceSize usage, VkDeviceSize budget, MemoryPressure oldPressure);
+		BlockNode& InternalGetNode(size_t index) {
+			return nodePages[index >> NODE_PAGE_SHIFT][index & NODE_PAGE_MASK];
+		}
+		const BlockNode& InternalGetNode(size_t index) const {
+			return nodePages[index >> NODE_PAGE_SHIFT][index & NODE_PAGE_MASK];
+		}
+		bool8_t InternalReserveNodes(BlockPool& pool, size_t count);
+		size_t InternalAllocNode(BlockPool& pool);
+		void InternalFreeNode(BlockPool& pool, size_t index);
+		void InternalInsertFreeNode(BlockPool& pool, size_t index);
+		void InternalRemoveFreeNode(BlockPool& pool, size_t index);
+		size_t InternalFindFreeNode(const BlockPool& pool, VkDeviceSize size) const;
+		bool8_t InternalAllocFromNode(BlockPool& pool, size_t index, const VkMemoryRequirements& memRequirements, MemoryBlock& memoryBlock);
+		void InternalReleaseNode(size_t index);
+		VkResult InternalAllocDeviceMemory(VkDeviceSize size, uint32_t memoryTypeIndex, ResourceType resourceType, VkBuffer dedicatedBuffer, VkImage dedicatedImage, VkDeviceMemory& memory, MemoryBlockInfo*& memoryInfo);
 		void InternalFreeDeviceMemory(VkDeviceMemory memory);
 		VkResult InternalAllocMemory(const VkMemoryRequirements& memRequirements, uint32_t memoryTypeIndex, VkBuffer buffer, VkImage image, MemoryBlock& memoryBlock);
+		VkResult InternalCreateTransientRing(MemoryType memoryType);
+		VkDeviceSize InternalGetMemoryBlockSize(uint32_t memoryTypeIndex, VkDeviceSize minSize);
+		void InternalQueryMemoryBudget();
+		VkDeviceMemory InternalFindSparseMemory(MemoryBlockInfo*& sparseInfo);
+		void InternalStartDrain(VkDeviceMemory memory, MemoryBlockInfo* memoryInfo);
+		void InternalStopDrain();
+		void InternalSetRelocationCallback(BlockNode& node, RelocationCallback callback, void* userData);
+		void InternalLockPools();
+		void InternalUnlockPools();
 
 		VulkanDevice* device;
 		VkPhysicalDeviceMemoryProperties memoryProperties;
 		bool8_t dedicatedAllocSupported;
 		bool8_t bind2Supported;
+		bool8_t memoryBudgetSupported;
 
-		vector<TypeInfo> typeInfos;
+		TypeInfo* typeInfos;
+		uint32_t typeCount;
 		unordered_map<VkDeviceMemory, MemoryBlockInfo, MemoryHash> memoryInfos;
-		vector<FreeBlock> freeBlocks;
-		FreeList freeBlockList;
+		AtomicMutex memoryMutex;
+
+		HeapInfo heapInfos[VK_MAX_MEMORY_HEAPS];
+		Event memoryPressureEvent;
+
+		BlockNode* nodePages[MAX_NODE_PAGE_COUNT];
+		size_t nodePageCount;
+		AtomicMutex nodeMutex;
+
+		TransientRing transientRings[MEMORY_TYPE_COUNT];
+		size_t transientFrame;
+		AtomicMutex transientMutex;
+
+		VkDeviceMemory drainMemory;
+		MemoryBlockInfo* drainInfo;
+		vector<PendingMove> pendingMoves;
 	};
 }
\ No newline at end of file
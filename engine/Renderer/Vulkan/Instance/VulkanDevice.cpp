@@ -26,7 +26,8 @@ namespace wfe {
 		VK_KHR_GET_MEMORY_REQUIREMENTS_2_EXTENSION_NAME,
 		VK_KHR_DEDICATED_ALLOCATION_EXTENSION_NAME,
 		VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME,
-		VK_KHR_BIND_MEMORY_2_EXTENSION_NAME
+		VK_KHR_BIND_MEMORY_2_EXTENSION_NAME,
+		VK_EXT_MEMORY_BUDGET_EXTENSION_NAME
 	};
 
 	// Internal helper functions